@@ -0,0 +1,362 @@
+#include "VariableTool.h"
+
+#include <Library/TimerLib.h>
+
+// =============================
+// Transactional batch apply
+// Every variable a plan touches is snapshotted before the first write.
+// If any SetVariable fails, the writes already made are undone in reverse
+// order, so a variable named twice ends up back at its first snapshot.
+// =============================
+#define DEFAULT_NEW_ATTRIBUTES  (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+
+STATIC CONST struct {
+  CONST CHAR16    *Prefix;
+  VAR_INPUT_TYPE  Type;
+} mValuePrefixes[] = {
+  { L"str:",   VarInputUtf16  },
+  { L"ascii:", VarInputAscii  },
+  { L"hex:",   VarInputHex    },
+  { L"u8:",    VarInputUint8  },
+  { L"u16:",   VarInputUint16 },
+  { L"u32:",   VarInputUint32 },
+  { L"u64:",   VarInputUint64 },
+  { L"file:",  VarInputFile   },
+};
+
+STATIC CONST struct {
+  CONST CHAR16  *Tag;
+  UINT32        Bit;
+} mAttrNames[] = {
+  { L"NV", EFI_VARIABLE_NON_VOLATILE                          },
+  { L"BS", EFI_VARIABLE_BOOTSERVICE_ACCESS                    },
+  { L"RT", EFI_VARIABLE_RUNTIME_ACCESS                        },
+  { L"HR", EFI_VARIABLE_HARDWARE_ERROR_RECORD                 },
+  { L"AT", EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS },
+};
+
+// Split off the next whitespace-delimited token (in place).
+STATIC CHAR16 *
+NextToken(IN OUT CHAR16 **Cursor)
+{
+  CHAR16 *Start = *Cursor;
+  CHAR16 *End;
+
+  while (*Start == L' ' || *Start == L'\t') Start++;
+  if (*Start == L'\0') {
+    *Cursor = Start;
+    return NULL;
+  }
+
+  End = Start;
+  while (*End != L'\0' && *End != L' ' && *End != L'\t') End++;
+  if (*End != L'\0') *End++ = L'\0';
+  *Cursor = End;
+  return Start;
+}
+
+// "NV|BS|RT" or "0x7"
+STATIC EFI_STATUS
+ParseAttributes(IN CHAR16 *Text, OUT UINT32 *Attr)
+{
+  *Attr = 0;
+
+  if (Text[0] == L'0' && (Text[1] == L'x' || Text[1] == L'X')) {
+    *Attr = (UINT32)StrHexToUintn(Text);
+    return EFI_SUCCESS;
+  }
+
+  while (*Text != L'\0') {
+    UINTN i;
+    for (i = 0; i < ARRAY_SIZE(mAttrNames); i++) {
+      if (StrnCmp(Text, mAttrNames[i].Tag, 2) == 0) break;
+    }
+    if (i == ARRAY_SIZE(mAttrNames)) return EFI_INVALID_PARAMETER;
+    *Attr |= mAttrNames[i].Bit;
+    Text += 2;
+    if (*Text == L'|') Text++;
+    else if (*Text != L'\0') return EFI_INVALID_PARAMETER;
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+ParseValue(IN CHAR16 *Text, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  while (*Text == L' ' || *Text == L'\t') Text++;
+
+  for (UINTN i = 0; i < ARRAY_SIZE(mValuePrefixes); i++) {
+    UINTN Len = StrLen(mValuePrefixes[i].Prefix);
+    if (StrnCmp(Text, mValuePrefixes[i].Prefix, Len) == 0) {
+      return VarParseTypedValue(mValuePrefixes[i].Type, Text + Len, Data, DataSize);
+    }
+  }
+  return EFI_INVALID_PARAMETER;
+}
+
+//   set    <name> <guid|*> <attr|*> <type>:<value>
+//   append <name> <guid|*> <type>:<value>
+//   delete <name> <guid|*>
+STATIC EFI_STATUS
+ParsePlanLine(IN CHAR16 *Line, IN EFI_GUID *DefaultGuid, OUT VAR_OP *Op)
+{
+  EFI_STATUS Status;
+  CHAR16 *Verb, *Name, *GuidText, *AttrText;
+
+  ZeroMem(Op, sizeof(*Op));
+
+  Verb = NextToken(&Line);
+  Name = NextToken(&Line);
+  GuidText = NextToken(&Line);
+  if (Verb == NULL || Name == NULL || GuidText == NULL) return EFI_INVALID_PARAMETER;
+
+  if (StrCmp(GuidText, L"*") == 0) {
+    CopyGuid(&Op->Guid, DefaultGuid);
+  } else if (EFI_ERROR(StrToGuid(GuidText, &Op->Guid))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (StrCmp(Verb, L"delete") == 0) {
+    Op->Kind = VarOpDelete;
+  } else if (StrCmp(Verb, L"set") == 0) {
+    Op->Kind = VarOpSet;
+    AttrText = NextToken(&Line);
+    if (AttrText == NULL) return EFI_INVALID_PARAMETER;
+    if (StrCmp(AttrText, L"*") != 0) {
+      if (EFI_ERROR(ParseAttributes(AttrText, &Op->Attributes))) return EFI_INVALID_PARAMETER;
+      Op->ExplicitAttributes = TRUE;
+    }
+  } else if (StrCmp(Verb, L"append") == 0) {
+    Op->Kind = VarOpAppend;
+  } else {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Op->Kind != VarOpDelete) {
+    Status = ParseValue(Line, &Op->Data, &Op->DataSize);
+    if (EFI_ERROR(Status)) return Status;
+  }
+
+  Op->Name = AllocateCopyPool(StrSize(Name), Name);
+  if (Op->Name == NULL) {
+    if (Op->Data) FreePool(Op->Data);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  return EFI_SUCCESS;
+}
+
+VOID
+VarFreeOps(IN VAR_OP *Ops, IN UINTN Count)
+{
+  if (Ops == NULL) return;
+  for (UINTN i = 0; i < Count; i++) {
+    if (Ops[i].Name) FreePool(Ops[i].Name);
+    if (Ops[i].Data) FreePool(Ops[i].Data);
+    if (Ops[i].OrigData) FreePool(Ops[i].OrigData);
+  }
+  FreePool(Ops);
+}
+
+EFI_STATUS
+VarLoadPlan(IN CHAR16 *Path, IN EFI_GUID *DefaultGuid, OUT VAR_OP **OutOps, OUT UINTN *OutCount, OUT UINTN *ErrorLine)
+{
+  EFI_STATUS Status;
+  UINT8 *Raw = NULL;
+  UINTN RawSize = 0;
+  CHAR16 *Text;
+  UINTN Chars;
+  VAR_OP *Ops = NULL;
+  UINTN Count = 0, Cap = 0;
+  UINTN LineNo = 0;
+
+  *OutOps = NULL;
+  *OutCount = 0;
+  *ErrorLine = 0;
+
+  Status = VarFileReadAll(Path, (VOID **)&Raw, &RawSize);
+  if (EFI_ERROR(Status)) return Status;
+
+  // UTF-16LE with BOM (Shell "edit") or plain ASCII
+  if (RawSize >= 2 && Raw[0] == 0xFF && Raw[1] == 0xFE) {
+    Chars = (RawSize - 2) / sizeof(CHAR16);
+    Text = AllocatePool((Chars + 1) * sizeof(CHAR16));
+    if (Text != NULL) CopyMem(Text, Raw + 2, Chars * sizeof(CHAR16));
+  } else {
+    Chars = RawSize;
+    Text = AllocatePool((Chars + 1) * sizeof(CHAR16));
+    if (Text != NULL) {
+      for (UINTN i = 0; i < Chars; i++) Text[i] = Raw[i];
+    }
+  }
+  FreePool(Raw);
+  if (Text == NULL) return EFI_OUT_OF_RESOURCES;
+  Text[Chars] = L'\0';
+
+  for (CHAR16 *Line = Text; Line != NULL && *Line != L'\0';) {
+    CHAR16 *Next = Line;
+    CHAR16 *p;
+
+    while (*Next != L'\0' && *Next != L'\n') Next++;
+    if (*Next == L'\n') *Next++ = L'\0';
+    else Next = NULL;
+    LineNo++;
+
+    // trim; '#' starts a comment line
+    for (p = Line; *p != L'\0'; p++);
+    while (p > Line && (p[-1] == L'\r' || p[-1] == L' ' || p[-1] == L'\t')) *--p = L'\0';
+    while (*Line == L' ' || *Line == L'\t') Line++;
+
+    if (*Line != L'\0' && *Line != L'#') {
+      if (Count >= Cap) {
+        UINTN NewCap = (Cap == 0) ? 16 : Cap * 2;
+        VAR_OP *NewOps = ReallocatePool(Cap * sizeof(VAR_OP), NewCap * sizeof(VAR_OP), Ops);
+        if (NewOps == NULL) {
+          Status = EFI_OUT_OF_RESOURCES;
+          break;
+        }
+        Ops = NewOps;
+        Cap = NewCap;
+      }
+      Status = ParsePlanLine(Line, DefaultGuid, &Ops[Count]);
+      if (EFI_ERROR(Status)) {
+        *ErrorLine = LineNo;
+        break;
+      }
+      Count++;
+    }
+    Line = Next;
+  }
+
+  FreePool(Text);
+
+  if (EFI_ERROR(Status)) {
+    VarFreeOps(Ops, Count);
+    return Status;
+  }
+  if (Count == 0) {
+    if (Ops) FreePool(Ops);
+    return EFI_NOT_FOUND;
+  }
+
+  *OutOps = Ops;
+  *OutCount = Count;
+  return EFI_SUCCESS;
+}
+
+// Snapshot the current value of every target and resolve "*" attributes.
+STATIC EFI_STATUS
+SnapshotOps(IN OUT VAR_OP *Ops, IN UINTN Count)
+{
+  for (UINTN i = 0; i < Count; i++) {
+    VAR_OP *Op = &Ops[i];
+    UINT8 *Data;
+    UINTN Size;
+    EFI_STATUS Status;
+
+    Status = VarReadFresh(Op->Name, &Op->Guid, &Op->OrigAttributes, &Data, &Size);
+    if (Status == EFI_NOT_FOUND) {
+      Op->Existed = FALSE;
+    } else if (EFI_ERROR(Status)) {
+      Op->Status = Status;
+      return Status;
+    } else {
+      // the bulk buffer is reused by the next read, keep a copy
+      Op->Existed = TRUE;
+      Op->OrigSize = Size;
+      Op->OrigData = AllocateCopyPool(MAX(Size, 1), Data);
+      if (Op->OrigData == NULL) return EFI_OUT_OF_RESOURCES;
+    }
+
+    if (Op->Kind != VarOpDelete && !Op->ExplicitAttributes) {
+      Op->Attributes = Op->Existed ? Op->OrigAttributes : DEFAULT_NEW_ATTRIBUTES;
+    }
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+ApplyOne(IN VAR_OP *Op)
+{
+  switch (Op->Kind) {
+    case VarOpDelete:
+      return VarSetVariable(Op->Name, &Op->Guid, 0, 0, NULL);
+    case VarOpAppend:
+      return VarSetVariable(Op->Name, &Op->Guid, Op->Attributes | EFI_VARIABLE_APPEND_WRITE, Op->DataSize, Op->Data);
+    default:
+      return VarSetVariable(Op->Name, &Op->Guid, Op->Attributes, Op->DataSize, Op->Data);
+  }
+}
+
+STATIC EFI_STATUS
+RestoreOne(IN VAR_OP *Op)
+{
+  EFI_STATUS Status;
+
+  if (!Op->Existed) {
+    Status = VarSetVariable(Op->Name, &Op->Guid, 0, 0, NULL);
+    return (Status == EFI_NOT_FOUND) ? EFI_SUCCESS : Status;
+  }
+
+  // attributes changed: the old variable has to go first, and the
+  // original cannot be written over it if that fails
+  if (Op->Kind == VarOpSet && Op->Attributes != Op->OrigAttributes) {
+    Status = VarSetVariable(Op->Name, &Op->Guid, 0, 0, NULL);
+    if (EFI_ERROR(Status) && Status != EFI_NOT_FOUND) return Status;
+  }
+  return VarSetVariable(Op->Name, &Op->Guid, Op->OrigAttributes, Op->OrigSize, Op->OrigData);
+}
+
+// BaseCpuTimerLib reports 0 Hz when CPUID does not give the TSC frequency,
+// and GetTimeInNanoSecond would divide by it.
+STATIC UINT64
+ElapsedSince(IN UINT64 Start)
+{
+  if (GetPerformanceCounterProperties(NULL, NULL) == 0) return VAR_ELAPSED_UNKNOWN;
+  return GetTimeInNanoSecond(GetPerformanceCounter() - Start);
+}
+
+EFI_STATUS
+VarApplyOps(IN OUT VAR_OP *Ops, IN UINTN Count, OUT VAR_APPLY_RESULT *Result)
+{
+  EFI_STATUS Status;
+  UINT64 Start;
+  UINTN i;
+
+  ZeroMem(Result, sizeof(*Result));
+  Result->FailedIndex = Count;
+  Start = GetPerformanceCounter();
+
+  for (i = 0; i < Count; i++) {
+    Ops[i].Status = EFI_NOT_STARTED;
+    Ops[i].RestoreStatus = EFI_NOT_STARTED;
+  }
+
+  Status = SnapshotOps(Ops, Count);
+  if (EFI_ERROR(Status)) {
+    Result->ElapsedNs = ElapsedSince(Start);
+    return Status;
+  }
+
+  for (i = 0; i < Count; i++) {
+    Ops[i].Status = ApplyOne(&Ops[i]);
+    if (EFI_ERROR(Ops[i].Status)) break;
+    Result->Applied++;
+  }
+
+  if (i < Count) {
+    Status = Ops[i].Status;
+    Result->FailedIndex = i;
+    Result->RolledBack = i;
+
+    // roll back everything written so far, newest first
+    while (i-- > 0) {
+      Ops[i].RestoreStatus = RestoreOne(&Ops[i]);
+      if (EFI_ERROR(Ops[i].RestoreStatus)) {
+        Result->RestoreErrors++;
+      }
+    }
+  }
+
+  Result->ElapsedNs = ElapsedSince(Start);
+  return Status;
+}
@@ -0,0 +1,87 @@
+#include "VariableTool.h"
+
+#include <Guid/GlobalVariable.h>
+#include <Guid/ImageAuthentication.h>
+
+// =============================
+// Signed (.auth) payloads for time-based authenticated variables
+// The file is an EFI_VARIABLE_AUTHENTICATION_2 header followed by the
+// variable data, exactly as SetVariable expects it, so it is read into
+// one buffer and passed through unchanged.
+// =============================
+#define AUTH_VARIABLE_ATTRIBUTES  (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | \
+                                   EFI_VARIABLE_RUNTIME_ACCESS | EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS)
+
+STATIC CONST struct {
+  CONST CHAR16  *Name;
+  EFI_GUID      *Guid;
+  BOOLEAN       CanAppend;   // signature lists may be appended to
+} mAuthTargets[] = {
+  { EFI_PLATFORM_KEY_NAME,        &gEfiGlobalVariableGuid,        FALSE },
+  { EFI_KEY_EXCHANGE_KEY_NAME,    &gEfiGlobalVariableGuid,        TRUE  },
+  { EFI_IMAGE_SECURITY_DATABASE,  &gEfiImageSecurityDatabaseGuid, TRUE  },
+  { EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, TRUE  },
+  { EFI_IMAGE_SECURITY_DATABASE2, &gEfiImageSecurityDatabaseGuid, TRUE  },
+};
+
+BOOLEAN
+VarAuthLookupTarget(IN CONST CHAR16 *Name, OUT EFI_GUID *Guid, OUT BOOLEAN *CanAppend)
+{
+  for (UINTN i = 0; i < ARRAY_SIZE(mAuthTargets); i++) {
+    if (StrCmp(Name, mAuthTargets[i].Name) == 0) {
+      CopyGuid(Guid, mAuthTargets[i].Guid);
+      *CanAppend = mAuthTargets[i].CanAppend;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+EFI_STATUS
+VarAuthInspect(IN CONST UINT8 *Data, IN UINTN Size, OUT EFI_TIME *TimeStamp, OUT UINTN *PayloadOffset)
+{
+  CONST EFI_VARIABLE_AUTHENTICATION_2 *Auth = (CONST EFI_VARIABLE_AUTHENTICATION_2 *)Data;
+  UINT32 CertLength;
+
+  if (Size < OFFSET_OF(EFI_VARIABLE_AUTHENTICATION_2, AuthInfo) + OFFSET_OF(WIN_CERTIFICATE_UEFI_GUID, CertData)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  CertLength = ReadUnaligned32(&Auth->AuthInfo.Hdr.dwLength);
+  if (ReadUnaligned16(&Auth->AuthInfo.Hdr.wCertificateType) != WIN_CERT_TYPE_EFI_GUID ||
+      !CompareGuid(&Auth->AuthInfo.CertType, &gEfiCertPkcs7Guid) ||
+      CertLength < OFFSET_OF(WIN_CERTIFICATE_UEFI_GUID, CertData) ||
+      CertLength > Size - OFFSET_OF(EFI_VARIABLE_AUTHENTICATION_2, AuthInfo)) {
+    return EFI_COMPROMISED_DATA;
+  }
+
+  CopyMem(TimeStamp, &Auth->TimeStamp, sizeof(EFI_TIME));
+  *PayloadOffset = OFFSET_OF(EFI_VARIABLE_AUTHENTICATION_2, AuthInfo) + CertLength;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarWriteAuthFile(IN CHAR16 *Name, IN EFI_GUID *Guid, IN CHAR16 *Path, IN BOOLEAN Append,
+                 OUT EFI_TIME *TimeStamp OPTIONAL, OUT UINTN *PayloadSize OPTIONAL)
+{
+  EFI_STATUS Status;
+  UINT8 *Data = NULL;
+  UINTN Size = 0;
+  UINTN Offset;
+  EFI_TIME Signed;
+  UINT32 Attr = AUTH_VARIABLE_ATTRIBUTES;
+
+  Status = VarFileReadAll(Path, (VOID **)&Data, &Size);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = VarAuthInspect(Data, Size, &Signed, &Offset);
+  if (!EFI_ERROR(Status)) {
+    if (TimeStamp != NULL) CopyMem(TimeStamp, &Signed, sizeof(EFI_TIME));
+    if (PayloadSize != NULL) *PayloadSize = Size - Offset;
+    if (Append) Attr |= EFI_VARIABLE_APPEND_WRITE;
+    Status = VarSetVariable(Name, Guid, Attr, Size, Data);
+  }
+
+  FreePool(Data);
+  return Status;
+}
@@ -0,0 +1,52 @@
+#include "VariableTool.h"
+
+// =============================
+// Variable service backends
+// Everything that enumerates, reads or writes variables goes through
+// gVarBackend. The default forwards to runtime services; other backends
+// (a parsed store image, see VarStore.c) plug in the same signatures.
+// =============================
+STATIC EFI_STATUS
+EFIAPI
+RtGetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, IN OUT UINTN *DataSize, OUT VOID *Data OPTIONAL)
+{
+  return gRT->GetVariable(Name, Guid, Attributes, DataSize, Data);
+}
+
+STATIC EFI_STATUS
+EFIAPI
+RtGetNextVariableName(IN OUT UINTN *NameSize, IN OUT CHAR16 *Name, IN OUT EFI_GUID *Guid)
+{
+  return gRT->GetNextVariableName(NameSize, Name, Guid);
+}
+
+STATIC EFI_STATUS
+EFIAPI
+RtSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  return gRT->SetVariable(Name, Guid, Attributes, DataSize, Data);
+}
+
+STATIC EFI_STATUS
+EFIAPI
+RtQueryVariableInfo(IN UINT32 Attributes, OUT UINT64 *MaxStorage, OUT UINT64 *Remaining, OUT UINT64 *MaxVariableSize)
+{
+  return gRT->QueryVariableInfo(Attributes, MaxStorage, Remaining, MaxVariableSize);
+}
+
+STATIC VAR_BACKEND mRuntimeBackend = {
+  L"runtime services",
+  RtGetVariable,
+  RtGetNextVariableName,
+  RtSetVariable,
+  RtQueryVariableInfo,
+  NULL
+};
+
+VAR_BACKEND *gVarBackend = &mRuntimeBackend;
+
+VOID
+VarBackendSelect(IN VAR_BACKEND *Backend OPTIONAL)
+{
+  gVarBackend = (Backend != NULL) ? Backend : &mRuntimeBackend;
+}
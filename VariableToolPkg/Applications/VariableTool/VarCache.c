@@ -0,0 +1,398 @@
+#include "VariableTool.h"
+
+// =============================
+// Bounded LRU payload cache
+// One pool allocation per entry: [VAR_CACHE_ENTRY][Name][Data]
+// Entries are charged against a byte limit and evicted least recently used
+// first. Pinned entries (handed out by VarCacheGet) are never freed until
+// released, so callers may hold several payloads at once. Bulk walks
+// (hash, export, dump) fill the room that is left, at the cold end, and
+// never evict for it, so a cold export warms the cache for later views.
+// =============================
+#define VAR_CACHE_BUCKETS  64
+
+typedef struct {
+  VAR_PAYLOAD  Payload;   // must stay first, callers only see this part
+  LIST_ENTRY   LruLink;   // mLruList, most recently used at head
+  LIST_ENTRY   HashLink;  // mBuckets[Hash % VAR_CACHE_BUCKETS]
+  CHAR16       *Name;
+  EFI_GUID     Guid;
+  UINT32       Hash;
+  UINTN        Cost;      // bytes charged against the limit
+  UINTN        PinCount;
+  BOOLEAN      Linked;    // FALSE once evicted/invalidated or never inserted
+} VAR_CACHE_ENTRY;
+
+STATIC BOOLEAN         mCacheReady = FALSE;
+STATIC LIST_ENTRY      mLruList;
+STATIC LIST_ENTRY      mBuckets[VAR_CACHE_BUCKETS];
+STATIC VAR_CACHE_STATS mStats = { 0, 0, 0, 0, 0, VAR_CACHE_DEFAULT_LIMIT };
+
+STATIC VOID
+CacheInit(VOID)
+{
+  if (mCacheReady) return;
+  InitializeListHead(&mLruList);
+  for (UINTN i = 0; i < VAR_CACHE_BUCKETS; i++) {
+    InitializeListHead(&mBuckets[i]);
+  }
+  mCacheReady = TRUE;
+}
+
+STATIC VOID
+CacheFreeEntry(IN VAR_CACHE_ENTRY *Entry)
+{
+  FreePool(Entry);
+}
+
+STATIC VOID
+CacheUnlink(IN VAR_CACHE_ENTRY *Entry)
+{
+  if (!Entry->Linked) return;
+
+  RemoveEntryList(&Entry->LruLink);
+  RemoveEntryList(&Entry->HashLink);
+  Entry->Linked = FALSE;
+  mStats.Bytes -= Entry->Cost;
+  mStats.Entries--;
+
+  if (Entry->PinCount == 0) {
+    CacheFreeEntry(Entry);
+  }
+}
+
+STATIC VAR_CACHE_ENTRY *
+CacheFind(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Hash)
+{
+  LIST_ENTRY *Bucket = &mBuckets[Hash % VAR_CACHE_BUCKETS];
+  LIST_ENTRY *Link;
+
+  for (Link = GetFirstNode(Bucket); !IsNull(Bucket, Link); Link = GetNextNode(Bucket, Link)) {
+    VAR_CACHE_ENTRY *Entry = BASE_CR(Link, VAR_CACHE_ENTRY, HashLink);
+    if (Entry->Hash == Hash && CompareGuid(&Entry->Guid, Guid) && StrCmp(Entry->Name, Name) == 0) {
+      return Entry;
+    }
+  }
+  return NULL;
+}
+
+// Evict from the LRU tail until Needed more bytes fit under the limit.
+// Pinned entries are skipped; they are evicted when found unpinned later.
+STATIC VOID
+CacheMakeRoom(IN UINTN Needed)
+{
+  LIST_ENTRY *Link = GetPreviousNode(&mLruList, &mLruList);
+
+  while (!IsNull(&mLruList, Link) && mStats.Bytes + Needed > mStats.Limit) {
+    VAR_CACHE_ENTRY *Entry = BASE_CR(Link, VAR_CACHE_ENTRY, LruLink);
+    Link = GetPreviousNode(&mLruList, Link);
+    if (Entry->PinCount != 0) continue;
+    CacheUnlink(Entry);
+    mStats.Evictions++;
+  }
+}
+
+// =============================
+// Scratch buffer
+// Persistent, growable buffer used for single-call GetVariable reads.
+// It is tried at its current size first and only grown on
+// EFI_BUFFER_TOO_SMALL, so the usual case is one runtime-service call and
+// no allocation per variable. Backends that can read in place (a mapped
+// store image) skip the copy and hand out a pointer into the store; what
+// they do not hold (volatile variables under the flash fast path) is
+// still read through GetVariable.
+// =============================
+#define VAR_SCRATCH_INITIAL_SIZE  SIZE_4KB
+
+STATIC UINT8 *mScratch = NULL;
+STATIC UINTN mScratchSize = 0;
+
+STATIC EFI_STATUS
+ScratchRead(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attr, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  EFI_STATUS Status;
+  UINTN Size;
+
+  if (gVarBackend->ReadInPlace != NULL) {
+    Status = gVarBackend->ReadInPlace(Name, Guid, Attr, Data, DataSize);
+    if (Status != EFI_NOT_FOUND) return Status;
+  }
+
+  if (mScratch == NULL) {
+    mScratch = AllocatePool(VAR_SCRATCH_INITIAL_SIZE);
+    if (mScratch == NULL) return EFI_OUT_OF_RESOURCES;
+    mScratchSize = VAR_SCRATCH_INITIAL_SIZE;
+  }
+
+  while (TRUE) {
+    Size = mScratchSize;
+    Status = gVarBackend->GetVariable(Name, Guid, Attr, &Size, mScratch);
+    if (Status != EFI_BUFFER_TOO_SMALL) break;
+
+    // grow geometrically so a run of slightly larger variables does not
+    // trigger a resize each time; old contents need not be preserved
+    FreePool(mScratch);
+    mScratchSize = MAX(Size, mScratchSize * 2);
+    mScratch = AllocatePool(mScratchSize);
+    if (mScratch == NULL) {
+      mScratchSize = 0;
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (!EFI_ERROR(Status)) {
+    *Data = mScratch;
+    *DataSize = Size;
+  }
+  return Status;
+}
+
+STATIC UINTN
+CacheCost(IN CHAR16 *Name, IN UINTN DataSize)
+{
+  return sizeof(VAR_CACHE_ENTRY) + StrSize(Name) + DataSize;
+}
+
+// Copy a payload into a new, unlinked cache entry.
+STATIC EFI_STATUS
+CacheNewEntry(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attr, IN UINT8 *Data, IN UINTN DataSize, OUT VAR_CACHE_ENTRY **OutEntry)
+{
+  UINTN NameSize = StrSize(Name);
+  VAR_CACHE_ENTRY *Entry;
+
+  *OutEntry = NULL;
+
+  Entry = AllocatePool(sizeof(VAR_CACHE_ENTRY) + NameSize + DataSize);
+  if (Entry == NULL) return EFI_OUT_OF_RESOURCES;
+
+  Entry->Name = (CHAR16 *)(Entry + 1);
+  CopyMem(Entry->Name, Name, NameSize);
+  Entry->Payload.Data = (DataSize > 0) ? (UINT8 *)Entry->Name + NameSize : NULL;
+  CopyMem(Entry->Payload.Data, Data, DataSize);
+  Entry->Payload.Attributes = Attr;
+  Entry->Payload.DataSize = DataSize;
+  CopyMem(&Entry->Guid, Guid, sizeof(EFI_GUID));
+  Entry->Hash = VarNameHash(Name, Guid);
+  Entry->Cost = sizeof(VAR_CACHE_ENTRY) + NameSize + DataSize;
+  Entry->PinCount = 0;
+  Entry->Linked = FALSE;
+
+  *OutEntry = Entry;
+  return EFI_SUCCESS;
+}
+
+// Read a variable into a new cache entry via the scratch buffer.
+STATIC EFI_STATUS
+CacheLoad(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT VAR_CACHE_ENTRY **OutEntry)
+{
+  EFI_STATUS Status;
+  UINT8 *Data = NULL;
+  UINTN DataSize = 0;
+  UINT32 Attr = 0;
+
+  *OutEntry = NULL;
+
+  Status = ScratchRead(Name, Guid, &Attr, &Data, &DataSize);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+  return CacheNewEntry(Name, Guid, Attr, Data, DataSize, OutEntry);
+}
+
+// Most recently used at the head; bulk reads go in at the tail.
+STATIC VOID
+CacheLink(IN VAR_CACHE_ENTRY *Entry, IN BOOLEAN Hot)
+{
+  if (Hot) {
+    InsertHeadList(&mLruList, &Entry->LruLink);
+  } else {
+    InsertTailList(&mLruList, &Entry->LruLink);
+  }
+  InsertTailList(&mBuckets[Entry->Hash % VAR_CACHE_BUCKETS], &Entry->HashLink);
+  Entry->Linked = TRUE;
+  mStats.Bytes += Entry->Cost;
+  mStats.Entries++;
+}
+
+EFI_STATUS
+VarCacheGet(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT VAR_PAYLOAD **Payload)
+{
+  EFI_STATUS Status;
+  VAR_CACHE_ENTRY *Entry;
+  UINT32 Hash;
+
+  if (Name == NULL || Guid == NULL || Payload == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  *Payload = NULL;
+
+  CacheInit();
+
+  Hash = VarNameHash(Name, Guid);
+  Entry = CacheFind(Name, Guid, Hash);
+  if (Entry != NULL) {
+    mStats.Hits++;
+    RemoveEntryList(&Entry->LruLink);
+    InsertHeadList(&mLruList, &Entry->LruLink);
+    Entry->PinCount++;
+    *Payload = &Entry->Payload;
+    return EFI_SUCCESS;
+  }
+
+  mStats.Misses++;
+  Status = CacheLoad(Name, Guid, &Entry);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  // payloads larger than the whole cache are handed out detached
+  if (Entry->Cost <= mStats.Limit) {
+    CacheMakeRoom(Entry->Cost);
+    if (mStats.Bytes + Entry->Cost <= mStats.Limit) {
+      CacheLink(Entry, TRUE);
+    }
+  }
+
+  Entry->PinCount++;
+  *Payload = &Entry->Payload;
+  return EFI_SUCCESS;
+}
+
+VOID
+VarCacheRelease(IN VAR_PAYLOAD *Payload)
+{
+  VAR_CACHE_ENTRY *Entry;
+
+  if (Payload == NULL) return;
+
+  Entry = (VAR_CACHE_ENTRY *)Payload;
+  if (Entry->PinCount > 0) Entry->PinCount--;
+
+  if (Entry->PinCount == 0 && !Entry->Linked) {
+    CacheFreeEntry(Entry);
+  }
+}
+
+EFI_STATUS
+VarReadBulk(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  EFI_STATUS Status;
+  VAR_CACHE_ENTRY *Entry;
+  UINT32 Attr = 0;
+
+  if (Name == NULL || Guid == NULL || Data == NULL || DataSize == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CacheInit();
+
+  // serve hits without promoting them; bulk walks must not reorder the LRU
+  Entry = CacheFind(Name, Guid, VarNameHash(Name, Guid));
+  if (Entry != NULL) {
+    mStats.Hits++;
+    if (Attributes) *Attributes = Entry->Payload.Attributes;
+    *Data = Entry->Payload.Data;
+    *DataSize = Entry->Payload.DataSize;
+    return EFI_SUCCESS;
+  }
+
+  mStats.Misses++;
+  Status = ScratchRead(Name, Guid, &Attr, Data, DataSize);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  // keep the copy while there is free room; payloads read in place from a
+  // mapped store are not worth one
+  if (*Data == mScratch && mStats.Bytes + CacheCost(Name, *DataSize) <= mStats.Limit &&
+      !EFI_ERROR(CacheNewEntry(Name, Guid, Attr, *Data, *DataSize, &Entry))) {
+    CacheLink(Entry, FALSE);
+    *Data = Entry->Payload.Data;
+  }
+
+  if (Attributes) *Attributes = Attr;
+  return EFI_SUCCESS;
+}
+
+// Always from the store, never from the cache; a cached copy that turns
+// out to be stale (changed behind our back) is dropped.
+EFI_STATUS
+VarReadFresh(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  EFI_STATUS Status;
+  VAR_CACHE_ENTRY *Entry;
+  UINT32 Attr = 0;
+
+  if (Name == NULL || Guid == NULL || Data == NULL || DataSize == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = ScratchRead(Name, Guid, &Attr, Data, DataSize);
+
+  if (mCacheReady) {
+    Entry = CacheFind(Name, Guid, VarNameHash(Name, Guid));
+    if (Entry != NULL &&
+        (EFI_ERROR(Status) || Entry->Payload.Attributes != Attr || Entry->Payload.DataSize != *DataSize ||
+         CompareMem(Entry->Payload.Data, *Data, *DataSize) != 0)) {
+      VarCacheInvalidate(Name, Guid);
+    }
+  }
+
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  if (Attributes) *Attributes = Attr;
+  return EFI_SUCCESS;
+}
+
+VOID
+VarCacheInvalidate(IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  VAR_CACHE_ENTRY *Entry;
+
+  if (Name == NULL || Guid == NULL || !mCacheReady) return;
+
+  Entry = CacheFind(Name, Guid, VarNameHash(Name, Guid));
+  if (Entry != NULL) {
+    CacheUnlink(Entry);
+  }
+}
+
+VOID
+VarCacheInvalidateAll(VOID)
+{
+  if (!mCacheReady) return;
+
+  while (!IsListEmpty(&mLruList)) {
+    CacheUnlink(BASE_CR(GetFirstNode(&mLruList), VAR_CACHE_ENTRY, LruLink));
+  }
+}
+
+VOID
+VarCacheSetLimit(IN UINTN LimitBytes)
+{
+  CacheInit();
+  mStats.Limit = LimitBytes;
+  CacheMakeRoom(0);
+}
+
+VOID
+VarCacheGetStats(OUT VAR_CACHE_STATS *Stats)
+{
+  if (Stats != NULL) {
+    CopyMem(Stats, &mStats, sizeof(VAR_CACHE_STATS));
+  }
+}
+
+VOID
+VarCacheShutdown(VOID)
+{
+  VarCacheInvalidateAll();
+
+  if (mScratch != NULL) {
+    FreePool(mScratch);
+    mScratch = NULL;
+    mScratchSize = 0;
+  }
+}
@@ -0,0 +1,256 @@
+#include "VariableTool.h"
+
+// =============================
+// Persistent catalog cache
+// The last validated catalog is kept in a small file next to the tool so
+// List All can draw its first page without walking the store. The walk
+// still happens, one GetNextVariableName step at a time while the UI is
+// idle, and reconciles the rows: changed sizes/attributes are marked
+// stale, unknown variables are appended, rows never seen are marked
+// deleted. Only names, GUIDs, sizes and attributes are kept, so the walk
+// stays a size probe per variable and never reads payloads.
+// =============================
+#define CATALOG_CACHE_SIGNATURE  SIGNATURE_32('V', 'T', 'C', 'C')
+#define CATALOG_CACHE_VERSION    1
+
+#pragma pack(1)
+typedef struct {
+  UINT32  Signature;
+  UINT16  Version;
+  UINT16  HeaderSize;
+  UINT32  Count;
+  UINT32  RecordsSize;
+  UINT32  RecordsCrc;     // CalculateCrc32 over all records
+} CATALOG_CACHE_HEADER;
+
+typedef struct {
+  EFI_GUID  Guid;
+  UINT32    Attributes;
+  UINT32    DataSize;
+  UINT16    NameSize;     // bytes, including the terminator
+  // CHAR16 Name[]
+} CATALOG_CACHE_RECORD;
+#pragma pack()
+
+EFI_STATUS
+VarCatalogLoad(IN CHAR16 *Path, OUT VAR_CATALOG *Catalog)
+{
+  EFI_STATUS Status;
+  UINT8 *File = NULL;
+  UINTN FileSize = 0;
+  CATALOG_CACHE_HEADER *Hdr;
+  UINT8 *Rec, *End;
+
+  VarCatalogInit(Catalog);
+
+  Status = VarFileReadAll(Path, (VOID **)&File, &FileSize);
+  if (EFI_ERROR(Status)) return Status;
+
+  Hdr = (CATALOG_CACHE_HEADER *)File;
+  if (FileSize < sizeof(*Hdr) || Hdr->Signature != CATALOG_CACHE_SIGNATURE ||
+      Hdr->Version != CATALOG_CACHE_VERSION || Hdr->HeaderSize != sizeof(*Hdr) ||
+      Hdr->RecordsSize != FileSize - sizeof(*Hdr) ||
+      CalculateCrc32(File + sizeof(*Hdr), Hdr->RecordsSize) != Hdr->RecordsCrc ||
+      Hdr->Count == 0) {
+    FreePool(File);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  Rec = File + sizeof(*Hdr);
+  End = File + FileSize;
+  while (Catalog->Count < Hdr->Count) {
+    CATALOG_CACHE_RECORD *R = (CATALOG_CACHE_RECORD *)Rec;
+    UINTN NameSize;
+    CHAR16 *Name;
+
+    if ((UINTN)(End - Rec) < sizeof(*R)) break;
+    NameSize = R->NameSize;
+    if (NameSize < sizeof(CHAR16) || (NameSize & 1) != 0 || (UINTN)(End - Rec) < sizeof(*R) + NameSize) break;
+
+    // the terminator is part of the CRC-checked record
+    Name = (CHAR16 *)(Rec + sizeof(*R));
+    if (Name[NameSize / sizeof(CHAR16) - 1] != L'\0') break;
+    if (EFI_ERROR(VarCatalogAdd(Catalog, Name, &R->Guid, R->DataSize, R->Attributes, VarItemCached))) break;
+
+    Rec += sizeof(*R) + NameSize;
+  }
+
+  FreePool(File);
+
+  if (Catalog->Count != Hdr->Count) {
+    FreeAllVariables(Catalog);
+    return EFI_VOLUME_CORRUPTED;
+  }
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarCatalogSave(IN CHAR16 *Path, IN VAR_CATALOG *Catalog)
+{
+  EFI_STATUS Status;
+  CATALOG_CACHE_HEADER Hdr;
+  CATALOG_CACHE_RECORD R;
+  UINT8 *Records, *p;
+  CHAR16 *Name;
+  UINTN Size = 0;
+  VAR_WRITER Writer;
+
+  // records are built in memory first: the header carries their CRC
+  for (UINTN i = 0; i < Catalog->Count; i++) {
+    if (Catalog->State[i] == VarItemDeleted) continue;
+    Size += sizeof(R) + StrSize(VarCatalogName(Catalog, i));
+  }
+  Records = AllocatePool(MAX(Size, 1));
+  if (Records == NULL) return EFI_OUT_OF_RESOURCES;
+
+  ZeroMem(&Hdr, sizeof(Hdr));
+  p = Records;
+  for (UINTN i = 0; i < Catalog->Count; i++) {
+    if (Catalog->State[i] == VarItemDeleted) continue;
+    Name = VarCatalogName(Catalog, i);
+    CopyGuid(&R.Guid, VAR_CATALOG_GUID(Catalog, i));
+    R.Attributes = Catalog->Attributes[i];
+    R.DataSize = Catalog->DataSize[i];
+    R.NameSize = (UINT16)StrSize(Name);
+    CopyMem(p, &R, sizeof(R));
+    CopyMem(p + sizeof(R), Name, R.NameSize);
+    p += sizeof(R) + R.NameSize;
+    Hdr.Count++;
+  }
+
+  Hdr.Signature = CATALOG_CACHE_SIGNATURE;
+  Hdr.Version = CATALOG_CACHE_VERSION;
+  Hdr.HeaderSize = sizeof(Hdr);
+  Hdr.RecordsSize = (UINT32)Size;
+  Hdr.RecordsCrc = CalculateCrc32(Records, Size);
+
+  Status = VarWriterOpenFile(&Writer, Path);
+  if (!EFI_ERROR(Status)) {
+    VarWriterPut(&Writer, &Hdr, sizeof(Hdr));
+    VarWriterPut(&Writer, Records, Size);
+    Status = VarWriterClose(&Writer);
+  }
+
+  FreePool(Records);
+  return Status;
+}
+
+// =============================
+// Incremental validation walk
+// =============================
+EFI_STATUS
+VarCatalogSyncStart(OUT VAR_CATALOG_SYNC *Sync)
+{
+  ZeroMem(Sync, sizeof(*Sync));
+  Sync->NameBufSize = 1024;
+  Sync->NameBuf = AllocateZeroPool(Sync->NameBufSize);
+  if (Sync->NameBuf == NULL) {
+    Sync->Done = TRUE;
+    return EFI_OUT_OF_RESOURCES;
+  }
+  return EFI_SUCCESS;
+}
+
+// The store usually enumerates in the same order as last time, so the entry
+// after the previous match is tried before a linear search. The GUID is
+// resolved to its intern index once; names are compared only on a match.
+STATIC UINTN
+FindItem(IN OUT VAR_CATALOG_SYNC *Sync, IN VAR_CATALOG *Catalog, IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  UINTN Count = Catalog->Count;
+  UINT16 GuidIndex = VarCatalogFindGuid(Catalog, Guid);
+
+  if (GuidIndex == VAR_GUID_INDEX_NONE) return Count;
+
+  for (UINTN k = 0; k < Count; k++) {
+    UINTN i = (Sync->Hint + k) % Count;
+    if (Catalog->GuidIndex[i] == GuidIndex && VarCatalogNameEqual(Catalog, i, Name)) {
+      Sync->Hint = i + 1;
+      return i;
+    }
+  }
+  return Count;
+}
+
+STATIC VOID
+SyncFinish(IN OUT VAR_CATALOG_SYNC *Sync, IN VAR_CATALOG *Catalog, OUT BOOLEAN *Changed)
+{
+  for (UINTN i = 0; i < Catalog->Count; i++) {
+    if (Catalog->State[i] == VarItemCached) {
+      Catalog->State[i] = VarItemDeleted;
+      *Changed = TRUE;
+    }
+  }
+  FreePool(Sync->NameBuf);
+  Sync->NameBuf = NULL;
+  Sync->Done = TRUE;
+}
+
+EFI_STATUS
+VarCatalogSyncStep(IN OUT VAR_CATALOG_SYNC *Sync, IN OUT VAR_CATALOG *Catalog, IN UINTN Budget, OUT BOOLEAN *Changed)
+{
+  EFI_STATUS Status = EFI_SUCCESS;
+
+  *Changed = FALSE;
+
+  while (!Sync->Done && Budget-- > 0) {
+    UINTN ThisSize = Sync->NameBufSize;
+    UINTN Size = 0;
+    UINT32 Attr = 0;
+    UINTN i;
+
+    Status = gVarBackend->GetNextVariableName(&ThisSize, Sync->NameBuf, &Sync->Guid);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      CHAR16 *NewBuf = ReallocatePool(Sync->NameBufSize, ThisSize, Sync->NameBuf);
+      if (NewBuf == NULL) break;
+      Sync->NameBuf = NewBuf;
+      Sync->NameBufSize = ThisSize;
+      Budget++;
+      continue;
+    }
+    if (Status == EFI_NOT_FOUND) {
+      SyncFinish(Sync, Catalog, Changed);
+      return EFI_SUCCESS;
+    }
+    if (EFI_ERROR(Status)) break;
+
+    Sync->Walked++;
+    GetVariableDataSizeQuick(Sync->NameBuf, &Sync->Guid, &Size, &Attr);
+
+    i = FindItem(Sync, Catalog, Sync->NameBuf, &Sync->Guid);
+    if (i < Catalog->Count) {
+      if (Catalog->DataSize[i] != Size || Catalog->Attributes[i] != Attr) {
+        Catalog->DataSize[i] = (UINT32)Size;
+        Catalog->Attributes[i] = Attr;
+        Catalog->State[i] = VarItemStale;
+        *Changed = TRUE;
+      } else if (Catalog->State[i] == VarItemCached) {
+        Catalog->State[i] = VarItemVerified;
+      }
+      continue;
+    }
+
+    // not in the cached catalog: append
+    Status = VarCatalogAdd(Catalog, Sync->NameBuf, &Sync->Guid, Size, Attr, VarItemNew);
+    if (EFI_ERROR(Status)) break;
+    *Changed = TRUE;
+  }
+
+  if (EFI_ERROR(Status) && !Sync->Done) {
+    // give up validating; rows keep whatever state they reached
+    Sync->Status = Status;
+    if (Sync->NameBuf != NULL) FreePool(Sync->NameBuf);
+    Sync->NameBuf = NULL;
+    Sync->Done = TRUE;
+    *Changed = TRUE;
+  }
+  return Sync->Status;
+}
+
+VOID
+VarCatalogSyncAbort(IN OUT VAR_CATALOG_SYNC *Sync)
+{
+  if (Sync->NameBuf != NULL) FreePool(Sync->NameBuf);
+  Sync->NameBuf = NULL;
+  Sync->Done = TRUE;
+}
@@ -0,0 +1,440 @@
+#include "VariableTool.h"
+
+// =============================
+// Variable catalog: one entry per (name, GUID) with size and attributes,
+// built from a single GetNextVariableName walk and stored column-wise.
+// =============================
+
+// Size probe; since UEFI 2.7 the attributes are also returned with
+// EFI_BUFFER_TOO_SMALL, so this needs no data buffer.
+EFI_STATUS
+GetVariableDataSizeQuick(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINTN *OutSize, OUT UINT32 *OutAttr)
+{
+  EFI_STATUS Status;
+  UINTN Size = 0;
+  UINT32 Attr = 0;
+
+  if (OutSize) *OutSize = 0;
+  if (OutAttr) *OutAttr = 0;
+
+  Status = gVarBackend->GetVariable(Name, Guid, &Attr, &Size, NULL);
+  if (Status == EFI_BUFFER_TOO_SMALL || Status == EFI_SUCCESS) {
+    if (OutSize) *OutSize = Size;
+    if (OutAttr) *OutAttr = Attr;
+    return EFI_SUCCESS;
+  }
+  return Status;
+}
+
+VOID
+VarCatalogInit(OUT VAR_CATALOG *Catalog)
+{
+  ZeroMem(Catalog, sizeof(*Catalog));
+}
+
+VOID
+FreeAllVariables(IN OUT VAR_CATALOG *Catalog)
+{
+  if (Catalog->Rows != NULL) {
+    for (UINTN i = 0; i < Catalog->Count; i++) {
+      if (Catalog->Rows[i].Text != NULL) FreePool(Catalog->Rows[i].Text);
+    }
+    FreePool(Catalog->Rows);
+  }
+  if (Catalog->NameOffset != NULL) FreePool(Catalog->NameOffset);
+  if (Catalog->GuidIndex != NULL) FreePool(Catalog->GuidIndex);
+  if (Catalog->DataSize != NULL) FreePool(Catalog->DataSize);
+  if (Catalog->Attributes != NULL) FreePool(Catalog->Attributes);
+  if (Catalog->State != NULL) FreePool(Catalog->State);
+  if (Catalog->Names != NULL) FreePool(Catalog->Names);
+  if (Catalog->NameScratch != NULL) FreePool(Catalog->NameScratch);
+  if (Catalog->Guids != NULL) FreePool(Catalog->Guids);
+  ZeroMem(Catalog, sizeof(*Catalog));
+}
+
+// Grow one column from OldCount to NewCount elements; the column is left
+// alone on failure.
+STATIC BOOLEAN
+GrowColumn(IN OUT VOID **Column, IN UINTN ElementSize, IN UINTN OldCount, IN UINTN NewCount)
+{
+  VOID *New = ReallocatePool(OldCount * ElementSize, NewCount * ElementSize, *Column);
+
+  if (New == NULL) return FALSE;
+  *Column = New;
+  return TRUE;
+}
+
+UINT16
+VarCatalogFindGuid(IN VAR_CATALOG *Catalog, IN CONST EFI_GUID *Guid)
+{
+  for (UINTN i = 0; i < Catalog->GuidCount; i++) {
+    if (CompareGuid(&Catalog->Guids[i], Guid)) return (UINT16)i;
+  }
+  return VAR_GUID_INDEX_NONE;
+}
+
+STATIC EFI_STATUS
+InternGuid(IN OUT VAR_CATALOG *Catalog, IN CONST EFI_GUID *Guid, OUT UINT16 *Index)
+{
+  *Index = VarCatalogFindGuid(Catalog, Guid);
+  if (*Index != VAR_GUID_INDEX_NONE) return EFI_SUCCESS;
+
+  if (Catalog->GuidCount >= VAR_GUID_INDEX_NONE) return EFI_OUT_OF_RESOURCES;
+  if (Catalog->GuidCount == Catalog->GuidCapacity) {
+    UINTN NewCap = MAX(Catalog->GuidCapacity * 2, 32);
+    if (!GrowColumn((VOID **)&Catalog->Guids, sizeof(EFI_GUID), Catalog->GuidCapacity, NewCap)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Catalog->GuidCapacity = NewCap;
+  }
+  CopyGuid(&Catalog->Guids[Catalog->GuidCount], Guid);
+  *Index = (UINT16)Catalog->GuidCount++;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarCatalogAdd(IN OUT VAR_CATALOG *Catalog, IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, IN UINTN DataSize,
+              IN UINT32 Attributes, IN VAR_ITEM_STATE State)
+{
+  UINTN NameLength = 0;
+  BOOLEAN Wide = FALSE;
+  UINTN NameStart;
+  UINTN NameBytes;
+  UINTN i = Catalog->Count;
+  UINT16 GuidIndex;
+
+  for (; Name[NameLength] != L'\0'; NameLength++) {
+    if (Name[NameLength] > 0x7F) Wide = TRUE;
+  }
+  NameLength++;
+
+  if (EFI_ERROR(InternGuid(Catalog, Guid, &GuidIndex))) return EFI_OUT_OF_RESOURCES;
+
+  // UTF-16 names start on an even offset
+  NameStart = Wide ? ALIGN_VALUE(Catalog->NamesUsed, sizeof(CHAR16)) : Catalog->NamesUsed;
+  NameBytes = Wide ? NameLength * sizeof(CHAR16) : NameLength;
+  if (NameStart + NameBytes > Catalog->NamesSize) {
+    UINTN NewSize = MAX(Catalog->NamesSize * 2, SIZE_4KB);
+    while (NewSize < NameStart + NameBytes) NewSize *= 2;
+    if (NewSize > VAR_NAME_WIDE ||
+        !GrowColumn((VOID **)&Catalog->Names, 1, Catalog->NamesSize, NewSize)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Catalog->NamesSize = NewSize;
+  }
+
+  // room to widen the longest name, so VarCatalogName() cannot fail
+  if (NameLength * sizeof(CHAR16) > Catalog->NameScratchSize) {
+    UINTN NewSize = MAX(NameLength * sizeof(CHAR16), 128);
+    CHAR16 *Scratch = AllocatePool(NewSize);
+    if (Scratch == NULL) return EFI_OUT_OF_RESOURCES;
+    if (Catalog->NameScratch != NULL) FreePool(Catalog->NameScratch);
+    Catalog->NameScratch = Scratch;
+    Catalog->NameScratchSize = NewSize;
+  }
+
+  // every column grows together; Capacity only moves once all have
+  if (i == Catalog->Capacity) {
+    UINTN Old = Catalog->Capacity;
+    UINTN New = MAX(Old * 2, 128);
+    if (!GrowColumn((VOID **)&Catalog->NameOffset, sizeof(UINT32), Old, New) ||
+        !GrowColumn((VOID **)&Catalog->GuidIndex, sizeof(UINT16), Old, New) ||
+        !GrowColumn((VOID **)&Catalog->DataSize, sizeof(UINT32), Old, New) ||
+        !GrowColumn((VOID **)&Catalog->Attributes, sizeof(UINT32), Old, New) ||
+        !GrowColumn((VOID **)&Catalog->State, sizeof(UINT8), Old, New) ||
+        (Catalog->Rows != NULL && !GrowColumn((VOID **)&Catalog->Rows, sizeof(VAR_ROW), Old, New))) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    if (Catalog->Rows != NULL) ZeroMem(&Catalog->Rows[Old], (New - Old) * sizeof(VAR_ROW));
+    Catalog->Capacity = New;
+  }
+
+  if (Wide) {
+    CopyMem(Catalog->Names + NameStart, Name, NameBytes);
+    Catalog->NameOffset[i] = (UINT32)NameStart | VAR_NAME_WIDE;
+  } else {
+    for (UINTN k = 0; k < NameLength; k++) {
+      Catalog->Names[NameStart + k] = (UINT8)Name[k];
+    }
+    Catalog->NameOffset[i] = (UINT32)NameStart;
+  }
+  Catalog->NamesUsed = NameStart + NameBytes;
+  Catalog->GuidIndex[i] = GuidIndex;
+  Catalog->DataSize[i] = (UINT32)DataSize;
+  Catalog->Attributes[i] = Attributes;
+  Catalog->State[i] = (UINT8)State;
+  Catalog->Count++;
+  return EFI_SUCCESS;
+}
+
+CHAR16 *
+VarCatalogName(IN VAR_CATALOG *Catalog, IN UINTN Index)
+{
+  UINT32 Offset = Catalog->NameOffset[Index];
+  CONST UINT8 *Name = Catalog->Names + (Offset & ~VAR_NAME_WIDE);
+  UINTN k = 0;
+
+  if (Offset & VAR_NAME_WIDE) return (CHAR16 *)Name;
+
+  do {
+    Catalog->NameScratch[k] = Name[k];
+  } while (Name[k++] != '\0');
+  return Catalog->NameScratch;
+}
+
+BOOLEAN
+VarCatalogNameEqual(IN VAR_CATALOG *Catalog, IN UINTN Index, IN CONST CHAR16 *Name)
+{
+  UINT32 Offset = Catalog->NameOffset[Index];
+  CONST UINT8 *Pooled = Catalog->Names + (Offset & ~VAR_NAME_WIDE);
+
+  if (Offset & VAR_NAME_WIDE) return StrCmp((CONST CHAR16 *)Pooled, Name) == 0;
+
+  for (; *Pooled == *Name; Pooled++, Name++) {
+    if (*Name == L'\0') return TRUE;
+  }
+  return FALSE;
+}
+
+EFI_STATUS
+CollectAllVariables(OUT VAR_CATALOG *Catalog)
+{
+  EFI_STATUS Status;
+  UINTN NameBufSize;
+  CHAR16 *NameBuf = NULL;
+  EFI_GUID Guid;
+
+  VarCatalogInit(Catalog);
+
+  NameBufSize = 1024;
+  NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
+  if (NameBuf == NULL) return EFI_OUT_OF_RESOURCES;
+
+  ZeroMem(&Guid, sizeof(Guid));
+  NameBuf[0] = L'\0';
+
+  while (TRUE) {
+    UINTN ThisSize = NameBufSize;
+    UINTN DataSize = 0;
+    UINT32 Attributes = 0;
+
+    Status = gVarBackend->GetNextVariableName(&ThisSize, NameBuf, &Guid);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      // keep the current name, it is the enumeration cursor
+      CHAR16 *NewBuf = ReallocatePool(NameBufSize, ThisSize, NameBuf);
+      if (NewBuf == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        break;
+      }
+      NameBuf = NewBuf;
+      NameBufSize = ThisSize;
+      continue;
+    }
+    if (Status == EFI_NOT_FOUND) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+    if (EFI_ERROR(Status)) break;
+
+    GetVariableDataSizeQuick(NameBuf, &Guid, &DataSize, &Attributes);
+    Status = VarCatalogAdd(Catalog, NameBuf, &Guid, DataSize, Attributes, VarItemVerified);
+    if (EFI_ERROR(Status)) break;
+  }
+
+  FreePool(NameBuf);
+  if (EFI_ERROR(Status)) FreeAllVariables(Catalog);
+  return Status;
+}
+
+EFI_STATUS
+VarForEachVariable(IN VAR_ENUM_CALLBACK Callback, IN VOID *Context)
+{
+  EFI_STATUS Status;
+  UINTN NameBufSize = 1024;
+  CHAR16 *NameBuf;
+  EFI_GUID Guid;
+
+  NameBuf = AllocateZeroPool(NameBufSize);
+  if (NameBuf == NULL) return EFI_OUT_OF_RESOURCES;
+  ZeroMem(&Guid, sizeof(Guid));
+
+  while (TRUE) {
+    UINTN ThisSize = NameBufSize;
+
+    Status = gVarBackend->GetNextVariableName(&ThisSize, NameBuf, &Guid);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      // grow while keeping the current name: it is the enumeration cursor
+      CHAR16 *NewBuf = ReallocatePool(NameBufSize, ThisSize, NameBuf);
+      if (NewBuf == NULL) { Status = EFI_OUT_OF_RESOURCES; break; }
+      NameBuf = NewBuf;
+      NameBufSize = ThisSize;
+      continue;
+    }
+    if (Status == EFI_NOT_FOUND) { Status = EFI_SUCCESS; break; }
+    if (EFI_ERROR(Status)) break;
+
+    if (!Callback(NameBuf, &Guid, Context)) break;
+  }
+
+  FreePool(NameBuf);
+  return Status;
+}
+
+UINT32
+VarNameHash(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid)
+{
+  // FNV-1a over the name, folded with the first GUID dword
+  UINT32 Hash = 0x811C9DC5;
+  for (; *Name != L'\0'; Name++) {
+    Hash = (Hash ^ (UINT32)*Name) * 0x01000193;
+  }
+  return Hash ^ Guid->Data1;
+}
+
+// Name pattern match: '*' any run, '?' any one char, '#' one hex digit
+// (so "Boot####" matches Boot0000..BootFFFF). Case sensitive, like the
+// variable store itself. Names are read through NameAt() so pooled ASCII
+// names match without being widened first.
+STATIC CHAR16
+NameAt(IN CONST VOID *Name, IN BOOLEAN Wide, IN UINTN Index)
+{
+  return Wide ? ((CONST CHAR16 *)Name)[Index] : ((CONST UINT8 *)Name)[Index];
+}
+
+STATIC BOOLEAN
+NameMatch(IN CONST CHAR16 *Pattern, IN CONST VOID *Name, IN BOOLEAN Wide)
+{
+  CONST CHAR16 *StarPat = NULL;
+  UINTN StarName = 0;
+  UINTN n = 0;
+  CHAR16 c;
+
+  while ((c = NameAt(Name, Wide, n)) != L'\0') {
+    if (*Pattern == L'*') {
+      StarPat = ++Pattern;
+      StarName = n;
+      continue;
+    }
+
+    if (*Pattern == L'?' ||
+        (*Pattern == L'#' && ((c >= L'0' && c <= L'9') || (c >= L'A' && c <= L'F') || (c >= L'a' && c <= L'f'))) ||
+        (*Pattern != L'\0' && *Pattern == c)) {
+      Pattern++;
+      n++;
+      continue;
+    }
+
+    // mismatch: let the last '*' swallow one more character
+    if (StarPat == NULL) return FALSE;
+    Pattern = StarPat;
+    n = ++StarName;
+  }
+
+  while (*Pattern == L'*') Pattern++;
+  return (*Pattern == L'\0');
+}
+
+BOOLEAN
+VarNameMatch(IN CONST CHAR16 *Pattern, IN CONST CHAR16 *Name)
+{
+  return NameMatch(Pattern, Name, TRUE);
+}
+
+BOOLEAN
+VarCatalogNameMatch(IN VAR_CATALOG *Catalog, IN UINTN Index, IN CONST CHAR16 *Pattern)
+{
+  UINT32 Offset = Catalog->NameOffset[Index];
+
+  return NameMatch(Pattern, Catalog->Names + (Offset & ~VAR_NAME_WIDE), (Offset & VAR_NAME_WIDE) != 0);
+}
+
+// =============================
+// Writes and the session growth journal
+// Non-volatile writes are space-checked first. Appends are remembered with
+// the size the variable had before the first append of this session, so
+// the table can show how much it grew.
+// =============================
+typedef struct {
+  LIST_ENTRY  Link;
+  EFI_GUID    Guid;
+  UINTN       BaseSize;
+  CHAR16      Name[1];    // variable length
+} GROWTH_ENTRY;
+
+STATIC LIST_ENTRY mGrowthList = INITIALIZE_LIST_HEAD_VARIABLE(mGrowthList);
+
+STATIC GROWTH_ENTRY *
+FindGrowth(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid)
+{
+  for (LIST_ENTRY *Link = GetFirstNode(&mGrowthList); !IsNull(&mGrowthList, Link); Link = GetNextNode(&mGrowthList, Link)) {
+    GROWTH_ENTRY *Entry = BASE_CR(Link, GROWTH_ENTRY, Link);
+    if (CompareGuid(&Entry->Guid, Guid) && StrCmp(Entry->Name, Name) == 0) {
+      return Entry;
+    }
+  }
+  return NULL;
+}
+
+EFI_STATUS
+VarSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  EFI_STATUS Status;
+  UINTN OldSize = 0;
+  BOOLEAN Append = (Attributes & EFI_VARIABLE_APPEND_WRITE) != 0;
+  VAR_SPACE_CHECK Check;
+
+  // refuse up front what the store cannot take even after reclaiming the
+  // record this write replaces, rather than let the firmware fail it
+  if (DataSize > 0 && (Attributes & EFI_VARIABLE_NON_VOLATILE)) {
+    UINTN StoredSize = DataSize;
+    UINTN Offset;
+    EFI_TIME Signed;
+
+    if ((Attributes & EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS) &&
+        !EFI_ERROR(VarAuthInspect(Data, DataSize, &Signed, &Offset))) {
+      StoredSize -= Offset;   // the signature is not stored
+    }
+    if (VarSpaceCheck(Name, Guid, Attributes, StoredSize, &Check) >= VarSpaceNoRoom) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (Append && FindGrowth(Name, Guid) == NULL) {
+    GetVariableDataSizeQuick(Name, Guid, &OldSize, NULL);
+  }
+
+  Status = gVarBackend->SetVariable(Name, Guid, Attributes, DataSize, Data);
+  VarCacheInvalidate(Name, Guid);
+
+  if (!EFI_ERROR(Status) && Append && FindGrowth(Name, Guid) == NULL) {
+    UINTN NameSize = StrSize(Name);
+    GROWTH_ENTRY *Entry = AllocatePool(OFFSET_OF(GROWTH_ENTRY, Name) + NameSize);
+    if (Entry != NULL) {
+      CopyGuid(&Entry->Guid, Guid);
+      Entry->BaseSize = OldSize;
+      CopyMem(Entry->Name, Name, NameSize);
+      InsertTailList(&mGrowthList, &Entry->Link);
+    }
+  }
+  return Status;
+}
+
+BOOLEAN
+VarGrowthLookup(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, OUT UINTN *BaseSize)
+{
+  GROWTH_ENTRY *Entry = FindGrowth(Name, Guid);
+
+  if (Entry == NULL) return FALSE;
+  *BaseSize = Entry->BaseSize;
+  return TRUE;
+}
+
+VOID
+VarGrowthReset(VOID)
+{
+  while (!IsListEmpty(&mGrowthList)) {
+    LIST_ENTRY *Link = GetFirstNode(&mGrowthList);
+    RemoveEntryList(Link);
+    FreePool(BASE_CR(Link, GROWTH_ENTRY, Link));
+  }
+}
@@ -0,0 +1,305 @@
+#include "VariableTool.h"
+
+#include <Library/DevicePathLib.h>
+
+#include <Guid/GlobalVariable.h>
+#include <Guid/ImageAuthentication.h>
+
+// =============================
+// Typed value decoders for well-known variables
+// The registry is only consulted when a variable is opened in the detail
+// view; listing, search and export never decode.
+// =============================
+typedef VOID (*VAR_DECODER)(IN CONST UINT8 *Data, IN UINTN DataSize);
+
+typedef struct {
+  EFI_GUID      *Guid;      // NULL => any vendor
+  CONST CHAR16  *Pattern;   // VarNameMatch() pattern
+  CONST CHAR16  *Title;
+  VAR_DECODER   Decode;
+} VAR_DECODER_ENTRY;
+
+STATIC VOID
+DecodeUint16List(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINTN Count = DataSize / sizeof(UINT16);
+
+  Print(L"  %u entries:", (UINT32)Count);
+  for (UINTN i = 0; i < Count; i++) {
+    Print(L" %04x", ReadUnaligned16((CONST UINT16 *)(Data + i * 2)));
+  }
+  Print(L"\n");
+  if (DataSize % sizeof(UINT16) != 0) {
+    Print(L"  (%u trailing byte(s) ignored)\n", (UINT32)(DataSize % sizeof(UINT16)));
+  }
+}
+
+STATIC VOID
+DecodeTimeout(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINT16 Value;
+
+  if (DataSize < sizeof(UINT16)) {
+    Print(L"  (too short)\n");
+    return;
+  }
+  Value = ReadUnaligned16((CONST UINT16 *)Data);
+  if (Value == 0xFFFF) {
+    Print(L"  Wait for key (0xFFFF)\n");
+  } else {
+    Print(L"  %u second(s)\n", (UINT32)Value);
+  }
+}
+
+STATIC VOID
+DecodeBoolean(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  if (DataSize < 1) {
+    Print(L"  (too short)\n");
+    return;
+  }
+  Print(L"  %s (%u)\n", (Data[0] == 0) ? L"Disabled" : L"Enabled", (UINT32)Data[0]);
+}
+
+STATIC VOID
+DecodeAsciiString(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  Print(L"  \"");
+  for (UINTN i = 0; i < DataSize && Data[i] != 0; i++) {
+    Print(L"%c", (Data[i] >= 0x20 && Data[i] <= 0x7E) ? (CHAR16)Data[i] : L'.');
+  }
+  Print(L"\"\n");
+}
+
+STATIC BOOLEAN
+LooksLikeUtf16String(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINTN Chars = DataSize / sizeof(CHAR16);
+
+  if (DataSize < 2 * sizeof(CHAR16) || (DataSize % sizeof(CHAR16)) != 0) return FALSE;
+  if (ReadUnaligned16((CONST UINT16 *)(Data + DataSize - sizeof(CHAR16))) != 0) return FALSE;
+
+  for (UINTN i = 0; i + 1 < Chars; i++) {
+    UINT16 c = ReadUnaligned16((CONST UINT16 *)(Data + i * 2));
+    if (c < 0x20 || c == 0x7F || (c >= 0xD800 && c <= 0xDFFF)) return FALSE;
+  }
+  return TRUE;
+}
+
+STATIC VOID
+DecodeUtf16String(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINTN Chars = DataSize / sizeof(CHAR16);
+
+  Print(L"  \"");
+  for (UINTN i = 0; i < Chars; i++) {
+    CHAR16 c = (CHAR16)ReadUnaligned16((CONST UINT16 *)(Data + i * 2));
+    if (c == L'\0') break;
+    Print(L"%c", c);
+  }
+  Print(L"\"\n");
+}
+
+// One or more device path instances, each printed on its own line.
+STATIC VOID
+PrintDevicePathText(IN CONST UINT8 *Data, IN UINTN DataSize, IN CONST CHAR16 *Indent)
+{
+  EFI_DEVICE_PATH_PROTOCOL *Copy;
+  EFI_DEVICE_PATH_PROTOCOL *Node;
+
+  if (DataSize == 0) {
+    Print(L"%s(empty)\n", Indent);
+    return;
+  }
+
+  // device path nodes may be unaligned inside the payload
+  Copy = AllocateCopyPool(DataSize, Data);
+  if (Copy == NULL) {
+    Print(L"%s(out of memory)\n", Indent);
+    return;
+  }
+
+  if (!IsDevicePathValid(Copy, DataSize)) {
+    Print(L"%s(invalid device path)\n", Indent);
+    FreePool(Copy);
+    return;
+  }
+
+  // convert instance by instance: terminate each one in place
+  Node = Copy;
+  while (TRUE) {
+    EFI_DEVICE_PATH_PROTOCOL *Start = Node;
+    BOOLEAN Last;
+    CHAR16 *Text;
+
+    while (!IsDevicePathEndType(Node)) {
+      Node = NextDevicePathNode(Node);
+    }
+    Last = IsDevicePathEnd(Node);
+    SetDevicePathEndNode(Node);
+
+    Text = ConvertDevicePathToText(Start, TRUE, TRUE);
+    Print(L"%s%s\n", Indent, (Text != NULL) ? Text : L"(not convertible)");
+    if (Text != NULL) FreePool(Text);
+
+    if (Last) break;
+    Node = NextDevicePathNode(Node);
+  }
+
+  FreePool(Copy);
+}
+
+STATIC VOID
+DecodeDevicePath(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  PrintDevicePathText(Data, DataSize, L"  ");
+}
+
+// EFI_LOAD_OPTION: Attributes, FilePathListLength, Description, FilePathList, OptionalData
+STATIC VOID
+DecodeLoadOption(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINT32 Attr;
+  UINT16 PathLen;
+  UINTN Offset;
+
+  if (DataSize < sizeof(UINT32) + sizeof(UINT16) + sizeof(CHAR16)) {
+    Print(L"  (too short for EFI_LOAD_OPTION)\n");
+    return;
+  }
+
+  Attr = ReadUnaligned32((CONST UINT32 *)Data);
+  PathLen = ReadUnaligned16((CONST UINT16 *)(Data + 4));
+
+  Print(L"  Attributes : 0x%08x%s%s\n", Attr,
+        (Attr & LOAD_OPTION_ACTIVE) ? L" ACTIVE" : L"",
+        (Attr & LOAD_OPTION_HIDDEN) ? L" HIDDEN" : L"");
+
+  Print(L"  Description: \"");
+  for (Offset = 6; Offset + 1 < DataSize; Offset += 2) {
+    CHAR16 c = (CHAR16)ReadUnaligned16((CONST UINT16 *)(Data + Offset));
+    if (c == L'\0') break;
+    Print(L"%c", c);
+  }
+  Print(L"\"\n");
+  Offset += sizeof(CHAR16);
+
+  if (Offset > DataSize || PathLen > DataSize - Offset) {
+    Print(L"  (FilePathListLength %u exceeds payload)\n", (UINT32)PathLen);
+    return;
+  }
+
+  Print(L"  File path  :\n");
+  PrintDevicePathText(Data + Offset, PathLen, L"    ");
+  Offset += PathLen;
+
+  if (Offset < DataSize) {
+    Print(L"  Optional data: %u byte(s)\n", (UINT32)(DataSize - Offset));
+  }
+}
+
+STATIC CONST struct {
+  EFI_GUID      *Guid;
+  CONST CHAR16  *Name;
+} mSignatureTypes[] = {
+  { &gEfiCertSha256Guid,       L"SHA256"       },
+  { &gEfiCertX509Guid,         L"X509"         },
+  { &gEfiCertRsa2048Guid,      L"RSA2048"      },
+  { &gEfiCertSha1Guid,         L"SHA1"         },
+  { &gEfiCertX509Sha256Guid,   L"X509_SHA256"  },
+  { &gEfiCertX509Sha384Guid,   L"X509_SHA384"  },
+  { &gEfiCertX509Sha512Guid,   L"X509_SHA512"  },
+  { &gEfiCertSha384Guid,       L"SHA384"       },
+  { &gEfiCertSha512Guid,       L"SHA512"       },
+};
+
+STATIC VOID
+DecodeSignatureDatabase(IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  UINTN Offset = 0;
+  UINTN Lists = 0;
+  UINTN Total = 0;
+
+  while (Offset + sizeof(EFI_SIGNATURE_LIST) <= DataSize) {
+    EFI_SIGNATURE_LIST List;
+    CONST CHAR16 *TypeName = NULL;
+    UINTN Count;
+
+    CopyMem(&List, Data + Offset, sizeof(List));
+    if (List.SignatureListSize < sizeof(EFI_SIGNATURE_LIST) + List.SignatureHeaderSize ||
+        List.SignatureListSize > DataSize - Offset || List.SignatureSize == 0) {
+      Print(L"  (malformed EFI_SIGNATURE_LIST at offset 0x%x)\n", (UINT32)Offset);
+      break;
+    }
+
+    for (UINTN i = 0; i < ARRAY_SIZE(mSignatureTypes); i++) {
+      if (CompareGuid(&List.SignatureType, mSignatureTypes[i].Guid)) {
+        TypeName = mSignatureTypes[i].Name;
+        break;
+      }
+    }
+
+    Count = (List.SignatureListSize - sizeof(EFI_SIGNATURE_LIST) - List.SignatureHeaderSize) / List.SignatureSize;
+    if (TypeName != NULL) {
+      Print(L"  List %u: %-12s %u signature(s), %u bytes each\n",
+            (UINT32)Lists, TypeName, (UINT32)Count, List.SignatureSize);
+    } else {
+      Print(L"  List %u: %g %u signature(s), %u bytes each\n",
+            (UINT32)Lists, &List.SignatureType, (UINT32)Count, List.SignatureSize);
+    }
+
+    Lists++;
+    Total += Count;
+    Offset += List.SignatureListSize;
+  }
+
+  Print(L"  Total: %u list(s), %u signature(s)\n", (UINT32)Lists, (UINT32)Total);
+}
+
+STATIC CONST VAR_DECODER_ENTRY mDecoders[] = {
+  { &gEfiGlobalVariableGuid,        L"BootOrder",              L"UINT16 option list",    DecodeUint16List        },
+  { &gEfiGlobalVariableGuid,        L"DriverOrder",            L"UINT16 option list",    DecodeUint16List        },
+  { &gEfiGlobalVariableGuid,        L"SysPrepOrder",           L"UINT16 option list",    DecodeUint16List        },
+  { &gEfiGlobalVariableGuid,        L"BootNext",               L"UINT16 option list",    DecodeUint16List        },
+  { &gEfiGlobalVariableGuid,        L"BootCurrent",            L"UINT16 option list",    DecodeUint16List        },
+  { &gEfiGlobalVariableGuid,        L"Boot####",               L"EFI_LOAD_OPTION",       DecodeLoadOption        },
+  { &gEfiGlobalVariableGuid,        L"Driver####",             L"EFI_LOAD_OPTION",       DecodeLoadOption        },
+  { &gEfiGlobalVariableGuid,        L"SysPrep####",            L"EFI_LOAD_OPTION",       DecodeLoadOption        },
+  { &gEfiGlobalVariableGuid,        L"PlatformRecovery####",   L"EFI_LOAD_OPTION",       DecodeLoadOption        },
+  { &gEfiGlobalVariableGuid,        L"Timeout",                L"Boot manager timeout",  DecodeTimeout           },
+  { &gEfiGlobalVariableGuid,        L"SecureBoot",             L"BOOLEAN",               DecodeBoolean           },
+  { &gEfiGlobalVariableGuid,        L"SetupMode",              L"BOOLEAN",               DecodeBoolean           },
+  { &gEfiGlobalVariableGuid,        L"AuditMode",              L"BOOLEAN",               DecodeBoolean           },
+  { &gEfiGlobalVariableGuid,        L"DeployedMode",           L"BOOLEAN",               DecodeBoolean           },
+  { &gEfiGlobalVariableGuid,        L"PK",                     L"EFI_SIGNATURE_LIST",    DecodeSignatureDatabase },
+  { &gEfiGlobalVariableGuid,        L"KEK",                    L"EFI_SIGNATURE_LIST",    DecodeSignatureDatabase },
+  { &gEfiGlobalVariableGuid,        L"*Default",               L"EFI_SIGNATURE_LIST",    DecodeSignatureDatabase },
+  { &gEfiImageSecurityDatabaseGuid, L"db?",                    L"EFI_SIGNATURE_LIST",    DecodeSignatureDatabase },
+  { &gEfiImageSecurityDatabaseGuid, L"db",                     L"EFI_SIGNATURE_LIST",    DecodeSignatureDatabase },
+  { &gEfiGlobalVariableGuid,        L"Con*",                   L"Device path",           DecodeDevicePath        },
+  { &gEfiGlobalVariableGuid,        L"ErrOut*",                L"Device path",           DecodeDevicePath        },
+  { &gEfiGlobalVariableGuid,        L"*Lang",                  L"ASCII string",          DecodeAsciiString       },
+  { &gEfiGlobalVariableGuid,        L"*LangCodes",             L"ASCII string",          DecodeAsciiString       },
+};
+
+BOOLEAN
+VarDecodeAndPrint(IN CHAR16 *Name, IN EFI_GUID *Guid, IN CONST UINT8 *Data, IN UINTN DataSize)
+{
+  for (UINTN i = 0; i < ARRAY_SIZE(mDecoders); i++) {
+    if (mDecoders[i].Guid != NULL && !CompareGuid(mDecoders[i].Guid, Guid)) continue;
+    if (!VarNameMatch(mDecoders[i].Pattern, Name)) continue;
+
+    Print(L"Decoded (%s):\n", mDecoders[i].Title);
+    mDecoders[i].Decode(Data, DataSize);
+    return TRUE;
+  }
+
+  // any vendor: NUL-terminated printable UTF-16 payloads
+  if (LooksLikeUtf16String(Data, DataSize)) {
+    Print(L"Decoded (UTF-16 string):\n");
+    DecodeUtf16String(Data, DataSize);
+    return TRUE;
+  }
+
+  return FALSE;
+}
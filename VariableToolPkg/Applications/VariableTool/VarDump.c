@@ -0,0 +1,99 @@
+#include "VariableTool.h"
+
+// =============================
+// Streaming "dump all"
+// Walks the store with GetNextVariableName and writes each variable as a
+// human-readable hex dump. Only the name buffer, the bulk-read scratch
+// buffer and the writer buffer are held, so memory use does not depend on
+// the number or total size of variables.
+// =============================
+STATIC CONST struct {
+  UINT32       Bit;
+  CONST CHAR8  *Tag;
+} mAttrTags[] = {
+  { EFI_VARIABLE_NON_VOLATILE,                          "NV" },
+  { EFI_VARIABLE_BOOTSERVICE_ACCESS,                    "BS" },
+  { EFI_VARIABLE_RUNTIME_ACCESS,                        "RT" },
+  { EFI_VARIABLE_HARDWARE_ERROR_RECORD,                 "HR" },
+  { EFI_VARIABLE_AUTHENTICATED_WRITE_ACCESS,            "AW" },
+  { EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS, "AT" },
+  { EFI_VARIABLE_APPEND_WRITE,                          "AP" },
+};
+
+VOID
+VarAttributesToAscii(IN UINT32 Attributes, OUT CHAR8 *Buffer, IN UINTN BufferSize)
+{
+  UINTN Used = 0;
+
+  if (Buffer == NULL || BufferSize == 0) return;
+  Buffer[0] = '\0';
+
+  for (UINTN i = 0; i < ARRAY_SIZE(mAttrTags); i++) {
+    if ((Attributes & mAttrTags[i].Bit) == 0) continue;
+    if (Used > 0 && Used + 1 < BufferSize) Buffer[Used++] = '|';
+    for (CONST CHAR8 *Tag = mAttrTags[i].Tag; *Tag != '\0' && Used + 1 < BufferSize; Tag++) {
+      Buffer[Used++] = *Tag;
+    }
+  }
+  Buffer[Used] = '\0';
+}
+
+STATIC VOID
+DumpOneVariable(IN OUT VAR_WRITER *Writer, IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+  UINT32 Attr = 0;
+  UINT8 *Data = NULL;
+  UINTN DataSize = 0;
+  CHAR8 AttrText[32];
+  CHAR8 Line[96];
+
+  VarWriterPrint(Writer, "Name: %s\nGUID: ", Name);
+  VarWriterPut(Writer, Line, VarFormatGuid(Guid, Line));
+  VarWriterPut(Writer, "\n", 1);
+
+  Status = VarReadBulk(Name, Guid, &Attr, &Data, &DataSize);
+  if (EFI_ERROR(Status)) {
+    VarWriterPrint(Writer, "GetVariable failed: %r\n\n", Status);
+    return;
+  }
+
+  VarAttributesToAscii(Attr, AttrText, sizeof(AttrText));
+  VarWriterPrint(Writer, "Attributes: 0x%08x (%a)\nSize: %u\n", Attr, AttrText, (UINT32)DataSize);
+
+  for (UINTN Offset = 0; Offset < DataSize; Offset += 16) {
+    UINTN Count = MIN(16, DataSize - Offset);
+    VarWriterPut(Writer, Line, VarFormatDumpLine(Offset, Data + Offset, Count, Line));
+  }
+  VarWriterPut(Writer, "\n", 1);
+}
+
+typedef struct {
+  VAR_WRITER  *Writer;
+  UINTN       Count;
+} DUMP_CONTEXT;
+
+STATIC BOOLEAN
+DumpCallback(IN CHAR16 *Name, IN EFI_GUID *Guid, IN VOID *Context)
+{
+  DUMP_CONTEXT *Ctx = Context;
+
+  DumpOneVariable(Ctx->Writer, Name, Guid);
+  Ctx->Count++;
+  return !EFI_ERROR(Ctx->Writer->Status);
+}
+
+EFI_STATUS
+VarDumpAll(IN OUT VAR_WRITER *Writer, OUT UINTN *OutCount)
+{
+  EFI_STATUS Status;
+  DUMP_CONTEXT Ctx;
+
+  Ctx.Writer = Writer;
+  Ctx.Count = 0;
+
+  Status = VarForEachVariable(DumpCallback, &Ctx);
+
+  if (OutCount) *OutCount = Ctx.Count;
+  return EFI_ERROR(Status) ? Status : Writer->Status;
+}
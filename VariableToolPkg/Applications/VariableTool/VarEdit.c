@@ -0,0 +1,310 @@
+#include "VariableTool.h"
+
+// =============================
+// In-place hex editor
+// Edits a private copy of the cached payload. Changed bytes are found by
+// comparing against the pinned original, so no separate change map is
+// kept. Saving writes once, with the attributes GetVariable returned, and
+// is skipped entirely when the buffer matches the original. Bytes added
+// past the original end (Ins) go out as an APPEND_WRITE of just the tail
+// when the original bytes are untouched.
+// =============================
+#define EDIT_HEADER_ROWS  4
+#define EDIT_FOOTER_ROWS  3
+#define EDIT_HEX_COLUMN   10    // "00000000  "
+#define EDIT_BYTES_PER_ROW 16
+
+typedef struct {
+  CHAR16       *Name;
+  EFI_GUID     *Guid;
+  VAR_PAYLOAD  *Orig;       // pinned cache entry
+  UINT8        *Work;       // edited copy
+  UINTN        Size;        // >= Orig->DataSize
+  UINTN        Capacity;
+  UINTN        Cursor;      // byte index
+  BOOLEAN      LowNibble;
+  UINTN        Top;         // first visible row
+  UINTN        PageRows;
+} EDIT_STATE;
+
+STATIC BOOLEAN
+IsChanged(IN EDIT_STATE *Ed, IN UINTN Idx)
+{
+  return (Idx >= Ed->Orig->DataSize) || (Ed->Work[Idx] != Ed->Orig->Data[Idx]);
+}
+
+STATIC UINTN
+CountChanged(IN EDIT_STATE *Ed)
+{
+  UINTN Changed = Ed->Size - Ed->Orig->DataSize;
+
+  for (UINTN i = 0; i < Ed->Orig->DataSize; i++) {
+    if (Ed->Work[i] != Ed->Orig->Data[i]) Changed++;
+  }
+  return Changed;
+}
+
+STATIC VOID
+DrawRow(IN EDIT_STATE *Ed, IN UINTN Row)
+{
+  UINTN Base = Row * EDIT_BYTES_PER_ROW;
+  UINTN ScreenRow = EDIT_HEADER_ROWS + (Row - Ed->Top);
+
+  gST->ConOut->SetCursorPosition(gST->ConOut, 0, ScreenRow);
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  if (Base >= Ed->Size) {
+    // blank the row (80 columns is the minimum text mode width)
+    Print(L"%-79s", L"");
+    return;
+  }
+
+  Print(L"%08x  ", (UINT32)Base);
+
+  for (UINTN i = 0; i < EDIT_BYTES_PER_ROW; i++) {
+    UINTN Idx = Base + i;
+    if (Idx >= Ed->Size) {
+      SetTextAttr(EFI_LIGHTGRAY);
+      Print(L"   ");
+      continue;
+    }
+    SetTextAttr(IsChanged(Ed, Idx) ? EFI_YELLOW : EFI_LIGHTGRAY);
+    Print(L"%02x ", Ed->Work[Idx]);
+  }
+
+  SetTextAttr(EFI_LIGHTGRAY);
+  Print(L" |");
+  for (UINTN i = 0; i < EDIT_BYTES_PER_ROW && Base + i < Ed->Size; i++) {
+    UINT8 c = Ed->Work[Base + i];
+    Print(L"%c", (c >= 0x20 && c <= 0x7E) ? (CHAR16)c : L'.');
+  }
+  Print(L"|  ");
+}
+
+STATIC VOID
+DrawStatus(IN EDIT_STATE *Ed)
+{
+  gST->ConOut->SetCursorPosition(gST->ConOut, 0, EDIT_HEADER_ROWS + Ed->PageRows + 1);
+  SetTextAttr(EFI_LIGHTGRAY);
+  Print(L"Offset: 0x%08x  Size: %u (+%u)  Changed: %u byte(s)        \n", (UINT32)Ed->Cursor,
+        (UINT32)Ed->Size, (UINT32)(Ed->Size - Ed->Orig->DataSize), (UINT32)CountChanged(Ed));
+  Print(L"Keys: arrows PgUp/PgDn Home/End  0-9 a-f edit  Ins append  Del revert  F2 save  ESC exit");
+}
+
+STATIC VOID
+DrawPage(IN EDIT_STATE *Ed)
+{
+  CHAR8 AttrText[32];
+
+  gST->ConOut->ClearScreen(gST->ConOut);
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"Edit: %s  %g\n", Ed->Name, Ed->Guid);
+  SetTextAttr(EFI_LIGHTGRAY);
+  VarAttributesToAscii(Ed->Orig->Attributes, AttrText, sizeof(AttrText));
+  Print(L"Size: %u  Attributes: 0x%08x (%a)\n\n", (UINT32)Ed->Orig->DataSize, Ed->Orig->Attributes, AttrText);
+  Print(L"          00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f\n");
+
+  for (UINTN r = 0; r < Ed->PageRows; r++) {
+    DrawRow(Ed, Ed->Top + r);
+  }
+  DrawStatus(Ed);
+}
+
+STATIC VOID
+PlaceCursor(IN EDIT_STATE *Ed)
+{
+  UINTN Row = Ed->Cursor / EDIT_BYTES_PER_ROW;
+  UINTN Col = EDIT_HEX_COLUMN + (Ed->Cursor % EDIT_BYTES_PER_ROW) * 3 + (Ed->LowNibble ? 1 : 0);
+
+  gST->ConOut->SetCursorPosition(gST->ConOut, Col, EDIT_HEADER_ROWS + (Row - Ed->Top));
+}
+
+// Move the cursor; redraw everything only when the page scrolls.
+STATIC VOID
+MoveCursor(IN OUT EDIT_STATE *Ed, IN UINTN NewCursor)
+{
+  UINTN Row;
+
+  Ed->Cursor = MIN(NewCursor, Ed->Size - 1);
+  Ed->LowNibble = FALSE;
+
+  Row = Ed->Cursor / EDIT_BYTES_PER_ROW;
+  if (Row < Ed->Top || Row >= Ed->Top + Ed->PageRows) {
+    Ed->Top = (Row < Ed->Top) ? Row : Row - (Ed->PageRows - 1);
+    DrawPage(Ed);
+  } else {
+    DrawStatus(Ed);
+  }
+}
+
+// Add one zero byte at the end and put the cursor on it.
+STATIC VOID
+AppendByte(IN OUT EDIT_STATE *Ed)
+{
+  if (Ed->Size == Ed->Capacity) {
+    UINT8 *NewWork = ReallocatePool(Ed->Capacity, Ed->Capacity * 2, Ed->Work);
+    if (NewWork == NULL) return;
+    Ed->Work = NewWork;
+    Ed->Capacity *= 2;
+  }
+  Ed->Work[Ed->Size++] = 0;
+  MoveCursor(Ed, Ed->Size - 1);
+  DrawRow(Ed, Ed->Cursor / EDIT_BYTES_PER_ROW);
+}
+
+// Del: restore an original byte, or drop the last appended one.
+STATIC VOID
+RevertByte(IN OUT EDIT_STATE *Ed)
+{
+  if (Ed->Cursor < Ed->Orig->DataSize) {
+    Ed->Work[Ed->Cursor] = Ed->Orig->Data[Ed->Cursor];
+    Ed->LowNibble = FALSE;
+    DrawRow(Ed, Ed->Cursor / EDIT_BYTES_PER_ROW);
+    DrawStatus(Ed);
+    return;
+  }
+  if (Ed->Cursor == Ed->Size - 1) {
+    Ed->Size--;
+    DrawRow(Ed, Ed->Cursor / EDIT_BYTES_PER_ROW);
+    MoveCursor(Ed, Ed->Cursor - 1);
+  }
+}
+
+STATIC EFI_STATUS
+SaveEdits(IN EDIT_STATE *Ed)
+{
+  UINTN OrigSize = Ed->Orig->DataSize;
+  BOOLEAN PrefixSame = (CompareMem(Ed->Work, Ed->Orig->Data, OrigSize) == 0);
+
+  if (PrefixSame && Ed->Size == OrigSize) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  if (PrefixSame) {
+    // only the tail is new: the write is proportional to what was added
+    return VarSetVariable(Ed->Name, Ed->Guid, Ed->Orig->Attributes | EFI_VARIABLE_APPEND_WRITE,
+                          Ed->Size - OrigSize, Ed->Work + OrigSize);
+  }
+
+  return VarSetVariable(Ed->Name, Ed->Guid, Ed->Orig->Attributes, Ed->Size, Ed->Work);
+}
+
+EFI_STATUS
+VarEditVariable(IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+  EDIT_STATE Ed;
+  EFI_INPUT_KEY Key;
+  UINTN Cols = 0, Rows = 0;
+
+  ZeroMem(&Ed, sizeof(Ed));
+  Ed.Name = Name;
+  Ed.Guid = Guid;
+
+  Status = VarCacheGet(Name, Guid, &Ed.Orig);
+  if (EFI_ERROR(Status)) return Status;
+
+  if ((Ed.Orig->Attributes & (EFI_VARIABLE_AUTHENTICATED_WRITE_ACCESS |
+                              EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS)) != 0) {
+    // would need a freshly signed payload
+    VarCacheRelease(Ed.Orig);
+    return EFI_WRITE_PROTECTED;
+  }
+
+  if (Ed.Orig->DataSize == 0) {
+    VarCacheRelease(Ed.Orig);
+    return EFI_NOT_FOUND;
+  }
+
+  Ed.Size = Ed.Orig->DataSize;
+  Ed.Capacity = Ed.Size;
+  Ed.Work = AllocateCopyPool(Ed.Capacity, Ed.Orig->Data);
+  if (Ed.Work == NULL) {
+    VarCacheRelease(Ed.Orig);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Ed.PageRows = 16;
+  if (!EFI_ERROR(gST->ConOut->QueryMode(gST->ConOut, gST->ConOut->Mode->Mode, &Cols, &Rows)) &&
+      Rows > EDIT_HEADER_ROWS + EDIT_FOOTER_ROWS + 2) {
+    Ed.PageRows = Rows - EDIT_HEADER_ROWS - EDIT_FOOTER_ROWS - 1;
+  }
+
+  DrawPage(&Ed);
+  Status = EFI_ABORTED;
+
+  while (TRUE) {
+    INTN Nibble = -1;
+
+    PlaceCursor(&Ed);
+    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+      gBS->Stall(1000);
+    }
+
+    if (Key.ScanCode == SCAN_ESC) {
+      if (CountChanged(&Ed) == 0) break;
+      gST->ConOut->SetCursorPosition(gST->ConOut, 0, EDIT_HEADER_ROWS + Ed.PageRows + 1);
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"Discard %u changed byte(s)? [y/N]                                    ", (UINT32)CountChanged(&Ed));
+      SetTextAttr(EFI_LIGHTGRAY);
+      while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+        gBS->Stall(1000);
+      }
+      if (Key.UnicodeChar == L'y' || Key.UnicodeChar == L'Y') break;
+      DrawStatus(&Ed);
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_F2) {
+      Status = SaveEdits(&Ed);
+      break;
+    }
+
+    switch (Key.ScanCode) {
+      case SCAN_LEFT:      if (Ed.Cursor > 0) MoveCursor(&Ed, Ed.Cursor - 1); continue;
+      case SCAN_RIGHT:     MoveCursor(&Ed, Ed.Cursor + 1); continue;
+      case SCAN_UP:        if (Ed.Cursor >= EDIT_BYTES_PER_ROW) MoveCursor(&Ed, Ed.Cursor - EDIT_BYTES_PER_ROW); continue;
+      case SCAN_DOWN:      if (Ed.Cursor + EDIT_BYTES_PER_ROW < Ed.Size) MoveCursor(&Ed, Ed.Cursor + EDIT_BYTES_PER_ROW); continue;
+      case SCAN_PAGE_UP:   MoveCursor(&Ed, (Ed.Cursor > Ed.PageRows * EDIT_BYTES_PER_ROW) ? Ed.Cursor - Ed.PageRows * EDIT_BYTES_PER_ROW : 0); continue;
+      case SCAN_PAGE_DOWN: MoveCursor(&Ed, Ed.Cursor + Ed.PageRows * EDIT_BYTES_PER_ROW); continue;
+      case SCAN_HOME:      MoveCursor(&Ed, 0); continue;
+      case SCAN_END:       MoveCursor(&Ed, Ed.Size - 1); continue;
+      case SCAN_INSERT:    AppendByte(&Ed); continue;
+      case SCAN_DELETE:    RevertByte(&Ed); continue;
+      default:
+        break;
+    }
+
+    if (Key.UnicodeChar >= L'0' && Key.UnicodeChar <= L'9') Nibble = Key.UnicodeChar - L'0';
+    if (Key.UnicodeChar >= L'a' && Key.UnicodeChar <= L'f') Nibble = Key.UnicodeChar - L'a' + 10;
+    if (Key.UnicodeChar >= L'A' && Key.UnicodeChar <= L'F') Nibble = Key.UnicodeChar - L'A' + 10;
+    if (Nibble < 0) continue;
+
+    if (Ed.LowNibble) {
+      Ed.Work[Ed.Cursor] = (UINT8)((Ed.Work[Ed.Cursor] & 0xF0) | Nibble);
+    } else {
+      Ed.Work[Ed.Cursor] = (UINT8)((Ed.Work[Ed.Cursor] & 0x0F) | (Nibble << 4));
+    }
+    DrawRow(&Ed, Ed.Cursor / EDIT_BYTES_PER_ROW);
+
+    if (Ed.LowNibble) {
+      if (Ed.Cursor + 1 < Ed.Size) {
+        MoveCursor(&Ed, Ed.Cursor + 1);
+      } else {
+        DrawStatus(&Ed);
+      }
+    } else {
+      Ed.LowNibble = TRUE;
+      DrawStatus(&Ed);
+    }
+  }
+
+  gST->ConOut->SetCursorPosition(gST->ConOut, 0, EDIT_HEADER_ROWS + Ed.PageRows + EDIT_FOOTER_ROWS);
+  SetTextAttr(EFI_LIGHTGRAY);
+  Print(L"\n");
+
+  FreePool(Ed.Work);
+  VarCacheRelease(Ed.Orig);
+  return Status;
+}
@@ -0,0 +1,338 @@
+#include "VariableTool.h"
+
+// =============================
+// Machine-readable catalog export (JSON / CSV)
+// Rows are produced straight into the writer; payloads are only read (via
+// the bulk reader) when a hash or the data is requested.
+// =============================
+STATIC CONST CHAR8 mHexDigits[] = "0123456789abcdef";
+STATIC CONST CHAR8 mBase64Digits[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Append one UTF-16 code point as UTF-8; returns bytes written (max 4).
+STATIC UINTN
+EncodeUtf8(IN UINT32 Cp, OUT CHAR8 *Out)
+{
+  if (Cp < 0x80) {
+    Out[0] = (CHAR8)Cp;
+    return 1;
+  }
+  if (Cp < 0x800) {
+    Out[0] = (CHAR8)(0xC0 | (Cp >> 6));
+    Out[1] = (CHAR8)(0x80 | (Cp & 0x3F));
+    return 2;
+  }
+  if (Cp < 0x10000) {
+    Out[0] = (CHAR8)(0xE0 | (Cp >> 12));
+    Out[1] = (CHAR8)(0x80 | ((Cp >> 6) & 0x3F));
+    Out[2] = (CHAR8)(0x80 | (Cp & 0x3F));
+    return 3;
+  }
+  Out[0] = (CHAR8)(0xF0 | (Cp >> 18));
+  Out[1] = (CHAR8)(0x80 | ((Cp >> 12) & 0x3F));
+  Out[2] = (CHAR8)(0x80 | ((Cp >> 6) & 0x3F));
+  Out[3] = (CHAR8)(0x80 | (Cp & 0x3F));
+  return 4;
+}
+
+// Next code point of a UTF-16 string, combining surrogate pairs.
+STATIC UINT32
+NextCodePoint(IN OUT CONST CHAR16 **Str)
+{
+  UINT32 Cp = **Str;
+
+  (*Str)++;
+  if (Cp >= 0xD800 && Cp <= 0xDBFF && **Str >= 0xDC00 && **Str <= 0xDFFF) {
+    Cp = 0x10000 + ((Cp - 0xD800) << 10) + (**Str - 0xDC00);
+    (*Str)++;
+  }
+  return Cp;
+}
+
+STATIC VOID
+PutJsonString(IN OUT VAR_WRITER *Writer, IN CONST CHAR16 *Str)
+{
+  CHAR8 Out[8];
+
+  VarWriterPut(Writer, "\"", 1);
+  while (*Str != L'\0') {
+    UINT32 Cp = NextCodePoint(&Str);
+    if (Cp == '"' || Cp == '\\') {
+      Out[0] = '\\';
+      Out[1] = (CHAR8)Cp;
+      VarWriterPut(Writer, Out, 2);
+    } else if (Cp < 0x20) {
+      Out[0] = '\\'; Out[1] = 'u'; Out[2] = '0'; Out[3] = '0';
+      Out[4] = mHexDigits[Cp >> 4];
+      Out[5] = mHexDigits[Cp & 0xF];
+      VarWriterPut(Writer, Out, 6);
+    } else {
+      VarWriterPut(Writer, Out, EncodeUtf8(Cp, Out));
+    }
+  }
+  VarWriterPut(Writer, "\"", 1);
+}
+
+// RFC 4180: quote only when needed, double embedded quotes.
+STATIC VOID
+PutCsvString(IN OUT VAR_WRITER *Writer, IN CONST CHAR16 *Str)
+{
+  CHAR8 Out[4];
+  BOOLEAN Quote = FALSE;
+
+  for (CONST CHAR16 *p = Str; *p != L'\0'; p++) {
+    if (*p == L',' || *p == L'"' || *p == L'\r' || *p == L'\n') {
+      Quote = TRUE;
+      break;
+    }
+  }
+
+  if (Quote) VarWriterPut(Writer, "\"", 1);
+  while (*Str != L'\0') {
+    UINT32 Cp = NextCodePoint(&Str);
+    if (Cp == '"') VarWriterPut(Writer, "\"", 1);
+    VarWriterPut(Writer, Out, EncodeUtf8(Cp, Out));
+  }
+  if (Quote) VarWriterPut(Writer, "\"", 1);
+}
+
+STATIC VOID
+PutHex(IN OUT VAR_WRITER *Writer, IN CONST UINT8 *Data, IN UINTN Size)
+{
+  CHAR8 Out[256];
+
+  while (Size > 0) {
+    UINTN Chunk = MIN(Size, sizeof(Out) / 2);
+    VarWriterPut(Writer, Out, VarFormatHex(Data, Chunk, Out));
+    Data += Chunk;
+    Size -= Chunk;
+  }
+}
+
+STATIC VOID
+PutGuid(IN OUT VAR_WRITER *Writer, IN CONST EFI_GUID *Guid)
+{
+  CHAR8 Out[VAR_GUID_STRING_LENGTH];
+
+  VarWriterPut(Writer, Out, VarFormatGuid(Guid, Out));
+}
+
+STATIC VOID
+PutBase64(IN OUT VAR_WRITER *Writer, IN CONST UINT8 *Data, IN UINTN Size)
+{
+  CHAR8 Out[256];
+  UINTN n = 0;
+  UINTN i;
+
+  for (i = 0; i + 3 <= Size; i += 3) {
+    UINT32 v = ((UINT32)Data[i] << 16) | ((UINT32)Data[i + 1] << 8) | Data[i + 2];
+    Out[n++] = mBase64Digits[(v >> 18) & 0x3F];
+    Out[n++] = mBase64Digits[(v >> 12) & 0x3F];
+    Out[n++] = mBase64Digits[(v >> 6) & 0x3F];
+    Out[n++] = mBase64Digits[v & 0x3F];
+    if (n == sizeof(Out)) {
+      VarWriterPut(Writer, Out, n);
+      n = 0;
+    }
+  }
+
+  if (i < Size) {
+    UINT32 v = (UINT32)Data[i] << 16;
+    if (i + 1 < Size) v |= (UINT32)Data[i + 1] << 8;
+    Out[n++] = mBase64Digits[(v >> 18) & 0x3F];
+    Out[n++] = mBase64Digits[(v >> 12) & 0x3F];
+    Out[n++] = (i + 1 < Size) ? mBase64Digits[(v >> 6) & 0x3F] : '=';
+    Out[n++] = '=';
+  }
+  VarWriterPut(Writer, Out, n);
+}
+
+STATIC VOID
+PutData(IN OUT VAR_WRITER *Writer, IN UINT32 Flags, IN CONST UINT8 *Data, IN UINTN Size)
+{
+  if (Flags & VAR_EXPORT_BASE64) {
+    PutBase64(Writer, Data, Size);
+  } else {
+    PutHex(Writer, Data, Size);
+  }
+}
+
+// Payload of one row; read on the BSP, hashed on any processor.
+typedef struct {
+  EFI_STATUS  Status;
+  UINT32      Attributes;
+  UINTN       DataSize;
+  UINT8       *Data;          // in the batch arena
+  UINT8       Digest[VAR_SHA256_DIGEST_SIZE];
+} EXPORT_PAYLOAD;
+
+STATIC VOID
+ExportRow(IN OUT VAR_WRITER *Writer, IN VAR_CATALOG *Catalog, IN UINTN Index, IN VAR_EXPORT_FORMAT Format, IN UINT32 Flags,
+          IN EXPORT_PAYLOAD *Payload OPTIONAL)
+{
+  EFI_STATUS Status = (Payload != NULL) ? Payload->Status : EFI_SUCCESS;
+  UINT8 *Data = (Payload != NULL) ? Payload->Data : NULL;
+  UINTN DataSize = Catalog->DataSize[Index];
+  UINT32 Attr = Catalog->Attributes[Index];
+  BOOLEAN First = (Index == 0);
+  BOOLEAN NeedData = (Payload != NULL);
+
+  if (NeedData && !EFI_ERROR(Status)) {
+    DataSize = Payload->DataSize;
+    Attr = Payload->Attributes;
+  }
+
+  if (Format == VarExportJson) {
+    VarWriterPut(Writer, First ? "\n    {\"name\": " : ",\n    {\"name\": ", First ? 14 : 15);
+    PutJsonString(Writer, VarCatalogName(Catalog, Index));
+    VarWriterPut(Writer, ", \"guid\": \"", 11);
+    PutGuid(Writer, VAR_CATALOG_GUID(Catalog, Index));
+    VarWriterPrint(Writer, "\", \"attributes\": %u, \"size\": %u", Attr, (UINT32)DataSize);
+    if (NeedData && EFI_ERROR(Status)) {
+      VarWriterPrint(Writer, ", \"error\": \"%r\"", Status);
+    } else {
+      if (Flags & VAR_EXPORT_HASH) {
+        VarWriterPut(Writer, ", \"sha256\": \"", 13);
+        PutHex(Writer, Payload->Digest, VAR_SHA256_DIGEST_SIZE);
+        VarWriterPut(Writer, "\"", 1);
+      }
+      if (Flags & (VAR_EXPORT_HEX | VAR_EXPORT_BASE64)) {
+        VarWriterPut(Writer, ", \"data\": \"", 11);
+        PutData(Writer, Flags, Data, DataSize);
+        VarWriterPut(Writer, "\"", 1);
+      }
+    }
+    VarWriterPut(Writer, "}", 1);
+    return;
+  }
+
+  // CSV: failed reads leave the hash/data columns empty
+  PutCsvString(Writer, VarCatalogName(Catalog, Index));
+  VarWriterPut(Writer, ",", 1);
+  PutGuid(Writer, VAR_CATALOG_GUID(Catalog, Index));
+  VarWriterPrint(Writer, ",0x%08x,%u", Attr, (UINT32)DataSize);
+  if (Flags & VAR_EXPORT_HASH) {
+    VarWriterPut(Writer, ",", 1);
+    if (!EFI_ERROR(Status)) PutHex(Writer, Payload->Digest, VAR_SHA256_DIGEST_SIZE);
+  }
+  if (Flags & (VAR_EXPORT_HEX | VAR_EXPORT_BASE64)) {
+    VarWriterPut(Writer, ",", 1);
+    if (!EFI_ERROR(Status)) PutData(Writer, Flags, Data, DataSize);
+  }
+  VarWriterPut(Writer, "\n", 1);
+}
+
+// =============================
+// Batched payload rows
+// Rows that need data are read in batches into one arena; SHA-256 for the
+// whole batch then runs on all processors (VarMpRun) before the rows are
+// written in order.
+// =============================
+#define EXPORT_BATCH_BYTES  SIZE_2MB
+#define EXPORT_BATCH_ROWS   256
+
+typedef struct {
+  EXPORT_PAYLOAD  Rows[EXPORT_BATCH_ROWS];
+  UINT8           *Arena;
+  UINTN           ArenaSize;
+} EXPORT_BATCH;
+
+STATIC VOID
+HashJob(IN VOID *Context, IN UINTN Job, IN UINTN Worker)
+{
+  EXPORT_PAYLOAD *Row = &((EXPORT_BATCH *)Context)->Rows[Job];
+
+  if (!EFI_ERROR(Row->Status)) VarSha256(Row->Data, Row->DataSize, Row->Digest);
+}
+
+// Reads rows [First, *End) that fit the arena; at least one row.
+STATIC EFI_STATUS
+ReadBatch(IN OUT EXPORT_BATCH *Batch, IN VAR_CATALOG *Catalog, IN UINTN First, OUT UINTN *End)
+{
+  UINTN Used = 0;
+  UINTN i;
+
+  for (i = First; i < Catalog->Count && i - First < EXPORT_BATCH_ROWS; i++) {
+    EXPORT_PAYLOAD *Row = &Batch->Rows[i - First];
+    UINT8 *Data;
+
+    Row->DataSize = 0;
+    Row->Status = VarReadBulk(VarCatalogName(Catalog, i), VAR_CATALOG_GUID(Catalog, i), &Row->Attributes, &Data, &Row->DataSize);
+    if (EFI_ERROR(Row->Status)) continue;
+
+    if (Used + Row->DataSize > Batch->ArenaSize) {
+      if (i > First) break;     // re-read first in the next batch
+      // a single payload larger than the arena
+      FreePool(Batch->Arena);
+      Batch->Arena = AllocatePool(Row->DataSize);
+      if (Batch->Arena == NULL) return EFI_OUT_OF_RESOURCES;
+      Batch->ArenaSize = Row->DataSize;
+    }
+    Row->Data = Batch->Arena + Used;
+    CopyMem(Row->Data, Data, Row->DataSize);
+    Used += Row->DataSize;
+  }
+
+  *End = i;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarExportCatalog(IN OUT VAR_WRITER *Writer, IN VAR_CATALOG *Catalog, IN VAR_EXPORT_FORMAT Format, IN UINT32 Flags)
+{
+  EXPORT_BATCH *Batch = NULL;
+  UINTN Count;
+  UINTN i = 0;
+
+  if (Writer == NULL || Catalog == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Flags & (VAR_EXPORT_HASH | VAR_EXPORT_HEX | VAR_EXPORT_BASE64)) {
+    Batch = AllocateZeroPool(sizeof(*Batch));
+    if (Batch != NULL) {
+      Batch->ArenaSize = EXPORT_BATCH_BYTES;
+      Batch->Arena = AllocatePool(Batch->ArenaSize);
+    }
+    if (Batch == NULL || Batch->Arena == NULL) {
+      if (Batch != NULL) FreePool(Batch);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Count = Catalog->Count;
+  if (Format == VarExportJson) {
+    VarWriterPrint(Writer, "{\n  \"count\": %u,\n  \"variables\": [", (UINT32)Count);
+  } else {
+    VarWriterPrint(Writer, "name,guid,attributes,size%a%a\n",
+                   (Flags & VAR_EXPORT_HASH) ? ",sha256" : "",
+                   (Flags & (VAR_EXPORT_HEX | VAR_EXPORT_BASE64)) ? ",data" : "");
+  }
+
+  while (i < Count && !EFI_ERROR(Writer->Status)) {
+    UINTN End = i + 1;
+
+    if (Batch != NULL) {
+      if (EFI_ERROR(ReadBatch(Batch, Catalog, i, &End))) {
+        Writer->Status = EFI_OUT_OF_RESOURCES;
+        break;
+      }
+      if (Flags & VAR_EXPORT_HASH) VarMpRun(HashJob, Batch, End - i);
+    }
+
+    for (UINTN k = i; k < End; k++) {
+      ExportRow(Writer, Catalog, k, Format, Flags, (Batch != NULL) ? &Batch->Rows[k - i] : NULL);
+    }
+    i = End;
+  }
+
+  if (Format == VarExportJson) {
+    VarWriterPut(Writer, "\n  ]\n}\n", 7);
+  }
+
+  if (Batch != NULL) {
+    if (Batch->Arena != NULL) FreePool(Batch->Arena);
+    FreePool(Batch);
+  }
+  return Writer->Status;
+}
@@ -0,0 +1,115 @@
+#include "VariableTool.h"
+
+#include <Protocol/LoadedImage.h>
+#include <Protocol/SimpleFileSystem.h>
+
+#include <Guid/FileInfo.h>
+
+// =============================
+// Files on the volume VariableTool.efi was started from (normally the ESP)
+// =============================
+STATIC EFI_STATUS
+OpenRootOfImageVolume(OUT EFI_FILE_PROTOCOL **Root)
+{
+  EFI_STATUS Status;
+  EFI_LOADED_IMAGE_PROTOCOL *LoadedImage = NULL;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *Fs = NULL;
+
+  Status = gBS->HandleProtocol(gImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = gBS->HandleProtocol(LoadedImage->DeviceHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&Fs);
+  if (EFI_ERROR(Status)) return Status;
+
+  return Fs->OpenVolume(Fs, Root);
+}
+
+EFI_STATUS
+VarFileOpen(IN CHAR16 *Path, IN BOOLEAN Create, OUT EFI_FILE_PROTOCOL **File)
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *Root = NULL;
+  EFI_FILE_PROTOCOL *Old = NULL;
+
+  if (Path == NULL || File == NULL) return EFI_INVALID_PARAMETER;
+  *File = NULL;
+
+  Status = OpenRootOfImageVolume(&Root);
+  if (EFI_ERROR(Status)) return Status;
+
+  if (!Create) {
+    Status = Root->Open(Root, File, Path, EFI_FILE_MODE_READ, 0);
+    Root->Close(Root);
+    return Status;
+  }
+
+  // FAT has no truncate-on-open; drop an existing file first. One that
+  // cannot be deleted (read-only, locked) would keep its old tail behind
+  // a shorter write, so that is an error, not the warning Delete returns.
+  if (!EFI_ERROR(Root->Open(Root, &Old, Path, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0))) {
+    Status = Old->Delete(Old);
+    if (Status != EFI_SUCCESS) {
+      Root->Close(Root);
+      return EFI_ERROR(Status) ? Status : EFI_ACCESS_DENIED;
+    }
+  }
+
+  Status = Root->Open(Root, File, Path, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE, 0);
+  Root->Close(Root);
+  return Status;
+}
+
+// Read a whole file into one pool buffer (size taken from EFI_FILE_INFO).
+EFI_STATUS
+VarFileReadAll(IN CHAR16 *Path, OUT VOID **Buffer, OUT UINTN *Size)
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File = NULL;
+  EFI_FILE_INFO *Info = NULL;
+  UINTN InfoSize = 0;
+  UINT8 *Data = NULL;
+  UINTN FileSize;
+  UINTN Done = 0;
+
+  if (Buffer == NULL || Size == NULL) return EFI_INVALID_PARAMETER;
+  *Buffer = NULL;
+  *Size = 0;
+
+  Status = VarFileOpen(Path, FALSE, &File);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = File->GetInfo(File, &gEfiFileInfoGuid, &InfoSize, NULL);
+  if (Status == EFI_BUFFER_TOO_SMALL) {
+    Info = AllocatePool(InfoSize);
+    Status = (Info == NULL) ? EFI_OUT_OF_RESOURCES : File->GetInfo(File, &gEfiFileInfoGuid, &InfoSize, Info);
+  }
+  if (EFI_ERROR(Status)) goto Done;
+
+  if ((Info->Attribute & EFI_FILE_DIRECTORY) != 0 || Info->FileSize > MAX_UINTN) {
+    Status = EFI_UNSUPPORTED;
+    goto Done;
+  }
+  FileSize = (UINTN)Info->FileSize;
+
+  Data = AllocatePool(MAX(FileSize, 1));
+  if (Data == NULL) { Status = EFI_OUT_OF_RESOURCES; goto Done; }
+
+  // a single Read normally returns everything; loop for short reads
+  while (Done < FileSize) {
+    UINTN Chunk = FileSize - Done;
+    Status = File->Read(File, &Chunk, Data + Done);
+    if (EFI_ERROR(Status)) goto Done;
+    if (Chunk == 0) { Status = EFI_END_OF_FILE; goto Done; }
+    Done += Chunk;
+  }
+
+  *Buffer = Data;
+  *Size = FileSize;
+  Data = NULL;
+
+Done:
+  if (Data != NULL) FreePool(Data);
+  if (Info != NULL) FreePool(Info);
+  File->Close(File);
+  return Status;
+}
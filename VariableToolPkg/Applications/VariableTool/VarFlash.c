@@ -0,0 +1,291 @@
+#include "VariableTool.h"
+
+#include <Pi/PiFirmwareVolume.h>
+#include <Pi/PiHob.h>
+#include <Library/HobLib.h>
+#include <Protocol/FirmwareVolumeBlock.h>
+#include <Guid/SystemNvDataGuid.h>
+
+// =============================
+// NV store fast path
+// With SMM variable services every GetVariable/GetNextVariableName is an
+// SMI. The NV variable FV is normally also mapped read-only (FVB2 with
+// EFI_FVB2_MEMORY_MAPPED, or an FV HOB), so walks and reads are served by
+// the store backend (VarStore.c) over that mapping. Each walk starts from
+// a fresh index, and a lookup whose record changed state since then falls
+// through to runtime services, as does anything the flash does not hold.
+// The flash has no volatile variables, so a walk that has handed out the
+// index makes one runtime-services pass for the names the index lacks.
+// =============================
+STATIC VAR_STORE mFlashStore;
+STATIC VAR_BACKEND *mFlashIndex = NULL;     // store backend over mFlashStore
+STATIC CHAR16 *mRtName = NULL;              // cursor of the runtime-services pass
+STATIC UINTN mRtNameSize = 0;
+
+// Name buffer for the start-up comparison; longer first names just skip it.
+#define FLASH_PROBE_NAME_SIZE  512
+
+// An NV FV (checksummed header, gEfiSystemNvDataFvGuid) with a healthy
+// store right behind its header, where the variable driver expects it.
+STATIC BOOLEAN
+FvHoldsStore(IN EFI_PHYSICAL_ADDRESS Address, IN UINT64 Length, OUT VAR_STORE *Store)
+{
+  EFI_FIRMWARE_VOLUME_HEADER *Fv = (EFI_FIRMWARE_VOLUME_HEADER *)(UINTN)Address;
+  UINTN Offset;
+
+  if (Address == 0 || Length < sizeof(EFI_FIRMWARE_VOLUME_HEADER)) return FALSE;
+  if (Fv->Signature != EFI_FVH_SIGNATURE || !CompareGuid(&Fv->FileSystemGuid, &gEfiSystemNvDataFvGuid)) {
+    return FALSE;
+  }
+  if (Fv->FvLength > Length || Fv->FvLength > MAX_UINTN ||
+      Fv->HeaderLength < sizeof(EFI_FIRMWARE_VOLUME_HEADER) || Fv->HeaderLength >= Fv->FvLength) {
+    return FALSE;
+  }
+  if (CalculateSum16((UINT16 *)Fv, Fv->HeaderLength) != 0) return FALSE;
+
+  Offset = Fv->HeaderLength;
+  if (EFI_ERROR(VarStoreFind((UINT8 *)Fv, (UINTN)Fv->FvLength, &Offset, Store))) return FALSE;
+  return Store->Offset == Fv->HeaderLength && Store->State == VAR_STORE_HEALTHY;
+}
+
+STATIC BOOLEAN
+LocateThroughFvb(OUT VAR_STORE *Store)
+{
+  EFI_HANDLE *Handles = NULL;
+  UINTN Count = 0;
+  BOOLEAN Found = FALSE;
+
+  if (EFI_ERROR(gBS->LocateHandleBuffer(ByProtocol, &gEfiFirmwareVolumeBlock2ProtocolGuid, NULL, &Count, &Handles))) {
+    return FALSE;
+  }
+
+  for (UINTN i = 0; i < Count && !Found; i++) {
+    EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL *Fvb;
+    EFI_FVB_ATTRIBUTES_2 Attributes;
+    EFI_PHYSICAL_ADDRESS Address;
+
+    if (EFI_ERROR(gBS->HandleProtocol(Handles[i], &gEfiFirmwareVolumeBlock2ProtocolGuid, (VOID **)&Fvb)) ||
+        EFI_ERROR(Fvb->GetAttributes(Fvb, &Attributes)) ||
+        EFI_ERROR(Fvb->GetPhysicalAddress(Fvb, &Address))) {
+      continue;
+    }
+    // only a readable mapping can be parsed in place
+    if ((Attributes & (EFI_FVB2_MEMORY_MAPPED | EFI_FVB2_READ_STATUS)) != (EFI_FVB2_MEMORY_MAPPED | EFI_FVB2_READ_STATUS)) {
+      continue;
+    }
+    Found = FvHoldsStore(Address, MAX_UINT64, Store);
+  }
+
+  if (Handles != NULL) FreePool(Handles);
+  return Found;
+}
+
+// Platforms whose FVB lives in SMM only still report the FV in a HOB.
+STATIC BOOLEAN
+LocateThroughHob(OUT VAR_STORE *Store)
+{
+  EFI_PEI_HOB_POINTERS Hob;
+
+  for (Hob.Raw = GetFirstHob(EFI_HOB_TYPE_FV); Hob.Raw != NULL;
+       Hob.Raw = GetNextHob(EFI_HOB_TYPE_FV, GET_NEXT_HOB(Hob))) {
+    if (FvHoldsStore(Hob.FirmwareVolume->BaseAddress, Hob.FirmwareVolume->Length, Store)) return TRUE;
+  }
+  return FALSE;
+}
+
+// One variable read both ways. Catches a mapping that is not the store in
+// use (stale shadow copy, encrypted or cached store).
+STATIC BOOLEAN
+FlashMatchesRuntime(VOID)
+{
+  CHAR16 Name[FLASH_PROBE_NAME_SIZE / sizeof(CHAR16)];
+  UINTN NameSize = sizeof(Name);
+  EFI_GUID Guid;
+  UINT32 Attr;
+  UINT32 RtAttr;
+  UINT8 *Data;
+  UINTN DataSize;
+  UINT8 *RtData;
+  UINTN RtSize;
+  BOOLEAN Match;
+
+  Name[0] = L'\0';
+  ZeroMem(&Guid, sizeof(Guid));
+  if (EFI_ERROR(mFlashIndex->GetNextVariableName(&NameSize, Name, &Guid)) ||
+      EFI_ERROR(mFlashIndex->ReadInPlace(Name, &Guid, &Attr, &Data, &DataSize))) {
+    return FALSE;
+  }
+
+  RtSize = DataSize;
+  RtData = AllocatePool(MAX(RtSize, 1));
+  if (RtData == NULL) return FALSE;
+  Match = !EFI_ERROR(gRT->GetVariable(Name, &Guid, &RtAttr, &RtSize, RtData)) && RtAttr == Attr &&
+          RtSize == DataSize && CompareMem(RtData, Data, DataSize) == 0;
+  FreePool(RtData);
+  return Match;
+}
+
+// The store header must still be there before the store is walked again.
+STATIC EFI_STATUS
+FlashReindex(VOID)
+{
+  VAR_STORE Check;
+  UINTN Offset = 0;
+
+  if (EFI_ERROR(VarStoreFind(mFlashStore.Base, mFlashStore.Size, &Offset, &Check)) || Check.Base != mFlashStore.Base) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+  return VarStoreBackendOpen(&mFlashStore, &mFlashIndex);
+}
+
+STATIC EFI_STATUS
+EFIAPI
+FlashGetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, IN OUT UINTN *DataSize, OUT VOID *Data OPTIONAL)
+{
+  EFI_STATUS Status = mFlashIndex->GetVariable(Name, Guid, Attributes, DataSize, Data);
+
+  // volatile, or written since the walk that built the index
+  if (Status == EFI_NOT_FOUND) Status = gRT->GetVariable(Name, Guid, Attributes, DataSize, Data);
+  return Status;
+}
+
+// Listed by the index of this walk, even if its record changed since. A
+// zero NameSize probes the store walk without copying anything out.
+STATIC BOOLEAN
+FlashIndexed(IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  UINTN NoRoom = 0;
+
+  return mFlashIndex->GetNextVariableName(&NoRoom, Name, Guid) != EFI_INVALID_PARAMETER;
+}
+
+STATIC BOOLEAN
+FlashNameRoom(IN UINTN Size)
+{
+  CHAR16 *NewName;
+
+  if (Size <= mRtNameSize) return TRUE;
+  NewName = ReallocatePool(mRtNameSize, Size, mRtName);
+  if (NewName == NULL) return FALSE;
+  mRtName = NewName;
+  mRtNameSize = Size;
+  return TRUE;
+}
+
+// Next runtime-services name after After (L"" to start) that the index
+// does not hold: volatile variables, and NV ones written during the walk.
+STATIC EFI_STATUS
+FlashNextUnindexed(IN CONST CHAR16 *After, IN CONST EFI_GUID *AfterGuid, IN OUT UINTN *NameSize, OUT CHAR16 *Name, OUT EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+  EFI_GUID RtGuid;
+  UINTN ThisSize = StrSize(After);
+
+  if (!FlashNameRoom(MAX(ThisSize, FLASH_PROBE_NAME_SIZE))) return EFI_OUT_OF_RESOURCES;
+  CopyMem(mRtName, After, ThisSize);
+  CopyGuid(&RtGuid, AfterGuid);
+
+  while (TRUE) {
+    ThisSize = mRtNameSize;
+    Status = gRT->GetNextVariableName(&ThisSize, mRtName, &RtGuid);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      if (!FlashNameRoom(ThisSize)) return EFI_OUT_OF_RESOURCES;
+      continue;
+    }
+    if (EFI_ERROR(Status)) return Status;
+    if (!FlashIndexed(mRtName, &RtGuid)) break;
+  }
+
+  // the caller's name stays the cursor until it has room for this one
+  if (*NameSize < ThisSize) {
+    *NameSize = ThisSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  CopyMem(Name, mRtName, ThisSize);
+  CopyGuid(Guid, &RtGuid);
+  *NameSize = ThisSize;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+FlashGetNextVariableName(IN OUT UINTN *NameSize, IN OUT CHAR16 *Name, IN OUT EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+
+  if (NameSize == NULL || Name == NULL || Guid == NULL) return EFI_INVALID_PARAMETER;
+
+  if (Name[0] == L'\0' && EFI_ERROR(FlashReindex())) {
+    // store gone from the mapping (reclaimed into the spare): stay on runtime services
+    VarFlashDisable();
+    return gRT->GetNextVariableName(NameSize, Name, Guid);
+  }
+
+  // a name the index does not hold came from the runtime-services pass
+  if (Name[0] != L'\0' && !FlashIndexed(Name, Guid)) {
+    return FlashNextUnindexed(Name, Guid, NameSize, Name, Guid);
+  }
+  Status = mFlashIndex->GetNextVariableName(NameSize, Name, Guid);
+  if (Status == EFI_NOT_FOUND) Status = FlashNextUnindexed(L"", Guid, NameSize, Name, Guid);
+  return Status;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+FlashSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  return gRT->SetVariable(Name, Guid, Attributes, DataSize, Data);
+}
+
+STATIC EFI_STATUS
+EFIAPI
+FlashQueryVariableInfo(IN UINT32 Attributes, OUT UINT64 *MaxStorage, OUT UINT64 *Remaining, OUT UINT64 *MaxVariableSize)
+{
+  return gRT->QueryVariableInfo(Attributes, MaxStorage, Remaining, MaxVariableSize);
+}
+
+STATIC EFI_STATUS
+FlashReadInPlace(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  return mFlashIndex->ReadInPlace(Name, Guid, Attributes, Data, DataSize);
+}
+
+STATIC VAR_BACKEND mFlashBackend = {
+  L"NV flash mapping (volatile through runtime services)",
+  FlashGetVariable,
+  FlashGetNextVariableName,
+  FlashSetVariable,
+  FlashQueryVariableInfo,
+  FlashReadInPlace
+};
+
+EFI_STATUS
+VarFlashEnable(VOID)
+{
+  EFI_STATUS Status;
+
+  if (gVarBackend == &mFlashBackend) return EFI_SUCCESS;
+
+  if (!LocateThroughFvb(&mFlashStore) && !LocateThroughHob(&mFlashStore)) return EFI_NOT_FOUND;
+  Status = VarStoreBackendOpen(&mFlashStore, &mFlashIndex);
+  if (EFI_ERROR(Status)) return Status;
+
+  if (!FlashMatchesRuntime()) {
+    VarFlashDisable();
+    return EFI_INCOMPATIBLE_VERSION;
+  }
+
+  VarBackendSelect(&mFlashBackend);
+  return EFI_SUCCESS;
+}
+
+VOID
+VarFlashDisable(VOID)
+{
+  if (gVarBackend == &mFlashBackend) VarBackendSelect(NULL);
+  VarStoreBackendClose();
+  mFlashIndex = NULL;
+  if (mRtName != NULL) FreePool(mRtName);
+  mRtName = NULL;
+  mRtNameSize = 0;
+}
@@ -0,0 +1,144 @@
+#include "VariableTool.h"
+
+// =============================
+// Formatting kernel
+// Hex and GUID text without PrintLib: no format string is parsed per
+// byte. Bytes are looked up as ready-made character pairs, and runs of
+// plain hex are converted four bytes at a time inside one 64-bit
+// register (nibble spread + branch-free '0'/'a' offset), which needs no
+// vector intrinsics and builds the same with every EDK2 toolchain.
+// Output is lowercase, matching %x/%g of PrintLib.
+// =============================
+STATIC CONST CHAR8 mHexDigits[] = "0123456789abcdef";
+
+// "xx" per byte, stored as one UINT16 (little-endian: high nibble first)
+STATIC UINT16 mHexPair[256];
+STATIC BOOLEAN mHexPairReady = FALSE;
+
+STATIC VOID
+BuildHexPairs(VOID)
+{
+  for (UINTN i = 0; i < 256; i++) {
+    mHexPair[i] = (UINT16)(mHexDigits[i >> 4] | (mHexDigits[i & 0xF] << 8));
+  }
+  mHexPairReady = TRUE;
+}
+
+STATIC VOID
+PutPair(OUT CHAR8 *Out, IN UINT8 Byte)
+{
+  WriteUnaligned16((UINT16 *)Out, mHexPair[Byte]);
+}
+
+// Four bytes -> eight hex characters.
+STATIC UINT64
+HexSwar4(IN UINT32 Bytes)
+{
+  UINT64 x = Bytes;
+  UINT64 n;
+  UINT64 Letter;
+
+  // byte i -> 16-bit lane i, then high nibble low, low nibble high
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+  n = ((x >> 4) & 0x000F000F000F000FULL) | ((x & 0x000F000F000F000FULL) << 8);
+
+  // 1 in every lane holding 10..15
+  Letter = ((n + 0x0606060606060606ULL) >> 4) & 0x0101010101010101ULL;
+  return n + 0x3030303030303030ULL + Letter * ('a' - '0' - 10);
+}
+
+UINTN
+VarFormatHex(IN CONST UINT8 *Data, IN UINTN Size, OUT CHAR8 *Out)
+{
+  UINTN i = 0;
+
+  if (!mHexPairReady) BuildHexPairs();
+
+  for (; i + 4 <= Size; i += 4) {
+    WriteUnaligned64((UINT64 *)(Out + 2 * i), HexSwar4(ReadUnaligned32((CONST UINT32 *)(Data + i))));
+  }
+  for (; i < Size; i++) {
+    PutPair(Out + 2 * i, Data[i]);
+  }
+  return 2 * Size;
+}
+
+UINTN
+VarFormatHexColumns(IN CONST UINT8 *Data, IN UINTN Count, OUT CHAR8 *Out)
+{
+  UINTN n = 0;
+
+  if (!mHexPairReady) BuildHexPairs();
+
+  for (UINTN i = 0; i < 16; i++) {
+    if (i < Count) {
+      PutPair(Out + n, Data[i]);
+    } else {
+      Out[n] = ' ';
+      Out[n + 1] = ' ';
+    }
+    Out[n + 2] = ' ';
+    n += 3;
+  }
+  return n;
+}
+
+UINTN
+VarFormatDumpLine(IN UINTN Offset, IN CONST UINT8 *Data, IN UINTN Count, OUT CHAR8 *Line)
+{
+  UINTN n;
+
+  // offset as 8 digits: its bytes most significant first
+  WriteUnaligned64((UINT64 *)Line, HexSwar4(SwapBytes32((UINT32)Offset)));
+  Line[8] = ' ';
+  Line[9] = ' ';
+  n = 10 + VarFormatHexColumns(Data, Count, Line + 10);
+
+  Line[n++] = ' ';
+  Line[n++] = '|';
+  for (UINTN i = 0; i < Count; i++) {
+    Line[n++] = (Data[i] >= 0x20 && Data[i] <= 0x7E) ? (CHAR8)Data[i] : '.';
+  }
+  Line[n++] = '|';
+  Line[n++] = '\n';
+  return n;
+}
+
+UINTN
+VarFormatGuid(IN CONST EFI_GUID *Guid, OUT CHAR8 *Out)
+{
+  if (!mHexPairReady) BuildHexPairs();
+
+  WriteUnaligned64((UINT64 *)Out, HexSwar4(SwapBytes32(Guid->Data1)));
+  Out[8] = '-';
+  PutPair(Out + 9, (UINT8)(Guid->Data2 >> 8));
+  PutPair(Out + 11, (UINT8)Guid->Data2);
+  Out[13] = '-';
+  PutPair(Out + 14, (UINT8)(Guid->Data3 >> 8));
+  PutPair(Out + 16, (UINT8)Guid->Data3);
+  Out[18] = '-';
+  PutPair(Out + 19, Guid->Data4[0]);
+  PutPair(Out + 21, Guid->Data4[1]);
+  Out[23] = '-';
+  VarFormatHex(&Guid->Data4[2], 6, Out + 24);
+  return VAR_GUID_STRING_LENGTH;
+}
+
+VOID
+VarFormatGuid16(IN CONST EFI_GUID *Guid, OUT CHAR16 *Out)
+{
+  CHAR8 Text[VAR_GUID_STRING_LENGTH];
+
+  VarFormatGuid(Guid, Text);
+  VarFormatWiden(Text, VAR_GUID_STRING_LENGTH, Out);
+  Out[VAR_GUID_STRING_LENGTH] = L'\0';
+}
+
+VOID
+VarFormatWiden(IN CONST CHAR8 *In, IN UINTN Length, OUT CHAR16 *Out)
+{
+  for (UINTN i = 0; i < Length; i++) {
+    Out[i] = (UINT8)In[i];
+  }
+}
@@ -0,0 +1,171 @@
+#include "VariableTool.h"
+
+// =============================
+// Friendly names for vendor GUIDs
+// The built-in list lives in VarGuidTable.h, generated together with a
+// collision-free hash (VariableToolPkg/Scripts/GenGuidTable.py), so a
+// lookup is one multiply, one slot read and one GUID compare. Names read
+// from a text file at run time go into a small open-addressing table that
+// is consulted first, so a file can also rename built-in entries.
+// =============================
+typedef struct {
+  CONST CHAR8  *Name;
+  EFI_GUID     Guid;
+} KNOWN_GUID;
+
+#include "VarGuidTable.h"
+
+typedef struct {
+  EFI_GUID  Guid;
+  CHAR8     *Name;      // NULL = empty slot
+} EXTRA_GUID;
+
+STATIC EXTRA_GUID *mExtraGuids = NULL;
+STATIC UINTN mExtraMask = 0;        // slots - 1
+STATIC UINTN mExtraCount = 0;
+
+// XOR of the four dwords; must match Fold() in GenGuidTable.py.
+STATIC UINT32
+GuidFold(IN CONST EFI_GUID *Guid)
+{
+  CONST UINT32 *Words = (CONST UINT32 *)Guid;
+
+  return ReadUnaligned32(&Words[0]) ^ ReadUnaligned32(&Words[1]) ^
+         ReadUnaligned32(&Words[2]) ^ ReadUnaligned32(&Words[3]);
+}
+
+STATIC EXTRA_GUID *
+ExtraSlot(IN CONST EFI_GUID *Guid)
+{
+  UINTN Slot = (UINTN)(GuidFold(Guid) * 0x9E3779B1U) & mExtraMask;
+
+  while (mExtraGuids[Slot].Name != NULL && !CompareGuid(&mExtraGuids[Slot].Guid, Guid)) {
+    Slot = (Slot + 1) & mExtraMask;
+  }
+  return &mExtraGuids[Slot];
+}
+
+CONST CHAR8 *
+VarGuidName(IN CONST EFI_GUID *Guid)
+{
+  UINT8 Entry;
+
+  if (mExtraCount != 0) {
+    EXTRA_GUID *Extra = ExtraSlot(Guid);
+    if (Extra->Name != NULL) return Extra->Name;
+  }
+
+  Entry = mKnownGuidSlots[(GuidFold(Guid) * KNOWN_GUID_HASH_SEED) >> (32 - KNOWN_GUID_HASH_BITS)];
+  if (Entry != 0 && CompareGuid(&mKnownGuids[Entry - 1].Guid, Guid)) {
+    return mKnownGuids[Entry - 1].Name;
+  }
+  return NULL;
+}
+
+VOID
+VarGuidNamesReset(VOID)
+{
+  if (mExtraGuids != NULL) {
+    for (UINTN i = 0; i <= mExtraMask; i++) {
+      if (mExtraGuids[i].Name != NULL) FreePool(mExtraGuids[i].Name);
+    }
+    FreePool(mExtraGuids);
+  }
+  mExtraGuids = NULL;
+  mExtraMask = 0;
+  mExtraCount = 0;
+}
+
+STATIC EFI_STATUS
+AddExtra(IN CONST EFI_GUID *Guid, IN CONST CHAR8 *Name)
+{
+  EXTRA_GUID *Slot;
+  CHAR8 *Copy;
+
+  // keep the table at most half full
+  if (mExtraGuids == NULL || 2 * (mExtraCount + 1) > mExtraMask + 1) {
+    EXTRA_GUID *Old = mExtraGuids;
+    UINTN OldSlots = (Old != NULL) ? mExtraMask + 1 : 0;
+    UINTN Slots = MAX(2 * OldSlots, 64);
+
+    mExtraGuids = AllocateZeroPool(Slots * sizeof(EXTRA_GUID));
+    if (mExtraGuids == NULL) {
+      mExtraGuids = Old;
+      return EFI_OUT_OF_RESOURCES;
+    }
+    mExtraMask = Slots - 1;
+    for (UINTN i = 0; i < OldSlots; i++) {
+      if (Old[i].Name != NULL) CopyMem(ExtraSlot(&Old[i].Guid), &Old[i], sizeof(EXTRA_GUID));
+    }
+    if (Old != NULL) FreePool(Old);
+  }
+
+  Copy = AllocateCopyPool(AsciiStrSize(Name), Name);
+  if (Copy == NULL) return EFI_OUT_OF_RESOURCES;
+
+  Slot = ExtraSlot(Guid);
+  if (Slot->Name != NULL) {
+    FreePool(Slot->Name);       // later lines win
+  } else {
+    CopyGuid(&Slot->Guid, Guid);
+    mExtraCount++;
+  }
+  Slot->Name = Copy;
+  return EFI_SUCCESS;
+}
+
+// "<guid> <name>" per line, '#' comments; ASCII/UTF-8 text.
+EFI_STATUS
+VarGuidNamesLoad(IN CHAR16 *Path, OUT UINTN *Loaded OPTIONAL)
+{
+  EFI_STATUS Status;
+  CHAR8 *Text = NULL;
+  UINTN Size = 0;
+  UINTN Count = 0;
+  CHAR8 *Line;
+  CHAR8 *Next;
+
+  if (Loaded != NULL) *Loaded = 0;
+
+  Status = VarFileReadAll(Path, (VOID **)&Text, &Size);
+  if (EFI_ERROR(Status)) return Status;
+
+  // one spare byte for the terminator
+  Line = ReallocatePool(Size, Size + 1, Text);
+  if (Line == NULL) {
+    FreePool(Text);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Text = Line;
+  Text[Size] = '\0';
+
+  for (Line = Text; Line != NULL; Line = Next) {
+    CHAR8 *GuidText, *Name, *p;
+    EFI_GUID Guid;
+
+    for (Next = Line; *Next != '\0' && *Next != '\n'; Next++);
+    if (*Next == '\n') *Next++ = '\0';
+    else Next = NULL;
+
+    // cut comments and the line end, then split "<guid> <name>"
+    for (p = Line; *p != '\0' && *p != '#' && *p != '\r'; p++);
+    *p = '\0';
+    for (GuidText = Line; *GuidText == ' ' || *GuidText == '\t'; GuidText++);
+    if (*GuidText == '\0') continue;
+    for (Name = GuidText; *Name != '\0' && *Name != ' ' && *Name != '\t'; Name++);
+    if (*Name != '\0') *Name++ = '\0';
+    while (*Name == ' ' || *Name == '\t') Name++;
+    for (p = Name; *p != '\0' && *p != ' ' && *p != '\t'; p++);
+    *p = '\0';
+
+    if (*Name == '\0' || EFI_ERROR(AsciiStrToGuid(GuidText, &Guid))) continue;
+
+    Status = AddExtra(&Guid, Name);
+    if (EFI_ERROR(Status)) break;
+    Count++;
+  }
+
+  FreePool(Text);
+  if (Loaded != NULL) *Loaded = Count;
+  return Status;
+}
@@ -0,0 +1,40 @@
+// Generated by VariableToolPkg/Scripts/GenGuidTable.py from KnownGuids.txt.
+// Do not edit; change the list and rerun the script.
+#define KNOWN_GUID_HASH_BITS  6
+#define KNOWN_GUID_HASH_SEED  0x27F2B259U
+
+STATIC CONST KNOWN_GUID mKnownGuids[] = {
+  { "EFI_GLOBAL_VARIABLE",            { 0x8be4df61, 0x93ca, 0x11d2, { 0xaa, 0x0d, 0x00, 0xe0, 0x98, 0x03, 0x2b, 0x8c } } },
+  { "EFI_IMAGE_SECURITY_DATABASE",    { 0xd719b2cb, 0x3d3a, 0x4596, { 0xa3, 0xbc, 0xda, 0xd0, 0x0e, 0x67, 0x65, 0x6f } } },
+  { "EFI_HARDWARE_ERROR_VARIABLE",    { 0x414e6bdd, 0xe47b, 0x47cc, { 0xb2, 0x44, 0xbb, 0x61, 0x02, 0x0c, 0xf5, 0x16 } } },
+  { "EFI_CAPSULE_REPORT",             { 0x39b68c46, 0xf7fb, 0x441b, { 0xb6, 0xec, 0x16, 0xb0, 0xf6, 0x98, 0x21, 0xf3 } } },
+  { "EFI_CAPSULE_VENDOR",             { 0x711c703f, 0xc285, 0x4b10, { 0xa3, 0xb0, 0x36, 0xec, 0xbd, 0x3c, 0x8b, 0xe2 } } },
+  { "MEMORY_OVERWRITE_CONTROL_DATA",  { 0xe20939be, 0x32d4, 0x41be, { 0xa1, 0x50, 0x89, 0x7f, 0x85, 0xd4, 0x98, 0x29 } } },
+  { "MEMORY_OVERWRITE_CONTROL_LOCK",  { 0xbb983ccf, 0x151d, 0x40e1, { 0xa0, 0x7b, 0x4a, 0x17, 0xbe, 0x16, 0x82, 0x92 } } },
+  { "EFI_IP4_CONFIG2",                { 0x5b446ed1, 0xe30b, 0x4faa, { 0x87, 0x1a, 0x36, 0x54, 0xec, 0xa3, 0x60, 0x80 } } },
+  { "EFI_IP6_CONFIG",                 { 0x937fe521, 0x95ae, 0x4d1a, { 0x89, 0x29, 0x48, 0xbc, 0xd9, 0x0a, 0xd3, 0x1a } } },
+  { "EFI_TLS_CA_CERTIFICATE",         { 0xfd2340d0, 0x3dab, 0x4349, { 0xa6, 0xc7, 0x3b, 0x4f, 0x12, 0xb4, 0x8e, 0xae } } },
+  { "EFI_SECURE_BOOT_ENABLE_DISABLE", { 0xf0a30bc7, 0xaf08, 0x4556, { 0x99, 0xc4, 0x00, 0x10, 0x09, 0xc9, 0x3a, 0x44 } } },
+  { "EFI_CUSTOM_MODE_ENABLE",         { 0xc076ec0c, 0x7028, 0x4399, { 0xa0, 0x72, 0x71, 0xee, 0x5c, 0x44, 0x8b, 0x9f } } },
+  { "EFI_VENDOR_KEYS_NV",             { 0x9073e4e0, 0x60ec, 0x4b6e, { 0x99, 0x03, 0x4c, 0x22, 0x3c, 0x26, 0x0f, 0x3c } } },
+  { "EFI_CERT_DB",                    { 0xd9bee56e, 0x75dc, 0x49d9, { 0xb4, 0xd7, 0xb5, 0x34, 0x21, 0x0f, 0x63, 0x7a } } },
+  { "EFI_MEMORY_TYPE_INFORMATION",    { 0x4c19049f, 0x4137, 0x4dd3, { 0x9c, 0x10, 0x8b, 0x97, 0xa8, 0x3f, 0xfd, 0xfa } } },
+  { "MTC_VENDOR",                     { 0xeb704011, 0x1402, 0x11d3, { 0x8e, 0x77, 0x00, 0xa0, 0xc9, 0x69, 0x72, 0x3b } } },
+  { "EDKII_VAR_ERROR_FLAG",           { 0x04b37fe8, 0xf6ae, 0x480b, { 0xbd, 0xd5, 0x37, 0xd9, 0x8c, 0x5e, 0x89, 0xaa } } },
+  { "EFI_TCG2_PHYSICAL_PRESENCE",     { 0xaeb9c5c1, 0x94f1, 0x4d02, { 0xbf, 0xd9, 0x46, 0x02, 0xdb, 0x2d, 0x3c, 0x54 } } },
+  { "SHELL_VARIABLE",                 { 0x158def5a, 0xf656, 0x419c, { 0xb0, 0x27, 0x7a, 0x31, 0x92, 0xc0, 0x79, 0xd2 } } },
+  { "EFI_VARIABLE",                   { 0xddcf3616, 0x3275, 0x4164, { 0x98, 0xb6, 0xfe, 0x85, 0x70, 0x7f, 0xfe, 0x7d } } },
+  { "EFI_AUTHENTICATED_VARIABLE",     { 0xaaf32c78, 0x947b, 0x439a, { 0xa1, 0x80, 0x2e, 0x14, 0x4e, 0xc3, 0x77, 0x92 } } },
+  { "OVMF_PLATFORM_CONFIG",           { 0x7235c51c, 0x0c80, 0x4cab, { 0x87, 0xac, 0x3b, 0x08, 0x4a, 0x63, 0x04, 0xb1 } } },
+  { "MICROSOFT_VENDOR",               { 0x77fa9abd, 0x0359, 0x4d32, { 0xbd, 0x60, 0x28, 0xf4, 0xe7, 0x8f, 0x78, 0x4b } } },
+  { "SHIM_LOCK",                      { 0x605dab50, 0xe046, 0x4300, { 0xab, 0xb6, 0x3d, 0xd8, 0x10, 0xdd, 0x8b, 0x23 } } },
+  { "SYSTEMD_BOOT_LOADER",            { 0x4a67b082, 0x0a4c, 0x41cf, { 0xb6, 0xc7, 0x44, 0x0b, 0x29, 0xbb, 0x8c, 0x4f } } },
+};
+
+// hash slot -> 1 + index into mKnownGuids, 0 = empty
+STATIC CONST UINT8 mKnownGuidSlots[64] = {
+    0,   0,   0,   0,   2,   0,   0,   0,  19,  24,   9,   1,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,  15,   0,   0,   0,   7,  22,   0,   0,  11,   3,
+    0,   0,   4,  17,   6,  16,   0,   0,  12,  23,   0,   0,  25,   0,   0,   0,
+    5,   0,   0,   0,  21,  14,   8,   0,   0,   0,  18,  20,   0,  10,  13,   0,
+};
@@ -0,0 +1,126 @@
+#include "VariableTool.h"
+
+// =============================
+// SHA-256 (FIPS 180-4)
+// Self-contained so the tool does not need CryptoPkg/OpensslLib just to
+// fingerprint payloads.
+// =============================
+STATIC CONST UINT32 mSha256K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR32(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+STATIC VOID
+Sha256Block(IN OUT UINT32 *State, IN CONST UINT8 *Block)
+{
+  UINT32 W[64];
+  UINT32 a, b, c, d, e, f, g, h;
+
+  for (UINTN i = 0; i < 16; i++) {
+    W[i] = ((UINT32)Block[i * 4] << 24) | ((UINT32)Block[i * 4 + 1] << 16) |
+           ((UINT32)Block[i * 4 + 2] << 8) | (UINT32)Block[i * 4 + 3];
+  }
+  for (UINTN i = 16; i < 64; i++) {
+    UINT32 s0 = ROTR32(W[i - 15], 7) ^ ROTR32(W[i - 15], 18) ^ (W[i - 15] >> 3);
+    UINT32 s1 = ROTR32(W[i - 2], 17) ^ ROTR32(W[i - 2], 19) ^ (W[i - 2] >> 10);
+    W[i] = W[i - 16] + s0 + W[i - 7] + s1;
+  }
+
+  a = State[0]; b = State[1]; c = State[2]; d = State[3];
+  e = State[4]; f = State[5]; g = State[6]; h = State[7];
+
+  for (UINTN i = 0; i < 64; i++) {
+    UINT32 S1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+    UINT32 Ch = (e & f) ^ (~e & g);
+    UINT32 T1 = h + S1 + Ch + mSha256K[i] + W[i];
+    UINT32 S0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+    UINT32 Maj = (a & b) ^ (a & c) ^ (b & c);
+    UINT32 T2 = S0 + Maj;
+    h = g; g = f; f = e; e = d + T1;
+    d = c; c = b; b = a; a = T1 + T2;
+  }
+
+  State[0] += a; State[1] += b; State[2] += c; State[3] += d;
+  State[4] += e; State[5] += f; State[6] += g; State[7] += h;
+}
+
+VOID
+VarSha256Init(OUT VAR_SHA256_CTX *Ctx)
+{
+  STATIC CONST UINT32 Iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  CopyMem(Ctx->State, Iv, sizeof(Iv));
+  Ctx->Length = 0;
+  Ctx->Used = 0;
+}
+
+VOID
+VarSha256Update(IN OUT VAR_SHA256_CTX *Ctx, IN CONST VOID *Data, IN UINTN Size)
+{
+  CONST UINT8 *Src = Data;
+
+  Ctx->Length += Size;
+
+  if (Ctx->Used > 0) {
+    UINTN Fill = MIN(Size, 64 - Ctx->Used);
+    CopyMem(Ctx->Block + Ctx->Used, Src, Fill);
+    Ctx->Used += Fill;
+    Src += Fill;
+    Size -= Fill;
+    if (Ctx->Used < 64) return;
+    Sha256Block(Ctx->State, Ctx->Block);
+    Ctx->Used = 0;
+  }
+
+  for (; Size >= 64; Src += 64, Size -= 64) {
+    Sha256Block(Ctx->State, Src);
+  }
+
+  CopyMem(Ctx->Block, Src, Size);
+  Ctx->Used = Size;
+}
+
+VOID
+VarSha256Final(IN OUT VAR_SHA256_CTX *Ctx, OUT UINT8 *Digest)
+{
+  UINT64 Bits = Ctx->Length * 8;
+
+  Ctx->Block[Ctx->Used++] = 0x80;
+  if (Ctx->Used > 56) {
+    ZeroMem(Ctx->Block + Ctx->Used, 64 - Ctx->Used);
+    Sha256Block(Ctx->State, Ctx->Block);
+    Ctx->Used = 0;
+  }
+  ZeroMem(Ctx->Block + Ctx->Used, 56 - Ctx->Used);
+  for (UINTN i = 0; i < 8; i++) {
+    Ctx->Block[56 + i] = (UINT8)(Bits >> (56 - 8 * i));
+  }
+  Sha256Block(Ctx->State, Ctx->Block);
+
+  for (UINTN i = 0; i < 8; i++) {
+    Digest[i * 4]     = (UINT8)(Ctx->State[i] >> 24);
+    Digest[i * 4 + 1] = (UINT8)(Ctx->State[i] >> 16);
+    Digest[i * 4 + 2] = (UINT8)(Ctx->State[i] >> 8);
+    Digest[i * 4 + 3] = (UINT8)Ctx->State[i];
+  }
+}
+
+VOID
+VarSha256(IN CONST VOID *Data, IN UINTN Size, OUT UINT8 *Digest)
+{
+  VAR_SHA256_CTX Ctx;
+
+  VarSha256Init(&Ctx);
+  VarSha256Update(&Ctx, Data, Size);
+  VarSha256Final(&Ctx, Digest);
+}
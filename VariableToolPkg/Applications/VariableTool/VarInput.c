@@ -0,0 +1,170 @@
+#include "VariableTool.h"
+
+// =============================
+// Typed value entry for Create/Set
+// Every input mode produces one contiguous payload buffer so the caller
+// can write it with a single SetVariable call.
+// =============================
+STATIC BOOLEAN
+IsSeparator(IN CHAR16 C)
+{
+  return (C == L' ' || C == L',' || C == L':' || C == L'-' || C == L'\t');
+}
+
+STATIC INTN
+HexDigitValue(IN CHAR16 C)
+{
+  if (C >= L'0' && C <= L'9') return (INTN)(C - L'0');
+  if (C >= L'a' && C <= L'f') return (INTN)(C - L'a' + 10);
+  if (C >= L'A' && C <= L'F') return (INTN)(C - L'A' + 10);
+  return -1;
+}
+
+// "de ad be ef", "0xDE,0xAD", "DEADBEEF" => bytes
+STATIC EFI_STATUS
+ParseHexBytes(IN CONST CHAR16 *Text, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  UINT8 *Buf;
+  UINTN Count = 0;
+  INTN High = -1;
+
+  // at most one byte per two input characters
+  Buf = AllocatePool(StrLen(Text) / 2 + 1);
+  if (Buf == NULL) return EFI_OUT_OF_RESOURCES;
+
+  while (*Text != L'\0') {
+    INTN v;
+
+    if (IsSeparator(*Text)) {
+      // a separator may only split whole bytes
+      if (High >= 0) break;
+      Text++;
+      continue;
+    }
+    if (High < 0 && Text[0] == L'0' && (Text[1] == L'x' || Text[1] == L'X')) {
+      Text += 2;
+      continue;
+    }
+
+    v = HexDigitValue(*Text);
+    if (v < 0) break;
+
+    if (High < 0) {
+      High = v;
+    } else {
+      Buf[Count++] = (UINT8)((High << 4) | v);
+      High = -1;
+    }
+    Text++;
+  }
+
+  if (*Text != L'\0' || High >= 0 || Count == 0) {
+    FreePool(Buf);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Data = Buf;
+  *DataSize = Count;
+  return EFI_SUCCESS;
+}
+
+// Whitespace/comma separated integers (decimal or 0x hex), each stored
+// little-endian in Width bytes.
+STATIC EFI_STATUS
+ParseIntegers(IN CONST CHAR16 *Text, IN UINTN Width, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  UINT8 *Buf;
+  UINTN Count = 0;
+  UINT64 Max = (Width == 8) ? MAX_UINT64 : (LShiftU64(1, Width * 8) - 1);
+
+  Buf = AllocatePool((StrLen(Text) / 2 + 1) * Width);
+  if (Buf == NULL) return EFI_OUT_OF_RESOURCES;
+
+  while (*Text != L'\0') {
+    EFI_STATUS Status;
+    UINT64 Value;
+    CHAR16 *End;
+
+    if (*Text == L' ' || *Text == L',' || *Text == L'\t') {
+      Text++;
+      continue;
+    }
+
+    if (Text[0] == L'0' && (Text[1] == L'x' || Text[1] == L'X')) {
+      Status = StrHexToUint64S(Text, &End, &Value);
+    } else {
+      Status = StrDecimalToUint64S(Text, &End, &Value);
+    }
+
+    if (EFI_ERROR(Status) || End == Text || Value > Max ||
+        (*End != L'\0' && *End != L' ' && *End != L',' && *End != L'\t')) {
+      FreePool(Buf);
+      return EFI_INVALID_PARAMETER;
+    }
+
+    for (UINTN i = 0; i < Width; i++) {
+      Buf[Count * Width + i] = (UINT8)RShiftU64(Value, i * 8);
+    }
+    Count++;
+    Text = End;
+  }
+
+  if (Count == 0) {
+    FreePool(Buf);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Data = Buf;
+  *DataSize = Count * Width;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarParseTypedValue(IN VAR_INPUT_TYPE Type, IN CHAR16 *Text, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  UINTN Len;
+
+  if (Text == NULL || Data == NULL || DataSize == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  *Data = NULL;
+  *DataSize = 0;
+
+  Len = StrLen(Text);
+
+  switch (Type) {
+    case VarInputUtf16:
+      // UTF-16 including the null terminator
+      *Data = AllocateCopyPool((Len + 1) * sizeof(CHAR16), Text);
+      if (*Data == NULL) return EFI_OUT_OF_RESOURCES;
+      *DataSize = (Len + 1) * sizeof(CHAR16);
+      return EFI_SUCCESS;
+
+    case VarInputAscii:
+      // ASCII including the null terminator
+      *Data = AllocatePool(Len + 1);
+      if (*Data == NULL) return EFI_OUT_OF_RESOURCES;
+      for (UINTN i = 0; i <= Len; i++) {
+        if (Text[i] > 0x7F) {
+          FreePool(*Data);
+          *Data = NULL;
+          return EFI_INVALID_PARAMETER;
+        }
+        (*Data)[i] = (UINT8)Text[i];
+      }
+      *DataSize = Len + 1;
+      return EFI_SUCCESS;
+
+    case VarInputHex:    return ParseHexBytes(Text, Data, DataSize);
+    case VarInputUint8:  return ParseIntegers(Text, 1, Data, DataSize);
+    case VarInputUint16: return ParseIntegers(Text, 2, Data, DataSize);
+    case VarInputUint32: return ParseIntegers(Text, 4, Data, DataSize);
+    case VarInputUint64: return ParseIntegers(Text, 8, Data, DataSize);
+
+    case VarInputFile:
+      return VarFileReadAll(Text, (VOID **)Data, DataSize);
+
+    default:
+      return EFI_INVALID_PARAMETER;
+  }
+}
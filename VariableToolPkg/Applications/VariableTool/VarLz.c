@@ -0,0 +1,136 @@
+#include "VariableTool.h"
+
+// =============================
+// LZ codec (snapshot records)
+// LZ4-style sequences: token (literal length << 4 | match length - 4),
+// length extensions of 255-bytes, literals, 16-bit offset. The last
+// sequence carries literals only. Zero-padded structures and repeated
+// certificate headers collapse into long matches.
+// Pure computation: safe on application processors (VarMp.c).
+// =============================
+#define LZ_MAX_OFFSET  0xFFFF
+
+STATIC UINT32
+LzHash(IN CONST UINT8 *p)
+{
+  return (ReadUnaligned32((CONST UINT32 *)p) * 2654435761U) >> (32 - VAR_LZ_HASH_BITS);
+}
+
+STATIC UINT8 *
+LzPutLength(IN OUT UINT8 *o, IN UINTN Len)
+{
+  if (Len < 15) return o;
+  Len -= 15;
+  while (Len >= 255) {
+    *o++ = 255;
+    Len -= 255;
+  }
+  *o++ = (UINT8)Len;
+  return o;
+}
+
+// One sequence: Lit[0..LitLen), then a match unless MatchLen == 0.
+STATIC BOOLEAN
+LzEmit(IN OUT UINT8 **Out, IN UINT8 *OutEnd, IN CONST UINT8 *Lit, IN UINTN LitLen, IN UINTN Offset, IN UINTN MatchLen)
+{
+  UINT8 *o = *Out;
+  UINTN Ml = (MatchLen != 0) ? MatchLen - VAR_LZ_MIN_MATCH : 0;
+
+  if ((UINTN)(OutEnd - o) < 1 + LitLen / 255 + 1 + LitLen + 2 + Ml / 255 + 1) return FALSE;
+
+  *o++ = (UINT8)((MIN(LitLen, 15) << 4) | MIN(Ml, 15));
+  o = LzPutLength(o, LitLen);
+  CopyMem(o, Lit, LitLen);
+  o += LitLen;
+  if (MatchLen != 0) {
+    *o++ = (UINT8)Offset;
+    *o++ = (UINT8)(Offset >> 8);
+    o = LzPutLength(o, Ml);
+  }
+  *Out = o;
+  return TRUE;
+}
+
+UINTN
+VarLzCompress(IN CONST UINT8 *Src, IN UINTN Size, OUT UINT8 *Dst, IN UINTN DstSize, IN OUT UINT32 *Table)
+{
+  UINT8 *o = Dst;
+  UINT8 *End = Dst + DstSize;
+  UINTN i = 0;
+  UINTN Anchor = 0;
+
+  ZeroMem(Table, VAR_LZ_TABLE_SIZE);
+
+  while (i + VAR_LZ_MIN_MATCH <= Size) {
+    UINT32 h = LzHash(Src + i);
+    UINTN Cand = Table[h];
+
+    Table[h] = (UINT32)(i + 1);
+    if (Cand != 0 && i - (Cand - 1) <= LZ_MAX_OFFSET &&
+        ReadUnaligned32((CONST UINT32 *)(Src + Cand - 1)) == ReadUnaligned32((CONST UINT32 *)(Src + i))) {
+      UINTN c = Cand - 1;
+      UINTN Len = VAR_LZ_MIN_MATCH;
+
+      while (i + Len < Size && Src[c + Len] == Src[i + Len]) Len++;
+      if (!LzEmit(&o, End, Src + Anchor, i - Anchor, i - c, Len)) return 0;
+      i += Len;
+      Anchor = i;
+      continue;
+    }
+    i++;
+  }
+
+  if (!LzEmit(&o, End, Src + Anchor, Size - Anchor, 0, 0)) return 0;
+  return (UINTN)(o - Dst);
+}
+
+STATIC BOOLEAN
+LzGetLength(IN OUT CONST UINT8 **s, IN CONST UINT8 *End, IN OUT UINTN *Len)
+{
+  UINT8 b;
+
+  if (*Len != 15) return TRUE;
+  do {
+    if (*s >= End) return FALSE;
+    b = *(*s)++;
+    *Len += b;
+  } while (b == 255 && *Len <= VAR_LZ_MAX_LENGTH);
+  return TRUE;
+}
+
+EFI_STATUS
+VarLzDecompress(IN CONST UINT8 *Src, IN UINTN SrcSize, OUT UINT8 *Dst, IN UINTN DstSize)
+{
+  CONST UINT8 *s = Src;
+  CONST UINT8 *End = Src + SrcSize;
+  UINTN o = 0;
+
+  while (s < End) {
+    UINT8 Token = *s++;
+    UINTN Lit = Token >> 4;
+    UINTN Len = Token & 0xF;
+    UINTN Offset;
+
+    if (!LzGetLength(&s, End, &Lit) || Lit > (UINTN)(End - s) || Lit > DstSize - o) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    CopyMem(Dst + o, s, Lit);
+    s += Lit;
+    o += Lit;
+    if (s == End) break;
+
+    if (End - s < 2) return EFI_VOLUME_CORRUPTED;
+    Offset = s[0] | ((UINTN)s[1] << 8);
+    s += 2;
+    if (!LzGetLength(&s, End, &Len)) return EFI_VOLUME_CORRUPTED;
+    Len += VAR_LZ_MIN_MATCH;
+    if (Offset == 0 || Offset > o || Len > DstSize - o) return EFI_VOLUME_CORRUPTED;
+
+    // byte copy: overlapping matches replicate runs
+    for (UINTN k = 0; k < Len; k++, o++) {
+      Dst[o] = Dst[o - Offset];
+    }
+  }
+
+  return (o == DstSize) ? EFI_SUCCESS : EFI_VOLUME_CORRUPTED;
+}
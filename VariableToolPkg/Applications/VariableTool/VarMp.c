@@ -0,0 +1,112 @@
+#include "VariableTool.h"
+
+#include <Library/SynchronizationLib.h>
+
+#include <Protocol/MpService.h>
+
+// =============================
+// Multi-processor work queue
+// Payloads are always fetched on the BSP (runtime services are not MP
+// safe); only the CPU-bound stages that follow are spread out. The BSP
+// and every enabled AP (StartupAllAPs, non-blocking) pull job indices
+// from one shared counter, so a few large variables next to many small
+// ones balance by themselves. Without the protocol, or when it refuses
+// (no APs, APs busy), everything runs on the BSP.
+// =============================
+typedef struct {
+  VAR_MP_WORK      Work;
+  VOID             *Context;
+  UINT32           JobCount;
+  UINT32           Workers;
+  volatile UINT32  NextJob;
+  volatile UINT32  NextWorker;
+} MP_QUEUE;
+
+STATIC EFI_MP_SERVICES_PROTOCOL *mMp = NULL;
+STATIC UINTN mMpEnabled = 0;      // enabled processors, BSP included
+STATIC BOOLEAN mMpProbed = FALSE;
+STATIC UINTN mMpLimit = 0;
+
+STATIC VOID
+MpProbe(VOID)
+{
+  UINTN Total = 0;
+
+  if (mMpProbed) return;
+  mMpProbed = TRUE;
+  mMpEnabled = 1;
+
+  if (EFI_ERROR(gBS->LocateProtocol(&gEfiMpServiceProtocolGuid, NULL, (VOID **)&mMp))) {
+    mMp = NULL;
+    return;
+  }
+  if (EFI_ERROR(mMp->GetNumberOfProcessors(mMp, &Total, &mMpEnabled)) || mMpEnabled < 2) {
+    mMp = NULL;
+    mMpEnabled = 1;
+  }
+}
+
+UINTN
+VarMpWorkerCount(VOID)
+{
+  MpProbe();
+  return (mMpLimit != 0) ? MIN(mMpLimit, mMpEnabled) : mMpEnabled;
+}
+
+VOID
+VarMpSetLimit(IN UINTN Limit)
+{
+  mMpLimit = Limit;
+}
+
+STATIC VOID
+RunJobs(IN MP_QUEUE *Q, IN UINTN Worker)
+{
+  while (TRUE) {
+    UINT32 Job = InterlockedIncrement(&Q->NextJob) - 1;
+    if (Job >= Q->JobCount) break;
+    Q->Work(Q->Context, Job, Worker);
+  }
+}
+
+// AP entry: take a worker slot; APs beyond the limit return at once.
+STATIC VOID
+EFIAPI
+ApEntry(IN VOID *Buffer)
+{
+  MP_QUEUE *Q = Buffer;
+  UINT32 Worker = InterlockedIncrement(&Q->NextWorker) - 1;
+
+  if (Worker < Q->Workers) RunJobs(Q, Worker);
+}
+
+VOID
+VarMpRun(IN VAR_MP_WORK Work, IN VOID *Context, IN UINTN JobCount)
+{
+  MP_QUEUE Q;
+  EFI_EVENT Done = NULL;
+  UINTN Index;
+
+  ZeroMem(&Q, sizeof(Q));
+  Q.Work = Work;
+  Q.Context = Context;
+  Q.JobCount = (UINT32)JobCount;
+  Q.Workers = (UINT32)VarMpWorkerCount();
+  Q.NextWorker = 1;     // slot 0 is the BSP
+
+  if (Q.Workers < 2 || JobCount < 2 ||
+      EFI_ERROR(gBS->CreateEvent(0, TPL_CALLBACK, NULL, NULL, &Done))) {
+    RunJobs(&Q, 0);
+    return;
+  }
+
+  if (EFI_ERROR(mMp->StartupAllAPs(mMp, ApEntry, FALSE, Done, 0, &Q, NULL))) {
+    gBS->CloseEvent(Done);
+    RunJobs(&Q, 0);
+    return;
+  }
+
+  RunJobs(&Q, 0);
+  gBS->WaitForEvent(1, &Done, &Index);
+  gBS->CloseEvent(Done);
+}
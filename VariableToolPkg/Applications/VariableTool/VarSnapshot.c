@@ -0,0 +1,416 @@
+#include "VariableTool.h"
+
+// =============================
+// Binary snapshots
+// [header][record]...[end record]. Each record carries one variable and is
+// compressed on its own, so restore reads and decodes one record at a time
+// and never holds more than the largest variable. Records that would not
+// shrink are stored raw.
+// =============================
+#define SNAPSHOT_SIGNATURE  SIGNATURE_32('V', 'T', 'S', 'N')
+#define SNAPSHOT_VERSION    1
+
+// refuse records no variable store could hold (corrupt length fields)
+#define SNAPSHOT_MAX_DATA   SIZE_16MB
+
+typedef enum {
+  SnapCodecRaw,
+  SnapCodecLz
+} SNAPSHOT_CODEC;
+
+#pragma pack(1)
+typedef struct {
+  UINT32    Signature;
+  UINT16    Version;
+  UINT16    HeaderSize;
+  UINT32    Flags;
+  EFI_TIME  Time;
+} SNAPSHOT_HEADER;
+
+// NameSize == 0 ends the snapshot; DataSize then holds the record count.
+typedef struct {
+  UINT16    NameSize;       // bytes, including the terminator
+  UINT8     Codec;
+  UINT8     Reserved;
+  UINT32    Attributes;
+  UINT32    DataSize;       // decoded
+  UINT32    StoredSize;     // in the file
+  UINT32    Crc;            // CalculateCrc32 of the decoded data
+  EFI_GUID  Guid;
+  // CHAR16 Name[], UINT8 Stored[]
+} SNAPSHOT_RECORD;
+#pragma pack()
+
+// =============================
+// Save
+// =============================
+// Payloads are read on the BSP into a batch, CRC'd and compressed on all
+// processors (VarMpRun), then written in enumeration order.
+#define SNAPSHOT_BATCH_BYTES  SIZE_2MB
+#define SNAPSHOT_BATCH_JOBS   256
+
+typedef struct {
+  CHAR16    *Name;          // in Arena
+  EFI_GUID  Guid;
+  UINT32    Attributes;
+  UINTN     DataSize;
+  UINT8     *Data;          // in Arena
+  UINT8     *Packed;        // in PackArena, DataSize bytes
+  UINTN     Stored;         // 0 = keep raw
+  UINT32    Crc;
+} SAVE_JOB;
+
+typedef struct {
+  VAR_WRITER           *Writer;
+  UINT32               Flags;
+  UINT32               *Tables;       // VAR_LZ_TABLE_SIZE per worker
+  SAVE_JOB             Jobs[SNAPSHOT_BATCH_JOBS];
+  UINTN                JobCount;
+  UINT8                *Arena;
+  UINT8                *PackArena;
+  UINTN                ArenaSize;
+  UINTN                ArenaUsed;
+  VAR_SNAPSHOT_STATS   *Stats;
+} SAVE_CONTEXT;
+
+// Runs on any processor.
+STATIC VOID
+PackJob(IN VOID *Context, IN UINTN Job, IN UINTN Worker)
+{
+  SAVE_CONTEXT *Ctx = Context;
+  SAVE_JOB *J = &Ctx->Jobs[Job];
+
+  J->Crc = CalculateCrc32(J->Data, J->DataSize);
+  J->Stored = 0;
+  if ((Ctx->Flags & VAR_SNAPSHOT_COMPRESS) && J->DataSize > VAR_LZ_MIN_MATCH) {
+    // must come out smaller than raw to be worth the decode
+    J->Stored = VarLzCompress(J->Data, J->DataSize, J->Packed, J->DataSize - 1,
+                              Ctx->Tables + Worker * (VAR_LZ_TABLE_SIZE / sizeof(UINT32)));
+  }
+}
+
+STATIC VOID
+FlushBatch(IN OUT SAVE_CONTEXT *Ctx)
+{
+  SNAPSHOT_RECORD R;
+
+  VarMpRun(PackJob, Ctx, Ctx->JobCount);
+
+  for (UINTN i = 0; i < Ctx->JobCount; i++) {
+    SAVE_JOB *J = &Ctx->Jobs[i];
+
+    ZeroMem(&R, sizeof(R));
+    R.NameSize = (UINT16)StrSize(J->Name);
+    R.Codec = (J->Stored != 0) ? SnapCodecLz : SnapCodecRaw;
+    R.Attributes = J->Attributes;
+    R.DataSize = (UINT32)J->DataSize;
+    R.StoredSize = (UINT32)((J->Stored != 0) ? J->Stored : J->DataSize);
+    R.Crc = J->Crc;
+    CopyGuid(&R.Guid, &J->Guid);
+
+    VarWriterPut(Ctx->Writer, &R, sizeof(R));
+    VarWriterPut(Ctx->Writer, J->Name, R.NameSize);
+    VarWriterPut(Ctx->Writer, (J->Stored != 0) ? J->Packed : J->Data, R.StoredSize);
+
+    Ctx->Stats->Count++;
+    Ctx->Stats->RawBytes += J->DataSize;
+    Ctx->Stats->StoredBytes += R.StoredSize;
+  }
+
+  Ctx->JobCount = 0;
+  Ctx->ArenaUsed = 0;
+}
+
+STATIC BOOLEAN
+SaveCallback(IN CHAR16 *Name, IN EFI_GUID *Guid, IN VOID *Context)
+{
+  SAVE_CONTEXT *Ctx = Context;
+  SAVE_JOB *J;
+  UINT8 *Data;
+  UINTN Size;
+  UINT32 Attr;
+  UINTN NameSize = StrSize(Name);
+  UINTN Need;
+
+  if (EFI_ERROR(VarReadFresh(Name, Guid, &Attr, &Data, &Size))) {
+    Ctx->Stats->Skipped++;
+    return TRUE;
+  }
+
+  Need = ALIGN_VALUE(NameSize, 8) + Size;
+  if (Ctx->JobCount == SNAPSHOT_BATCH_JOBS || Ctx->ArenaUsed + Need > Ctx->ArenaSize) {
+    FlushBatch(Ctx);
+  }
+
+  // one variable larger than the batch: grow the (now empty) arenas
+  if (Need > Ctx->ArenaSize) {
+    UINT8 *NewArena = ReallocatePool(Ctx->ArenaSize, Need, Ctx->Arena);
+    UINT8 *NewPack;
+    if (NewArena != NULL) Ctx->Arena = NewArena;
+    NewPack = (NewArena != NULL) ? ReallocatePool(Ctx->ArenaSize, Need, Ctx->PackArena) : NULL;
+    if (NewPack == NULL) {
+      Ctx->Writer->Status = EFI_OUT_OF_RESOURCES;
+      return FALSE;
+    }
+    Ctx->PackArena = NewPack;
+    Ctx->ArenaSize = Need;
+  }
+
+  J = &Ctx->Jobs[Ctx->JobCount++];
+  J->Name = (CHAR16 *)(Ctx->Arena + Ctx->ArenaUsed);
+  CopyMem(J->Name, Name, NameSize);
+  Ctx->ArenaUsed += ALIGN_VALUE(NameSize, 8);
+  J->Data = Ctx->Arena + Ctx->ArenaUsed;
+  J->Packed = Ctx->PackArena + Ctx->ArenaUsed;
+  CopyMem(J->Data, Data, Size);
+  Ctx->ArenaUsed += Size;
+  CopyGuid(&J->Guid, Guid);
+  J->Attributes = Attr;
+  J->DataSize = Size;
+
+  return !EFI_ERROR(Ctx->Writer->Status);
+}
+
+EFI_STATUS
+VarSnapshotSave(IN OUT VAR_WRITER *Writer, IN UINT32 Flags, OUT VAR_SNAPSHOT_STATS *Stats)
+{
+  EFI_STATUS Status = EFI_OUT_OF_RESOURCES;
+  SNAPSHOT_HEADER Hdr;
+  SNAPSHOT_RECORD EndRec;
+  SAVE_CONTEXT *Ctx;
+
+  ZeroMem(Stats, sizeof(*Stats));
+
+  Ctx = AllocateZeroPool(sizeof(*Ctx));
+  if (Ctx == NULL) return EFI_OUT_OF_RESOURCES;
+  Ctx->Writer = Writer;
+  Ctx->Flags = Flags;
+  Ctx->Stats = Stats;
+  Ctx->ArenaSize = SNAPSHOT_BATCH_BYTES;
+  Ctx->Arena = AllocatePool(Ctx->ArenaSize);
+  Ctx->PackArena = AllocatePool(Ctx->ArenaSize);
+  Ctx->Tables = AllocatePool(VarMpWorkerCount() * VAR_LZ_TABLE_SIZE);
+  if (Ctx->Arena == NULL || Ctx->PackArena == NULL || Ctx->Tables == NULL) goto Done;
+
+  ZeroMem(&Hdr, sizeof(Hdr));
+  Hdr.Signature = SNAPSHOT_SIGNATURE;
+  Hdr.Version = SNAPSHOT_VERSION;
+  Hdr.HeaderSize = sizeof(Hdr);
+  Hdr.Flags = Flags;
+  gRT->GetTime(&Hdr.Time, NULL);
+  VarWriterPut(Writer, &Hdr, sizeof(Hdr));
+
+  Status = VarForEachVariable(SaveCallback, Ctx);
+  FlushBatch(Ctx);
+
+  ZeroMem(&EndRec, sizeof(EndRec));
+  EndRec.DataSize = (UINT32)Stats->Count;
+  VarWriterPut(Writer, &EndRec, sizeof(EndRec));
+
+  if (!EFI_ERROR(Status)) Status = Writer->Status;
+
+Done:
+  if (Ctx->Arena != NULL) FreePool(Ctx->Arena);
+  if (Ctx->PackArena != NULL) FreePool(Ctx->PackArena);
+  if (Ctx->Tables != NULL) FreePool(Ctx->Tables);
+  FreePool(Ctx);
+  return Status;
+}
+
+// =============================
+// Restore
+// =============================
+STATIC EFI_STATUS
+ReadExact(IN EFI_FILE_PROTOCOL *File, OUT VOID *Buffer, IN UINTN Size)
+{
+  UINT8 *p = Buffer;
+
+  while (Size > 0) {
+    UINTN Chunk = Size;
+    EFI_STATUS Status = File->Read(File, &Chunk, p);
+    if (EFI_ERROR(Status)) return Status;
+    if (Chunk == 0) return EFI_END_OF_FILE;
+    p += Chunk;
+    Size -= Chunk;
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC BOOLEAN
+GrowBuffer(IN OUT UINT8 **Buffer, IN OUT UINTN *Size, IN UINTN Needed)
+{
+  UINT8 *NewBuf;
+
+  if (*Size >= Needed) return TRUE;
+  NewBuf = ReallocatePool(*Size, Needed, *Buffer);
+  if (NewBuf == NULL) return FALSE;
+  *Buffer = NewBuf;
+  *Size = Needed;
+  return TRUE;
+}
+
+// Write one decoded record unless the store already holds the same value.
+STATIC EFI_STATUS
+RestoreRecord(IN CHAR16 *Name, IN SNAPSHOT_RECORD *R, IN UINT8 *Data, IN BOOLEAN DryRun, IN OUT VAR_WRITER *Log,
+              OUT BOOLEAN *Unchanged)
+{
+  EFI_STATUS Status;
+  EFI_STATUS Undo;
+  VAR_SPACE_CHECK Check;
+  UINT8 *Cur;
+  UINT8 *Saved;
+  UINTN CurSize;
+  UINT32 CurAttr;
+  UINT32 Attr = R->Attributes & ~EFI_VARIABLE_APPEND_WRITE;
+  BOOLEAN Exists;
+
+  *Unchanged = FALSE;
+
+  Exists = !EFI_ERROR(VarReadFresh(Name, &R->Guid, &CurAttr, &Cur, &CurSize));
+  if (Exists && CurAttr == Attr && CurSize == R->DataSize && CompareMem(Cur, Data, CurSize) == 0) {
+    *Unchanged = TRUE;
+    return EFI_SUCCESS;
+  }
+
+  // time-based authenticated variables need a signed payload
+  if (Attr & (EFI_VARIABLE_AUTHENTICATED_WRITE_ACCESS | EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS)) {
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  if (DryRun) return EFI_SUCCESS;
+
+  if (!Exists || CurAttr == Attr) {
+    return VarSetVariable(Name, &R->Guid, Attr, R->DataSize, Data);
+  }
+
+  // attributes cannot change in place: delete and rewrite, but only once
+  // the new record is known to fit, and with the old value kept to put back
+  if ((Attr & EFI_VARIABLE_NON_VOLATILE) && R->DataSize > 0 &&
+      VarSpaceCheck(Name, &R->Guid, Attr, R->DataSize, &Check) >= VarSpaceNoRoom) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Saved = AllocateCopyPool(MAX(CurSize, 1), Cur);     // Cur is only valid until the next read
+  if (Saved == NULL) return EFI_OUT_OF_RESOURCES;
+
+  Status = VarSetVariable(Name, &R->Guid, CurAttr, 0, NULL);
+  if (!EFI_ERROR(Status)) {
+    Status = VarSetVariable(Name, &R->Guid, Attr, R->DataSize, Data);
+    if (EFI_ERROR(Status)) {
+      Undo = VarSetVariable(Name, &R->Guid, CurAttr, CurSize, Saved);
+      if (EFI_ERROR(Undo)) {
+        VarWriterPrint(Log, "  LOST      %s  %g  previous value could not be put back: %r\n", Name, &R->Guid, Undo);
+      }
+    }
+  }
+  FreePool(Saved);
+  return Status;
+}
+
+EFI_STATUS
+VarSnapshotRestore(IN CHAR16 *Path, IN BOOLEAN DryRun, IN OUT VAR_WRITER *Log, OUT VAR_SNAPSHOT_STATS *Stats)
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File = NULL;
+  SNAPSHOT_HEADER Hdr;
+  SNAPSHOT_RECORD R;
+  CHAR16 *Name = NULL;
+  UINT8 *Stored = NULL;
+  UINT8 *Data = NULL;
+  UINTN StoredSize = 0;
+  UINTN DataSize = 0;
+
+  ZeroMem(Stats, sizeof(*Stats));
+
+  Status = VarFileOpen(Path, FALSE, &File);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = ReadExact(File, &Hdr, sizeof(Hdr));
+  if (EFI_ERROR(Status) || Hdr.Signature != SNAPSHOT_SIGNATURE || Hdr.Version != SNAPSHOT_VERSION ||
+      Hdr.HeaderSize != sizeof(Hdr)) {
+    File->Close(File);
+    return EFI_ERROR(Status) && Status != EFI_END_OF_FILE ? Status : EFI_VOLUME_CORRUPTED;
+  }
+
+  Name = AllocatePool(MAX_UINT16);
+  if (Name == NULL) {
+    File->Close(File);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  VarWriterPrint(Log, "Snapshot taken %04u-%02u-%02u %02u:%02u:%02u%a\n",
+                 Hdr.Time.Year, Hdr.Time.Month, Hdr.Time.Day, Hdr.Time.Hour, Hdr.Time.Minute, Hdr.Time.Second,
+                 DryRun ? " (dry run, nothing written)" : "");
+
+  while (TRUE) {
+    BOOLEAN Unchanged;
+    UINT8 *Payload;
+    EFI_STATUS RecStatus;
+
+    Status = ReadExact(File, &R, sizeof(R));
+    if (EFI_ERROR(Status)) break;
+
+    if (R.NameSize == 0) {
+      Status = (R.DataSize == Stats->Count) ? EFI_SUCCESS : EFI_VOLUME_CORRUPTED;
+      break;
+    }
+
+    if (R.NameSize < sizeof(CHAR16) || (R.NameSize & 1) != 0 || R.DataSize > SNAPSHOT_MAX_DATA ||
+        R.StoredSize > SNAPSHOT_MAX_DATA || R.Codec > SnapCodecLz ||
+        (R.Codec == SnapCodecRaw && R.StoredSize != R.DataSize)) {
+      Status = EFI_VOLUME_CORRUPTED;
+      break;
+    }
+
+    Status = ReadExact(File, Name, R.NameSize);
+    if (EFI_ERROR(Status)) break;
+    Name[R.NameSize / sizeof(CHAR16) - 1] = L'\0';
+
+    if (!GrowBuffer(&Stored, &StoredSize, MAX(R.StoredSize, 1))) {
+      Status = EFI_OUT_OF_RESOURCES;
+      break;
+    }
+    Status = ReadExact(File, Stored, R.StoredSize);
+    if (EFI_ERROR(Status)) break;
+
+    Payload = Stored;
+    if (R.Codec == SnapCodecLz) {
+      if (!GrowBuffer(&Data, &DataSize, MAX(R.DataSize, 1))) {
+        Status = EFI_OUT_OF_RESOURCES;
+        break;
+      }
+      Status = VarLzDecompress(Stored, R.StoredSize, Data, R.DataSize);
+      if (EFI_ERROR(Status)) break;
+      Payload = Data;
+    }
+    if (CalculateCrc32(Payload, R.DataSize) != R.Crc) {
+      Status = EFI_CRC_ERROR;
+      break;
+    }
+
+    Stats->Count++;
+    Stats->RawBytes += R.DataSize;
+    Stats->StoredBytes += R.StoredSize;
+
+    RecStatus = RestoreRecord(Name, &R, Payload, DryRun, Log, &Unchanged);
+    if (Unchanged) {
+      Stats->Unchanged++;
+    } else if (RecStatus == EFI_SECURITY_VIOLATION) {
+      Stats->Skipped++;
+      VarWriterPrint(Log, "  skipped   %s  %g  (authenticated, needs a signed payload)\n", Name, &R.Guid);
+    } else if (EFI_ERROR(RecStatus)) {
+      Stats->Failed++;
+      VarWriterPrint(Log, "  failed    %s  %g  %r\n", Name, &R.Guid, RecStatus);
+    } else {
+      Stats->Restored++;
+      VarWriterPrint(Log, "  %a %s  %g  %u bytes\n", DryRun ? "differs " : "restored", Name, &R.Guid, R.DataSize);
+    }
+  }
+
+  if (Status == EFI_END_OF_FILE) Status = EFI_VOLUME_CORRUPTED;   // no end record: truncated
+
+  File->Close(File);
+  FreePool(Name);
+  if (Stored != NULL) FreePool(Stored);
+  if (Data != NULL) FreePool(Data);
+  return Status;
+}
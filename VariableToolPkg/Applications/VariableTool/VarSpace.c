@@ -0,0 +1,119 @@
+#include "VariableTool.h"
+
+// =============================
+// Pre-write space check
+// QueryVariableInfo reports what a reclaim could make available, not the
+// free tail of the store, so the new record is sized the way the store
+// lays it out (authenticated header, 4-byte aligned name and data) and a
+// write that leaves less than VAR_SPACE_RECLAIM_MARGIN is flagged as
+// likely to force a reclaim. The live record a write replaces is still
+// counted as used there, but the driver drops it when it reclaims for the
+// write, so it is credited back (Freed).
+// =============================
+#define VAR_SPACE_HEADER_SIZE   60    // AUTHENTICATED_VARIABLE_HEADER, the larger layout
+#define VAR_SPACE_ALIGN(x)      ALIGN_VALUE((x), 4)
+
+STATIC UINT64
+ReclaimMargin(IN UINT64 MaxStorage)
+{
+  return MAX(MaxStorage / 10, SIZE_4KB);
+}
+
+// Store classes share one QueryVariableInfo answer per attribute set.
+STATIC UINT32
+QueryAttributes(IN UINT32 Attributes)
+{
+  return Attributes & (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS |
+                       EFI_VARIABLE_RUNTIME_ACCESS | EFI_VARIABLE_HARDWARE_ERROR_RECORD |
+                       EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS);
+}
+
+UINT64
+VarSpaceRecordSize(IN CONST CHAR16 *Name, IN UINTN DataSize)
+{
+  return VAR_SPACE_HEADER_SIZE + VAR_SPACE_ALIGN(StrSize(Name)) + VAR_SPACE_ALIGN(DataSize);
+}
+
+STATIC VOID
+Classify(IN OUT VAR_SPACE_CHECK *Check, IN UINTN NameSize, IN UINTN TotalData)
+{
+  UINT64 Available = Check->Remaining + Check->Freed;
+
+  if (Check->MaxVariableSize != 0 && NameSize + TotalData > Check->MaxVariableSize) {
+    Check->Verdict = VarSpaceTooLarge;
+  } else if (Check->Needed > Available) {
+    Check->Verdict = VarSpaceNoRoom;
+  } else if (Available - Check->Needed < ReclaimMargin(Check->MaxStorage)) {
+    Check->Verdict = VarSpaceLow;
+  } else {
+    Check->Verdict = VarSpaceOk;
+  }
+}
+
+VAR_SPACE_VERDICT
+VarSpaceCheck(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, OUT VAR_SPACE_CHECK *Check)
+{
+  EFI_STATUS Status;
+  UINTN TotalData = DataSize;
+  UINTN OldSize = 0;
+  UINT32 OldAttr = 0;
+
+  ZeroMem(Check, sizeof(*Check));
+  Check->Verdict = VarSpaceUnknown;
+
+  Status = gVarBackend->QueryVariableInfo(QueryAttributes(Attributes), &Check->MaxStorage,
+                                          &Check->Remaining, &Check->MaxVariableSize);
+  if (EFI_ERROR(Status)) return VarSpaceUnknown;
+
+  if (!EFI_ERROR(GetVariableDataSizeQuick(Name, Guid, &OldSize, &OldAttr))) {
+    // an append rewrites the whole variable as one new record
+    if (Attributes & EFI_VARIABLE_APPEND_WRITE) TotalData += OldSize;
+    if (OldAttr & EFI_VARIABLE_NON_VOLATILE) Check->Freed = VarSpaceRecordSize(Name, OldSize);
+  }
+
+  Check->Needed = VarSpaceRecordSize(Name, TotalData);
+  Classify(Check, StrSize(Name), TotalData);
+  return Check->Verdict;
+}
+
+// Net effect of a whole plan on the NV store: new records are added, the
+// records of replaced or deleted variables are reclaimed by the driver as
+// the writes need the room.
+VAR_SPACE_VERDICT
+VarSpaceProjectPlan(IN VAR_OP *Ops, IN UINTN Count, OUT VAR_SPACE_CHECK *Check)
+{
+  EFI_STATUS Status;
+  UINT64 Freed = 0;
+  UINTN Largest = 0, LargestName = 0;
+
+  ZeroMem(Check, sizeof(*Check));
+  Check->Verdict = VarSpaceUnknown;
+
+  Status = gVarBackend->QueryVariableInfo(EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+                                          &Check->MaxStorage, &Check->Remaining, &Check->MaxVariableSize);
+  if (EFI_ERROR(Status)) return VarSpaceUnknown;
+
+  for (UINTN i = 0; i < Count; i++) {
+    VAR_OP *Op = &Ops[i];
+    UINTN OldSize = 0;
+    UINT32 OldAttr = 0;
+    BOOLEAN Exists = !EFI_ERROR(GetVariableDataSizeQuick(Op->Name, &Op->Guid, &OldSize, &OldAttr));
+    UINT32 Attr = Op->ExplicitAttributes ? Op->Attributes : (Exists ? OldAttr : EFI_VARIABLE_NON_VOLATILE);
+    UINTN NewSize = (Op->Kind == VarOpAppend) ? OldSize + Op->DataSize : Op->DataSize;
+
+    if (Exists && (OldAttr & EFI_VARIABLE_NON_VOLATILE)) {
+      Freed += VarSpaceRecordSize(Op->Name, OldSize);
+    }
+    if (Op->Kind == VarOpDelete || (Attr & EFI_VARIABLE_NON_VOLATILE) == 0) continue;
+
+    Check->Needed += VarSpaceRecordSize(Op->Name, NewSize);
+    if (NewSize > Largest) {
+      Largest = NewSize;
+      LargestName = StrSize(Op->Name);
+    }
+  }
+
+  Check->Freed = Freed;
+  Classify(Check, LargestName, Largest);
+  return Check->Verdict;
+}
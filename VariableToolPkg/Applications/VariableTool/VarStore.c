@@ -0,0 +1,392 @@
+#include "VariableTool.h"
+
+// =============================
+// Variable store images
+// Layout as written by MdeModulePkg's variable driver on IA32/X64 (name
+// and data unpadded, ALIGNMENT 1; records start 4-byte aligned). Nothing is
+// copied: entries point into the image, so a mapped firmware dump can be
+// walked without reading it twice.
+// =============================
+typedef struct {
+  UINT8  HeaderSize;
+  UINT8  NameSize;      // field offsets inside the record header
+  UINT8  DataSize;
+  UINT8  Guid;
+} RECORD_LAYOUT;
+
+// VARIABLE_HEADER, AUTHENTICATED_VARIABLE_HEADER (packed)
+STATIC CONST RECORD_LAYOUT mLayout[2] = {
+  { 32,  8, 12, 16 },
+  { 60, 36, 40, 44 }
+};
+
+// gEfiVariableGuid, gEfiAuthenticatedVariableGuid
+STATIC CONST EFI_GUID mStoreGuid     = { 0xddcf3616, 0x3275, 0x4164, { 0x98, 0xb6, 0xfe, 0x85, 0x70, 0x7f, 0xfe, 0x7d } };
+STATIC CONST EFI_GUID mAuthStoreGuid = { 0xaaf32c78, 0x947b, 0x439a, { 0xa1, 0x80, 0x2e, 0x14, 0x4e, 0xc3, 0x77, 0x92 } };
+
+EFI_STATUS
+VarStoreFind(IN UINT8 *Image, IN UINTN ImageSize, IN OUT UINTN *Offset, OUT VAR_STORE *Store)
+{
+  for (UINTN Pos = ALIGN_VALUE(*Offset, 4); Pos + VAR_STORE_HEADER_SIZE <= ImageSize; Pos += 4) {
+    UINT8 *Header = Image + Pos;
+    UINT32 First = ReadUnaligned32((UINT32 *)Header);
+    UINT32 Size;
+    BOOLEAN Auth;
+
+    // first dword filters out nearly everything before the full compare
+    if (First != mStoreGuid.Data1 && First != mAuthStoreGuid.Data1) continue;
+    Auth = CompareMem(Header, &mAuthStoreGuid, sizeof(EFI_GUID)) == 0;
+    if (!Auth && CompareMem(Header, &mStoreGuid, sizeof(EFI_GUID)) != 0) continue;
+
+    Size = ReadUnaligned32((UINT32 *)(Header + 16));
+    if (Header[20] != VAR_STORE_FORMATTED || Size <= VAR_STORE_HEADER_SIZE) continue;
+
+    Store->Base = Header;
+    Store->Size = MIN(Size, ImageSize - Pos);     // truncated dumps still parse
+    Store->Offset = Pos;
+    Store->Authenticated = Auth;
+    Store->Format = Header[20];
+    Store->State = Header[21];
+    *Offset = Pos + VAR_STORE_HEADER_SIZE;
+    return EFI_SUCCESS;
+  }
+
+  *Offset = ImageSize;
+  return EFI_NOT_FOUND;
+}
+
+BOOLEAN
+VarStoreNextEntry(IN CONST VAR_STORE *Store, IN OUT UINTN *Cursor, OUT VAR_STORE_ENTRY *Entry)
+{
+  CONST RECORD_LAYOUT *Layout = &mLayout[Store->Authenticated ? 1 : 0];
+  UINTN Pos = (*Cursor == 0) ? ALIGN_VALUE(VAR_STORE_HEADER_SIZE, 4) : *Cursor;
+  UINTN Room;
+  UINT8 *Header;
+  UINT32 NameSize;
+  UINT32 DataSize;
+
+  if (Pos >= Store->Size || Store->Size - Pos < Layout->HeaderSize) return FALSE;
+  Header = Store->Base + Pos;
+  if (ReadUnaligned16((UINT16 *)Header) != VAR_STORE_START_ID) return FALSE;
+
+  NameSize = ReadUnaligned32((UINT32 *)(Header + Layout->NameSize));
+  DataSize = ReadUnaligned32((UINT32 *)(Header + Layout->DataSize));
+
+  // a header torn before its sizes were written takes no space, as in the driver
+  if (Header[2] == 0xFF || NameSize == MAX_UINT32 || DataSize == MAX_UINT32) {
+    NameSize = 0;
+    DataSize = 0;
+  }
+
+  // sizes that run past the store end the walk like an erased header
+  Room = Store->Size - Pos - Layout->HeaderSize;
+  if (NameSize > Room || DataSize > Room - NameSize) return FALSE;
+
+  Entry->Offset = Pos;
+  Entry->HeaderSize = Layout->HeaderSize;
+  Entry->State = Header[2];
+  Entry->Attributes = ReadUnaligned32((UINT32 *)(Header + 4));
+  Entry->Guid = (EFI_GUID *)(Header + Layout->Guid);
+  Entry->Name = (CHAR16 *)(Header + Layout->HeaderSize);
+  Entry->NameSize = NameSize;
+  Entry->Data = (UINT8 *)Entry->Name + NameSize;
+  Entry->DataSize = DataSize;
+  Entry->Next = ALIGN_VALUE(Pos + Layout->HeaderSize + NameSize + DataSize, 4);
+
+  *Cursor = Entry->Next;
+  return TRUE;
+}
+
+// =============================
+// Store health
+// Predicts the variable driver's view on the next boot. It counts every
+// record, dead or alive, against the store (HwErr records against their
+// own area), reclaims while initializing if the area after the last
+// record is not erased, and again before the OS (ReclaimForOS) once less
+// than a maximum-size variable fits.
+// =============================
+STATIC BOOLEAN
+HasAddedTwin(IN CONST VAR_STORE *Store, IN CONST VAR_STORE_ENTRY *Entry)
+{
+  VAR_STORE_ENTRY Other;
+  UINTN Cursor = 0;
+
+  while (VarStoreNextEntry(Store, &Cursor, &Other)) {
+    if (Other.State == VAR_STORE_ADDED && Other.NameSize == Entry->NameSize &&
+        CompareGuid(Other.Guid, Entry->Guid) && CompareMem(Other.Name, Entry->Name, Entry->NameSize) == 0) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+VOID
+VarStoreHealth(IN CONST VAR_STORE *Store, IN UINTN MaxVariableSize, IN UINTN HwErrStorageSize,
+               OUT VAR_STORE_HEALTH *Health)
+{
+  VAR_STORE_ENTRY Entry;
+  UINTN Cursor = 0;
+  UINTN LiveBytes = 0;
+  UINTN CommonBytes = 0;
+  UINTN CommonSpace;
+  UINTN Run = 0;
+  BOOLEAN Dirty = FALSE;
+
+  ZeroMem(Health, sizeof(VAR_STORE_HEALTH));
+  Health->Used = VAR_STORE_HEADER_SIZE;
+
+  while (VarStoreNextEntry(Store, &Cursor, &Entry)) {
+    UINTN Size = Entry.Next - Entry.Offset;
+    VAR_STORE_TALLY *Tally;
+    BOOLEAN Live = FALSE;
+
+    if ((Entry.State & (UINT8)~VAR_STORE_DELETED) == 0) {
+      Tally = &Health->Deleted;
+    } else if (Entry.State == (VAR_STORE_ADDED & VAR_STORE_IN_TRANSITION)) {
+      // rare (an interrupted update), so the twin search stays cheap
+      Tally = &Health->InTransition;
+      Live = !HasAddedTwin(Store, &Entry);
+    } else if (Entry.State == VAR_STORE_ADDED) {
+      Tally = &Health->Added;
+      Live = TRUE;
+    } else {
+      Tally = &Health->Incomplete;
+    }
+
+    Tally->Count++;
+    Tally->Bytes += Size;
+    if (Live) LiveBytes += Size;
+    if ((Entry.Attributes & (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_HARDWARE_ERROR_RECORD)) !=
+        (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_HARDWARE_ERROR_RECORD)) {
+      CommonBytes += Size;
+    }
+    Health->Used = Entry.Next;
+  }
+
+  Health->Free = Store->Size - Health->Used;
+  for (UINTN Pos = Health->Used; Pos < Store->Size; Pos++) {
+    if (Store->Base[Pos] == 0xFF) {
+      Run++;
+      Health->LargestFree = MAX(Health->LargestFree, Run);
+    } else {
+      Run = 0;
+      Dirty = TRUE;
+    }
+  }
+  Health->Reclaimable = Health->Used - VAR_STORE_HEADER_SIZE - LiveBytes;
+
+  CommonSpace = Store->Size - VAR_STORE_HEADER_SIZE;
+  CommonSpace = (CommonSpace > HwErrStorageSize) ? CommonSpace - HwErrStorageSize : 0;
+  Health->Headroom = (CommonSpace > CommonBytes) ? CommonSpace - CommonBytes : 0;
+
+  if (Dirty) {
+    Health->Trigger = VarReclaimDirtyFree;
+  } else if (Health->Headroom < MaxVariableSize) {
+    Health->Trigger = VarReclaimLowSpace;
+  } else {
+    Health->Trigger = VarReclaimNone;
+    Health->WritesBeforeReclaim = Health->Headroom - MaxVariableSize;
+  }
+}
+
+// =============================
+// Read-only backend over a parsed store
+// Live variables (VAR_ADDED, or an in-delete-transition copy with no
+// VAR_ADDED twin) are indexed once in store order with an open-addressing
+// table on VarNameHash, so GetNextVariableName continues from the
+// previous name in O(1) instead of rescanning the store.
+// =============================
+typedef struct {
+  UINT32  Hash;
+  UINT32  Index;        // into mLive, plus one; 0 = empty
+} STORE_SLOT;
+
+STATIC VAR_STORE mStore;
+STATIC VAR_STORE_ENTRY *mLive = NULL;
+STATIC UINTN mLiveCount = 0;
+STATIC STORE_SLOT *mSlots = NULL;
+STATIC UINTN mSlotMask = 0;
+
+STATIC BOOLEAN
+EntryIsCandidate(IN CONST VAR_STORE_ENTRY *Entry)
+{
+  if (Entry->State != VAR_STORE_ADDED && Entry->State != (VAR_STORE_ADDED & VAR_STORE_IN_TRANSITION)) {
+    return FALSE;
+  }
+  // the index and GetNextVariableName need a terminated UTF-16 name
+  return Entry->NameSize >= sizeof(CHAR16) && (Entry->NameSize & 1) == 0 &&
+         Entry->Name[Entry->NameSize / sizeof(CHAR16) - 1] == L'\0';
+}
+
+STATIC STORE_SLOT *
+StoreSlot(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, IN UINT32 Hash)
+{
+  UINTN i = Hash & mSlotMask;
+
+  while (mSlots[i].Index != 0) {
+    VAR_STORE_ENTRY *Entry = &mLive[mSlots[i].Index - 1];
+    if (mSlots[i].Hash == Hash && CompareGuid(Entry->Guid, Guid) && StrCmp(Entry->Name, Name) == 0) break;
+    i = (i + 1) & mSlotMask;
+  }
+  return &mSlots[i];
+}
+
+// With Current, an entry whose state byte changed since indexing reads as
+// missing: over live flash (VarFlash.c) the variable was deleted or
+// rewritten by someone else and the caller has to ask runtime services.
+STATIC VAR_STORE_ENTRY *
+StoreLookup(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, IN BOOLEAN Current)
+{
+  STORE_SLOT *Slot;
+  VAR_STORE_ENTRY *Entry;
+
+  if (mSlots == NULL) return NULL;
+  Slot = StoreSlot(Name, Guid, VarNameHash(Name, Guid));
+  if (Slot->Index == 0) return NULL;
+  Entry = &mLive[Slot->Index - 1];
+  if (Current && mStore.Base[Entry->Offset + 2] != Entry->State) return NULL;
+  return Entry;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+StoreGetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, IN OUT UINTN *DataSize, OUT VOID *Data OPTIONAL)
+{
+  VAR_STORE_ENTRY *Entry;
+
+  if (Name == NULL || Guid == NULL || DataSize == NULL) return EFI_INVALID_PARAMETER;
+
+  Entry = StoreLookup(Name, Guid, TRUE);
+  if (Entry == NULL) return EFI_NOT_FOUND;
+
+  if (Attributes != NULL) *Attributes = Entry->Attributes;
+  if (*DataSize < Entry->DataSize) {
+    *DataSize = Entry->DataSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  if (Data == NULL && Entry->DataSize != 0) return EFI_INVALID_PARAMETER;
+
+  CopyMem(Data, Entry->Data, Entry->DataSize);
+  *DataSize = Entry->DataSize;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+StoreGetNextVariableName(IN OUT UINTN *NameSize, IN OUT CHAR16 *Name, IN OUT EFI_GUID *Guid)
+{
+  VAR_STORE_ENTRY *Entry;
+  UINTN Next = 0;
+
+  if (NameSize == NULL || Name == NULL || Guid == NULL) return EFI_INVALID_PARAMETER;
+
+  if (Name[0] != L'\0') {
+    Entry = StoreLookup(Name, Guid, FALSE);
+    if (Entry == NULL) return EFI_INVALID_PARAMETER;
+    Next = (UINTN)(Entry - mLive) + 1;
+  }
+  if (Next >= mLiveCount) return EFI_NOT_FOUND;
+
+  Entry = &mLive[Next];
+  if (*NameSize < Entry->NameSize) {
+    *NameSize = Entry->NameSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  CopyMem(Name, Entry->Name, Entry->NameSize);
+  CopyGuid(Guid, Entry->Guid);
+  *NameSize = Entry->NameSize;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+StoreSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  return EFI_WRITE_PROTECTED;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+StoreQueryVariableInfo(IN UINT32 Attributes, OUT UINT64 *MaxStorage, OUT UINT64 *Remaining, OUT UINT64 *MaxVariableSize)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS
+StoreReadInPlace(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  VAR_STORE_ENTRY *Entry = StoreLookup(Name, Guid, TRUE);
+
+  if (Entry == NULL) return EFI_NOT_FOUND;
+  if (Attributes != NULL) *Attributes = Entry->Attributes;
+  *Data = Entry->Data;
+  *DataSize = Entry->DataSize;
+  return EFI_SUCCESS;
+}
+
+STATIC VAR_BACKEND mStoreBackend = {
+  L"store image",
+  StoreGetVariable,
+  StoreGetNextVariableName,
+  StoreSetVariable,
+  StoreQueryVariableInfo,
+  StoreReadInPlace
+};
+
+VOID
+VarStoreBackendClose(VOID)
+{
+  if (gVarBackend == &mStoreBackend) VarBackendSelect(NULL);
+  if (mLive != NULL) FreePool(mLive);
+  if (mSlots != NULL) FreePool(mSlots);
+  mLive = NULL;
+  mSlots = NULL;
+  mLiveCount = 0;
+  mSlotMask = 0;
+}
+
+EFI_STATUS
+VarStoreBackendOpen(IN VAR_STORE *Store, OUT VAR_BACKEND **Backend)
+{
+  VAR_STORE_ENTRY Entry;
+  UINTN Cursor = 0;
+  UINTN Candidates = 0;
+  UINTN Slots = 16;
+
+  VarStoreBackendClose();
+  CopyMem(&mStore, Store, sizeof(VAR_STORE));
+
+  while (VarStoreNextEntry(&mStore, &Cursor, &Entry)) {
+    if (EntryIsCandidate(&Entry)) Candidates++;
+  }
+  while (Slots < 2 * Candidates) Slots *= 2;
+
+  mLive = AllocatePool(MAX(Candidates, 1) * sizeof(VAR_STORE_ENTRY));
+  mSlots = AllocateZeroPool(Slots * sizeof(STORE_SLOT));
+  if (mLive == NULL || mSlots == NULL) {
+    VarStoreBackendClose();
+    return EFI_OUT_OF_RESOURCES;
+  }
+  mSlotMask = Slots - 1;
+
+  for (Cursor = 0; VarStoreNextEntry(&mStore, &Cursor, &Entry); ) {
+    UINT32 Hash;
+    STORE_SLOT *Slot;
+
+    if (!EntryIsCandidate(&Entry)) continue;
+
+    Hash = VarNameHash(Entry.Name, Entry.Guid);
+    Slot = StoreSlot(Entry.Name, Entry.Guid, Hash);
+    if (Slot->Index == 0) {
+      CopyMem(&mLive[mLiveCount], &Entry, sizeof(Entry));
+      Slot->Hash = Hash;
+      Slot->Index = (UINT32)++mLiveCount;
+    } else if (Entry.State == VAR_STORE_ADDED || mLive[Slot->Index - 1].State != VAR_STORE_ADDED) {
+      // the new copy of an interrupted update wins over the old one
+      CopyMem(&mLive[Slot->Index - 1], &Entry, sizeof(Entry));
+    }
+  }
+
+  *Backend = &mStoreBackend;
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,303 @@
+#include "VariableTool.h"
+
+// =============================
+// Change watcher
+// Each poll is one enumeration with a size/attribute probe per variable.
+// Payloads are read (and CRC32'd) only for new variables, for ones whose
+// size or attributes changed, and for a small round-robin sample of the
+// rest, which catches same-size rewrites within a few polls.
+// =============================
+#define WATCH_SAMPLE_PER_POLL  16
+
+typedef struct {
+  CHAR16    *Name;
+  EFI_GUID  Guid;
+  UINTN     Size;
+  UINT32    Attributes;
+  UINT32    Crc;
+  BOOLEAN   HaveCrc;
+  UINT32    Generation;   // last poll that saw it
+} WATCH_ENTRY;
+
+typedef struct {
+  WATCH_ENTRY  *Entries;
+  UINTN        Count;
+  UINTN        Capacity;
+  UINT32       *Slots;       // open addressing, entry index + 1, 0 = empty
+  UINTN        SlotCount;    // power of two, > 2 * Count
+  UINT32       Generation;
+  UINTN        SampleCursor;
+  VAR_WRITER   *Log;
+  BOOLEAN      Quiet;        // baseline poll: record, do not report
+  VAR_WATCH_STATS Stats;
+} WATCH_STATE;
+
+STATIC VOID
+LogEvent(IN WATCH_STATE *St, IN CONST CHAR8 *Tag, IN WATCH_ENTRY *Entry, IN UINTN OldSize)
+{
+  EFI_TIME Now;
+
+  if (St->Quiet) return;
+
+  ZeroMem(&Now, sizeof(Now));
+  gRT->GetTime(&Now, NULL);
+
+  VarWriterPrint(St->Log, "%02u:%02u:%02u  %a  %s  %g  ", Now.Hour, Now.Minute, Now.Second, Tag, Entry->Name, &Entry->Guid);
+  if (OldSize != Entry->Size) {
+    VarWriterPrint(St->Log, "size %u -> %u\n", (UINT32)OldSize, (UINT32)Entry->Size);
+  } else {
+    VarWriterPrint(St->Log, "size %u\n", (UINT32)Entry->Size);
+  }
+}
+
+STATIC UINT32 *
+FindSlot(IN WATCH_STATE *St, IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid)
+{
+  UINTN Mask = St->SlotCount - 1;
+  UINTN i = VarNameHash(Name, Guid) & Mask;
+
+  while (St->Slots[i] != 0) {
+    WATCH_ENTRY *Entry = &St->Entries[St->Slots[i] - 1];
+    if (CompareGuid(&Entry->Guid, Guid) && StrCmp(Entry->Name, Name) == 0) break;
+    i = (i + 1) & Mask;
+  }
+  return &St->Slots[i];
+}
+
+STATIC EFI_STATUS
+RebuildIndex(IN OUT WATCH_STATE *St)
+{
+  UINTN SlotCount = 64;
+
+  while (SlotCount < St->Count * 2 + 1) SlotCount *= 2;
+
+  if (SlotCount != St->SlotCount) {
+    if (St->Slots != NULL) FreePool(St->Slots);
+    St->Slots = AllocatePool(SlotCount * sizeof(UINT32));
+    if (St->Slots == NULL) return EFI_OUT_OF_RESOURCES;
+    St->SlotCount = SlotCount;
+  }
+  ZeroMem(St->Slots, St->SlotCount * sizeof(UINT32));
+
+  for (UINTN i = 0; i < St->Count; i++) {
+    *FindSlot(St, St->Entries[i].Name, &St->Entries[i].Guid) = (UINT32)(i + 1);
+  }
+  return EFI_SUCCESS;
+}
+
+// Read the payload and refresh size/attributes/CRC; FALSE if it vanished.
+STATIC BOOLEAN
+ReadEntry(IN OUT WATCH_STATE *St, IN OUT WATCH_ENTRY *Entry)
+{
+  UINT8 *Data;
+  UINTN Size;
+  UINT32 Attr;
+
+  St->Stats.Reads++;
+  if (EFI_ERROR(VarReadFresh(Entry->Name, &Entry->Guid, &Attr, &Data, &Size))) {
+    Entry->HaveCrc = FALSE;
+    return FALSE;
+  }
+  Entry->Size = Size;
+  Entry->Attributes = Attr;
+  Entry->Crc = CalculateCrc32(Data, Size);
+  Entry->HaveCrc = TRUE;
+  return TRUE;
+}
+
+STATIC BOOLEAN
+PollCallback(IN CHAR16 *Name, IN EFI_GUID *Guid, IN VOID *Context)
+{
+  WATCH_STATE *St = Context;
+  UINT32 *Slot;
+  WATCH_ENTRY *Entry;
+  UINTN Size = 0;
+  UINT32 Attr = 0;
+
+  if (EFI_ERROR(GetVariableDataSizeQuick(Name, Guid, &Size, &Attr))) {
+    return TRUE;
+  }
+
+  Slot = FindSlot(St, Name, Guid);
+  if (*Slot != 0) {
+    UINTN OldSize;
+    UINT32 OldCrc;
+    UINT32 OldAttr;
+
+    Entry = &St->Entries[*Slot - 1];
+    Entry->Generation = St->Generation;
+    if (Entry->Size == Size && Entry->Attributes == Attr) return TRUE;
+
+    // size or attributes moved: confirm with the content
+    OldSize = Entry->Size;
+    OldCrc = Entry->Crc;
+    OldAttr = Entry->Attributes;
+    if (ReadEntry(St, Entry) && (Entry->Size != OldSize || Entry->Crc != OldCrc || Entry->Attributes != OldAttr)) {
+      if (!St->Quiet) St->Stats.Modified++;
+      LogEvent(St, "MODIFIED", Entry, OldSize);
+    }
+    return TRUE;
+  }
+
+  // new variable
+  if (St->Count == St->Capacity) {
+    UINTN NewCap = (St->Capacity == 0) ? 256 : St->Capacity * 2;
+    WATCH_ENTRY *NewEntries = ReallocatePool(St->Capacity * sizeof(WATCH_ENTRY), NewCap * sizeof(WATCH_ENTRY), St->Entries);
+    if (NewEntries == NULL) return FALSE;
+    St->Entries = NewEntries;
+    St->Capacity = NewCap;
+  }
+
+  Entry = &St->Entries[St->Count];
+  ZeroMem(Entry, sizeof(*Entry));
+  Entry->Name = AllocateCopyPool(StrSize(Name), Name);
+  if (Entry->Name == NULL) return FALSE;
+  CopyGuid(&Entry->Guid, Guid);
+  Entry->Size = Size;
+  Entry->Attributes = Attr;
+  Entry->Generation = St->Generation;
+  ReadEntry(St, Entry);
+
+  St->Count++;
+  if (St->Count * 2 >= St->SlotCount) {
+    if (EFI_ERROR(RebuildIndex(St))) return FALSE;
+  } else {
+    *Slot = (UINT32)St->Count;
+  }
+
+  if (!St->Quiet) St->Stats.Created++;
+  LogEvent(St, "CREATED ", Entry, Entry->Size);
+  return TRUE;
+}
+
+// Entries not seen in this poll were deleted.
+STATIC EFI_STATUS
+SweepDeleted(IN OUT WATCH_STATE *St)
+{
+  UINTN Kept = 0;
+
+  for (UINTN i = 0; i < St->Count; i++) {
+    WATCH_ENTRY *Entry = &St->Entries[i];
+    if (Entry->Generation != St->Generation) {
+      St->Stats.Deleted++;
+      LogEvent(St, "DELETED ", Entry, Entry->Size);
+      FreePool(Entry->Name);
+      continue;
+    }
+    if (Kept != i) St->Entries[Kept] = *Entry;
+    Kept++;
+  }
+
+  if (Kept == St->Count) return EFI_SUCCESS;
+  St->Count = Kept;
+  return RebuildIndex(St);
+}
+
+STATIC VOID
+SampleUnchanged(IN OUT WATCH_STATE *St)
+{
+  UINTN n = MIN(St->Count, WATCH_SAMPLE_PER_POLL);
+
+  for (UINTN k = 0; k < n; k++) {
+    WATCH_ENTRY *Entry;
+    UINT32 OldCrc;
+    BOOLEAN HadCrc;
+
+    if (St->SampleCursor >= St->Count) St->SampleCursor = 0;
+    Entry = &St->Entries[St->SampleCursor++];
+
+    OldCrc = Entry->Crc;
+    HadCrc = Entry->HaveCrc;
+    if (ReadEntry(St, Entry) && HadCrc && Entry->Crc != OldCrc) {
+      St->Stats.Modified++;
+      LogEvent(St, "MODIFIED", Entry, Entry->Size);
+    }
+  }
+}
+
+STATIC EFI_STATUS
+Poll(IN OUT WATCH_STATE *St)
+{
+  EFI_STATUS Status;
+
+  St->Generation++;
+  St->Stats.Polls++;
+
+  Status = VarForEachVariable(PollCallback, St);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = SweepDeleted(St);
+  if (EFI_ERROR(Status)) return Status;
+
+  if (!St->Quiet) SampleUnchanged(St);
+  return VarWriterFlush(St->Log);
+}
+
+STATIC VOID
+FreeWatchState(IN WATCH_STATE *St)
+{
+  for (UINTN i = 0; i < St->Count; i++) {
+    FreePool(St->Entries[i].Name);
+  }
+  if (St->Entries) FreePool(St->Entries);
+  if (St->Slots) FreePool(St->Slots);
+}
+
+EFI_STATUS
+VarWatch(IN OUT VAR_WRITER *Log, IN UINTN IntervalMs, OUT VAR_WATCH_STATS *Stats)
+{
+  EFI_STATUS Status;
+  WATCH_STATE St;
+  EFI_EVENT Events[2];
+  UINTN Index;
+  EFI_INPUT_KEY Key;
+
+  ZeroMem(&St, sizeof(St));
+  St.Log = Log;
+
+  Status = RebuildIndex(&St);
+  if (EFI_ERROR(Status)) return Status;
+
+  // baseline
+  St.Quiet = TRUE;
+  Status = Poll(&St);
+  St.Quiet = FALSE;
+  if (EFI_ERROR(Status)) {
+    FreeWatchState(&St);
+    return Status;
+  }
+  St.Stats.Baseline = St.Count;
+  VarWriterPrint(Log, "Watching %u variables every %u ms, ESC to stop\n", (UINT32)St.Count, (UINT32)IntervalMs);
+  VarWriterFlush(Log);
+
+  Status = gBS->CreateEvent(EVT_TIMER, TPL_CALLBACK, NULL, NULL, &Events[0]);
+  if (EFI_ERROR(Status)) {
+    FreeWatchState(&St);
+    return Status;
+  }
+  // SetTimer takes 100 ns units
+  gBS->SetTimer(Events[0], TimerPeriodic, MultU64x32(MAX(IntervalMs, 10), 10000));
+  Events[1] = gST->ConIn->WaitForKey;
+
+  while (TRUE) {
+    Status = gBS->WaitForEvent(2, Events, &Index);
+    if (EFI_ERROR(Status)) break;
+
+    if (Index == 1) {
+      if (!EFI_ERROR(gST->ConIn->ReadKeyStroke(gST->ConIn, &Key)) && Key.ScanCode == SCAN_ESC) {
+        break;
+      }
+      continue;
+    }
+
+    Status = Poll(&St);
+    if (EFI_ERROR(Status)) break;
+  }
+
+  gBS->SetTimer(Events[0], TimerCancel, 0);
+  gBS->CloseEvent(Events[0]);
+
+  CopyMem(Stats, &St.Stats, sizeof(*Stats));
+  FreeWatchState(&St);
+  return Status;
+}
@@ -0,0 +1,143 @@
+#include "VariableTool.h"
+
+// =============================
+// Buffered writer
+// Output is collected in one large buffer and handed to the file system in
+// VAR_WRITER_BUFFER_SIZE chunks. The first error is sticky, so producers can
+// write freely and check once in VarWriterClose().
+// =============================
+// Console sink: widen to CHAR16 in small chunks, "\n" => "\r\n".
+STATIC VOID
+ConsoleFlush(IN OUT VAR_WRITER *Writer)
+{
+  CHAR16 Out[256];
+  UINTN n = 0;
+
+  for (UINTN i = 0; i < Writer->Used; i++) {
+    if (Writer->Buffer[i] == '\n') Out[n++] = L'\r';
+    Out[n++] = (CHAR16)(UINT8)Writer->Buffer[i];
+    if (n >= ARRAY_SIZE(Out) - 2) {
+      Out[n] = L'\0';
+      gST->ConOut->OutputString(gST->ConOut, Out);
+      n = 0;
+    }
+  }
+  Out[n] = L'\0';
+  gST->ConOut->OutputString(gST->ConOut, Out);
+  Writer->Used = 0;
+}
+
+STATIC VOID
+WriterFlush(IN OUT VAR_WRITER *Writer)
+{
+  UINTN Size = Writer->Used;
+
+  if (Size == 0 || EFI_ERROR(Writer->Status)) {
+    Writer->Used = 0;
+    return;
+  }
+
+  if (Writer->File == NULL) {
+    ConsoleFlush(Writer);
+    return;
+  }
+
+  Writer->Status = Writer->File->Write(Writer->File, &Size, Writer->Buffer);
+  if (!EFI_ERROR(Writer->Status) && Size != Writer->Used) {
+    Writer->Status = EFI_VOLUME_FULL;
+  }
+  Writer->Used = 0;
+}
+
+EFI_STATUS
+VarWriterOpenFile(OUT VAR_WRITER *Writer, IN CHAR16 *Path)
+{
+  EFI_STATUS Status;
+
+  ZeroMem(Writer, sizeof(VAR_WRITER));
+
+  Writer->Buffer = AllocatePool(VAR_WRITER_BUFFER_SIZE);
+  if (Writer->Buffer == NULL) return EFI_OUT_OF_RESOURCES;
+  Writer->Size = VAR_WRITER_BUFFER_SIZE;
+
+  Status = VarFileOpen(Path, TRUE, &Writer->File);
+  if (EFI_ERROR(Status)) {
+    FreePool(Writer->Buffer);
+    Writer->Buffer = NULL;
+  }
+  return Status;
+}
+
+EFI_STATUS
+VarWriterOpenConsole(OUT VAR_WRITER *Writer)
+{
+  ZeroMem(Writer, sizeof(VAR_WRITER));
+
+  // small buffer: the console is line oriented and slow anyway
+  Writer->Buffer = AllocatePool(SIZE_4KB);
+  if (Writer->Buffer == NULL) return EFI_OUT_OF_RESOURCES;
+  Writer->Size = SIZE_4KB;
+  return EFI_SUCCESS;
+}
+
+VOID
+VarWriterPut(IN OUT VAR_WRITER *Writer, IN CONST VOID *Data, IN UINTN Length)
+{
+  CONST UINT8 *Src = Data;
+
+  Writer->Total += Length;
+
+  while (Length > 0) {
+    UINTN Chunk = MIN(Length, Writer->Size - Writer->Used);
+    CopyMem(Writer->Buffer + Writer->Used, Src, Chunk);
+    Writer->Used += Chunk;
+    Src += Chunk;
+    Length -= Chunk;
+    if (Writer->Used == Writer->Size) {
+      WriterFlush(Writer);
+    }
+  }
+}
+
+VOID
+VarWriterPrint(IN OUT VAR_WRITER *Writer, IN CONST CHAR8 *Format, ...)
+{
+  VA_LIST Marker;
+  CHAR8 Line[256];
+  UINTN Length;
+
+  VA_START(Marker, Format);
+  Length = AsciiVSPrint(Line, sizeof(Line), Format, Marker);
+  VA_END(Marker);
+
+  VarWriterPut(Writer, Line, Length);
+}
+
+// Push buffered output out now (live logs); errors stay sticky.
+EFI_STATUS
+VarWriterFlush(IN OUT VAR_WRITER *Writer)
+{
+  WriterFlush(Writer);
+  return Writer->Status;
+}
+
+EFI_STATUS
+VarWriterClose(IN OUT VAR_WRITER *Writer)
+{
+  EFI_STATUS Status;
+
+  WriterFlush(Writer);
+
+  if (Writer->File != NULL) {
+    Status = Writer->File->Close(Writer->File);
+    if (!EFI_ERROR(Writer->Status)) Writer->Status = Status;
+    Writer->File = NULL;
+  }
+
+  if (Writer->Buffer != NULL) {
+    FreePool(Writer->Buffer);
+    Writer->Buffer = NULL;
+  }
+
+  return Writer->Status;
+}
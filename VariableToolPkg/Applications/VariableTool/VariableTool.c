@@ -1,978 +1,2037 @@
-#include <Uefi.h>
-#include <Base.h>
-
-#include <Library/UefiLib.h>
-#include <Library/UefiApplicationEntryPoint.h>
-#include <Library/UefiRuntimeServicesTableLib.h>
-#include <Library/UefiBootServicesTableLib.h>
-
-#include <Library/MemoryAllocationLib.h>
-#include <Library/BaseMemoryLib.h>
-#include <Library/BaseLib.h>
-#include <Library/PrintLib.h>
-
-#define LINE_MAX_CHARS  128
-
-// Default Vendor GUID (as your menu shows)
-STATIC EFI_GUID mDefaultVendorGuid = { 0x37893825, 0x3B85, 0x02D0, { 0x37, 0x89, 0x33, 0xF9, 0x00, 0x00, 0x00, 0x00 } };
-
-STATIC VOID
-WaitAnyKey(VOID)
-{
-  EFI_INPUT_KEY Key;
-  Print(L"\nPress any key to continue...");
-  while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
-    gBS->Stall(1000);
-  }
-  Print(L"\n");
-}
-
-STATIC VOID
-SetTextAttr(UINTN Attr)
-{
-  if (gST != NULL && gST->ConOut != NULL) {
-    gST->ConOut->SetAttribute(gST->ConOut, Attr);
-  }
-}
-
-STATIC VOID
-ClearScreen(VOID)
-{
-  if (gST && gST->ConOut) {
-    gST->ConOut->ClearScreen(gST->ConOut);
-  }
-}
-
-STATIC EFI_STATUS
-GetConsoleSize(OUT UINTN *OutCols, OUT UINTN *OutRows)
-{
-  UINTN Cols = 0, Rows = 0;
-  EFI_STATUS Status;
-
-  if (gST == NULL || gST->ConOut == NULL || gST->ConOut->QueryMode == NULL) {
-    return EFI_UNSUPPORTED;
-  }
-
-  Status = gST->ConOut->QueryMode(gST->ConOut, gST->ConOut->Mode->Mode, &Cols, &Rows);
-  if (EFI_ERROR(Status)) {
-    return Status;
-  }
-
-  if (OutCols) *OutCols = Cols;
-  if (OutRows) *OutRows = Rows;
-  return EFI_SUCCESS;
-}
-
-STATIC VOID
-PrintGuidLine(IN EFI_GUID *Guid)
-{
-  // Print GUID in canonical form
-  Print(L"%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-        Guid->Data1, Guid->Data2, Guid->Data3,
-        Guid->Data4[0], Guid->Data4[1],
-        Guid->Data4[2], Guid->Data4[3], Guid->Data4[4], Guid->Data4[5], Guid->Data4[6], Guid->Data4[7]);
-}
-
-STATIC BOOLEAN
-IsHexChar(CHAR16 C)
-{
-  return ((C >= L'0' && C <= L'9') ||
-          (C >= L'a' && C <= L'f') ||
-          (C >= L'A' && C <= L'F'));
-}
-
-STATIC CHAR16
-ToUpperHex(CHAR16 C)
-{
-  if (C >= L'a' && C <= L'f') return (CHAR16)(C - (L'a' - L'A'));
-  return C;
-}
-
-STATIC INTN
-HexVal(CHAR16 C)
-{
-  if (C >= L'0' && C <= L'9') return (INTN)(C - L'0');
-  if (C >= L'a' && C <= L'f') return (INTN)(C - L'a' + 10);
-  if (C >= L'A' && C <= L'F') return (INTN)(C - L'A' + 10);
-  return -1;
-}
-
-STATIC EFI_STATUS
-ReadLine(IN CHAR16 *Buffer, IN UINTN BufferChars)
-{
-  UINTN Index = 0;
-  EFI_INPUT_KEY Key;
-
-  if (Buffer == NULL || BufferChars == 0) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  Buffer[0] = L'\0';
-
-  while (TRUE) {
-    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
-      gBS->Stall(1000);
-    }
-
-    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
-      Print(L"\n");
-      Buffer[Index] = L'\0';
-      return EFI_SUCCESS;
-    }
-
-    if (Key.UnicodeChar == CHAR_BACKSPACE) {
-      if (Index > 0) {
-        Index--;
-        Buffer[Index] = L'\0';
-        // erase one char on screen
-        Print(L"\b \b");
-      }
-      continue;
-    }
-
-    // ignore non-printable
-    if (Key.UnicodeChar < 0x20 || Key.UnicodeChar > 0x7E) {
-      continue;
-    }
-
-    if (Index + 1 < BufferChars) {
-      Buffer[Index++] = Key.UnicodeChar;
-      Buffer[Index] = L'\0';
-      Print(L"%c", Key.UnicodeChar);
-    }
-  }
-}
-
-// =============================
-// GUID masked input
-// Desired UI: ________-____-____-____-____________
-// Type replaces '_' from left to right (skip '-')
-// Enter with no input => returns empty string (OutStr[0] = L'\0')
-// If partially filled => returns EFI_NOT_READY
-// =============================
-STATIC EFI_STATUS
-ReadGuidMaskedLine(OUT CHAR16 *OutStr, IN UINTN OutChars)
-{
-  // template length must be 36
-  STATIC CONST CHAR16 *Mask = L"________-____-____-____-____________";
-  UINTN EditablePos[32];
-  UINTN EditCount = 0;
-  UINTN i;
-
-  EFI_INPUT_KEY Key;
-  UINTN StartCol, StartRow;
-  UINTN CurEdit = 0;
-  BOOLEAN AnyTyped = FALSE;
-
-  if (OutStr == NULL || OutChars < 37) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  // build editable positions
-  for (i = 0; i < 36; i++) {
-    if (Mask[i] == L'_') {
-      EditablePos[EditCount++] = i;
-    }
-  }
-
-  // init output with mask
-  StrCpyS(OutStr, OutChars, Mask);
-
-  // record cursor position BEFORE printing mask
-  StartCol = gST->ConOut->Mode->CursorColumn;
-  StartRow = gST->ConOut->Mode->CursorRow;
-
-  // print mask
-  Print(L"%s", OutStr);
-
-  // move cursor to first editable
-  gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[0], StartRow);
-
-  while (TRUE) {
-    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
-      gBS->Stall(1000);
-    }
-
-    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
-      Print(L"\n");
-
-      if (!AnyTyped) {
-        // user didn't type anything => treat as empty
-        OutStr[0] = L'\0';
-        return EFI_SUCCESS;
-      }
-
-      // if any '_' remains => incomplete
-      for (i = 0; i < 36; i++) {
-        if (OutStr[i] == L'_') {
-          return EFI_NOT_READY;
-        }
-      }
-      return EFI_SUCCESS;
-    }
-
-    if (Key.UnicodeChar == CHAR_BACKSPACE) {
-      if (CurEdit > 0) {
-        CurEdit--;
-        AnyTyped = TRUE; // still typed, but we keep state
-
-        // restore underscore at previous editable slot
-        OutStr[EditablePos[CurEdit]] = L'_';
-
-        // draw it
-        gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
-        Print(L"_");
-
-        // move cursor back to that slot
-        gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
-      }
-      continue;
-    }
-
-    // allow user to type '-' but ignore (we already have it)
-    if (Key.UnicodeChar == L'-') {
-      continue;
-    }
-
-    // only accept hex
-    if (!IsHexChar(Key.UnicodeChar)) {
-      continue;
-    }
-
-    if (CurEdit >= EditCount) {
-      // already full
-      continue;
-    }
-
-    AnyTyped = TRUE;
-
-    // place uppercase hex into the next underscore slot
-    OutStr[EditablePos[CurEdit]] = ToUpperHex(Key.UnicodeChar);
-
-    // draw at that exact position
-    gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
-    Print(L"%c", OutStr[EditablePos[CurEdit]]);
-
-    CurEdit++;
-
-    if (CurEdit < EditCount) {
-      gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
-    } else {
-      // end => keep cursor at end of mask
-      gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + 36, StartRow);
-    }
-  }
-}
-
-STATIC EFI_STATUS
-ParseGuidString(IN CHAR16 *Str, OUT EFI_GUID *OutGuid)
-{
-  // Expect: 8-4-4-4-12 hex (36 chars)
-  // Example: 47C7B227-C42A-11D2-8E57-00A0C969723B
-  UINTN Len;
-  UINTN i;
-  INTN v;
-
-  UINT32 d1 = 0;
-  UINT16 d2 = 0, d3 = 0;
-  UINT8  d4[8];
-
-  if (Str == NULL || OutGuid == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  Len = StrLen(Str);
-  if (Len != 36) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  // check hyphens
-  if (Str[8] != L'-' || Str[13] != L'-' || Str[18] != L'-' || Str[23] != L'-') {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  // d1: 8
-  for (i = 0; i < 8; i++) {
-    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
-    v = HexVal(Str[i]);
-    d1 = (d1 << 4) | (UINT32)v;
-  }
-
-  // d2: 4 at 9..12
-  for (i = 9; i < 13; i++) {
-    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
-    v = HexVal(Str[i]);
-    d2 = (UINT16)((d2 << 4) | (UINT16)v);
-  }
-
-  // d3: 4 at 14..17
-  for (i = 14; i < 18; i++) {
-    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
-    v = HexVal(Str[i]);
-    d3 = (UINT16)((d3 << 4) | (UINT16)v);
-  }
-
-  // d4[0..1]: 2+2 at 19..22
-  if (!IsHexChar(Str[19]) || !IsHexChar(Str[20]) || !IsHexChar(Str[21]) || !IsHexChar(Str[22])) {
-    return EFI_INVALID_PARAMETER;
-  }
-  d4[0] = (UINT8)((HexVal(Str[19]) << 4) | HexVal(Str[20]));
-  d4[1] = (UINT8)((HexVal(Str[21]) << 4) | HexVal(Str[22]));
-
-  // d4[2..7]: 12 at 24..35 -> 6 bytes
-  for (i = 0; i < 6; i++) {
-    UINTN pos = 24 + i * 2;
-    if (!IsHexChar(Str[pos]) || !IsHexChar(Str[pos + 1])) return EFI_INVALID_PARAMETER;
-    d4[2 + i] = (UINT8)((HexVal(Str[pos]) << 4) | HexVal(Str[pos + 1]));
-  }
-
-  OutGuid->Data1 = d1;
-  OutGuid->Data2 = d2;
-  OutGuid->Data3 = d3;
-  CopyMem(OutGuid->Data4, d4, sizeof(d4));
-  return EFI_SUCCESS;
-}
-
-STATIC VOID
-PrintHexDump(IN UINT8 *Data, IN UINTN DataSize)
-{
-  UINTN Offset;
-  UINTN i;
-
-  Print(L"    ");
-  for (i = 0; i < 16; i++) {
-    Print(L"%02x ", (UINTN)i);
-  }
-  Print(L"\n");
-
-  for (Offset = 0; Offset < DataSize; Offset += 16) {
-    Print(L"%02x  ", Offset & 0xFF);
-    for (i = 0; i < 16; i++) {
-      if (Offset + i < DataSize) {
-        Print(L"%02x ", Data[Offset + i]);
-      } else {
-        Print(L"   ");
-      }
-    }
-    Print(L"\n");
-  }
-}
-
-STATIC VOID
-PrintOneVariableDetailed(IN CHAR16 *VarName, IN EFI_GUID *VendorGuid)
-{
-  EFI_STATUS Status;
-  UINTN DataSize = 0;
-  UINT32 Attr = 0;
-  UINT8 *Data = NULL;
-
-  if (VarName == NULL || VendorGuid == NULL) {
-    return;
-  }
-
-  Status = gRT->GetVariable(VarName, VendorGuid, &Attr, &DataSize, NULL);
-  if (Status == EFI_BUFFER_TOO_SMALL && DataSize > 0) {
-    Data = (UINT8 *)AllocateZeroPool(DataSize);
-    if (Data == NULL) {
-      SetTextAttr(EFI_LIGHTRED);
-      Print(L"AllocateZeroPool failed\n");
-      SetTextAttr(EFI_LIGHTGRAY);
-      return;
-    }
-    Status = gRT->GetVariable(VarName, VendorGuid, &Attr, &DataSize, Data);
-  }
-
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"GetVariable failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-    if (Data != NULL) FreePool(Data);
-    return;
-  }
-
-  SetTextAttr(EFI_LIGHTGREEN);
-  Print(L"Vendor GUID: ");
-  PrintGuidLine(VendorGuid);
-  Print(L"\n");
-  SetTextAttr(EFI_LIGHTGRAY);
-
-  Print(L"Name: %s  Data Size: %u\n", VarName, (UINT32)DataSize);
-
-  if (DataSize > 0 && Data != NULL) {
-    PrintHexDump(Data, DataSize);
-  } else {
-    Print(L"(No Data)\n");
-  }
-
-  Print(L"\n");
-
-  if (Data != NULL) {
-    FreePool(Data);
-  }
-}
-
-STATIC EFI_STATUS
-ListOrFilterVariablesDetailed(BOOLEAN FilterByName, CHAR16 *TargetName, BOOLEAN FilterByGuid, EFI_GUID *TargetGuid, OUT UINTN *OutFound)
-{
-  EFI_STATUS Status;
-  UINTN NameBufSize;
-  CHAR16 *NameBuf = NULL;
-  EFI_GUID Guid;
-  UINTN Found = 0;
-
-  NameBufSize = 1024; // bytes
-  NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
-  if (NameBuf == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  ZeroMem(&Guid, sizeof(Guid));
-  NameBuf[0] = L'\0';
-
-  while (TRUE) {
-    UINTN ThisSize = NameBufSize;
-
-    Status = gRT->GetNextVariableName(&ThisSize, NameBuf, &Guid);
-    if (Status == EFI_BUFFER_TOO_SMALL) {
-      FreePool(NameBuf);
-      NameBufSize = ThisSize + 2 * sizeof(CHAR16);
-      NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
-      if (NameBuf == NULL) {
-        return EFI_OUT_OF_RESOURCES;
-      }
-      continue;
-    }
-
-    if (Status == EFI_NOT_FOUND) {
-      break;
-    }
-
-    if (EFI_ERROR(Status)) {
-      FreePool(NameBuf);
-      return Status;
-    }
-
-    if (FilterByName) {
-      if (TargetName == NULL) continue;
-      if (StrCmp(NameBuf, TargetName) != 0) continue;
-    }
-
-    if (FilterByGuid) {
-      if (TargetGuid == NULL) continue;
-      if (!CompareGuid(&Guid, TargetGuid)) continue;
-    }
-
-    PrintOneVariableDetailed(NameBuf, &Guid);
-    Found++;
-  }
-
-  if (OutFound) *OutFound = Found;
-
-  FreePool(NameBuf);
-  return EFI_SUCCESS;
-}
-
-// =============================
-// List-all table view (Name | DataSize | GUID) with paging
-// =============================
-typedef struct {
-  CHAR16  *Name;
-  EFI_GUID Guid;
-  UINTN   DataSize;
-} VAR_ITEM;
-
-STATIC EFI_STATUS
-GetVariableDataSizeQuick(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINTN *OutSize)
-{
-  EFI_STATUS Status;
-  UINTN Size = 0;
-  UINT32 Attr = 0;
-
-  if (OutSize) *OutSize = 0;
-
-  Status = gRT->GetVariable(Name, Guid, &Attr, &Size, NULL);
-  if (Status == EFI_BUFFER_TOO_SMALL) {
-    if (OutSize) *OutSize = Size;
-    return EFI_SUCCESS;
-  }
-  if (Status == EFI_SUCCESS) {
-    if (OutSize) *OutSize = Size;
-    return EFI_SUCCESS;
-  }
-  return Status;
-}
-
-STATIC EFI_STATUS
-CollectAllVariables(OUT VAR_ITEM **OutItems, OUT UINTN *OutCount)
-{
-  EFI_STATUS Status;
-  UINTN NameBufSize;
-  CHAR16 *NameBuf = NULL;
-  EFI_GUID Guid;
-
-  VAR_ITEM *Items = NULL;
-  UINTN Count = 0, Cap = 0;
-
-  if (OutItems) *OutItems = NULL;
-  if (OutCount) *OutCount = 0;
-
-  NameBufSize = 1024;
-  NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
-  if (NameBuf == NULL) return EFI_OUT_OF_RESOURCES;
-
-  ZeroMem(&Guid, sizeof(Guid));
-  NameBuf[0] = L'\0';
-
-  while (TRUE) {
-    UINTN ThisSize = NameBufSize;
-
-    Status = gRT->GetNextVariableName(&ThisSize, NameBuf, &Guid);
-    if (Status == EFI_BUFFER_TOO_SMALL) {
-      FreePool(NameBuf);
-      NameBufSize = ThisSize + 2 * sizeof(CHAR16);
-      NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
-      if (NameBuf == NULL) return EFI_OUT_OF_RESOURCES;
-      continue;
-    }
-    if (Status == EFI_NOT_FOUND) break;
-    if (EFI_ERROR(Status)) { FreePool(NameBuf); return Status; }
-
-    if (Count >= Cap) {
-      UINTN NewCap = (Cap == 0) ? 128 : (Cap * 2);
-      VAR_ITEM *NewItems = (VAR_ITEM *)AllocateZeroPool(sizeof(VAR_ITEM) * NewCap);
-      if (NewItems == NULL) {
-        FreePool(NameBuf);
-        if (Items) {
-          for (UINTN k = 0; k < Count; k++) { if (Items[k].Name) FreePool(Items[k].Name); }
-          FreePool(Items);
-        }
-        return EFI_OUT_OF_RESOURCES;
-      }
-      if (Items) {
-        CopyMem(NewItems, Items, sizeof(VAR_ITEM) * Count);
-        FreePool(Items);
-      }
-      Items = NewItems;
-      Cap = NewCap;
-    }
-
-    Items[Count].Name = AllocateCopyPool(StrSize(NameBuf), NameBuf);
-    if (Items[Count].Name == NULL) {
-      FreePool(NameBuf);
-      for (UINTN k = 0; k < Count; k++) { if (Items[k].Name) FreePool(Items[k].Name); }
-      FreePool(Items);
-      return EFI_OUT_OF_RESOURCES;
-    }
-
-    CopyMem(&Items[Count].Guid, &Guid, sizeof(EFI_GUID));
-    GetVariableDataSizeQuick(NameBuf, &Guid, &Items[Count].DataSize);
-
-    Count++;
-  }
-
-  FreePool(NameBuf);
-
-  if (OutItems) *OutItems = Items;
-  if (OutCount) *OutCount = Count;
-  return EFI_SUCCESS;
-}
-
-STATIC VOID
-FreeAllVariables(VAR_ITEM *Items, UINTN Count)
-{
-  if (Items == NULL) return;
-  for (UINTN i = 0; i < Count; i++) {
-    if (Items[i].Name) FreePool(Items[i].Name);
-  }
-  FreePool(Items);
-}
-
-STATIC VOID
-DrawListAllTable(VAR_ITEM *Items, UINTN Count, UINTN Top, UINTN Sel, UINTN PageRows)
-{
-  ClearScreen();
-
-  SetTextAttr(EFI_LIGHTGREEN);
-  Print(L"Default Vendor GUID: ");
-  PrintGuidLine(&mDefaultVendorGuid);
-  Print(L"\n");
-  Print(L"Variable Application\n\n");
-  SetTextAttr(EFI_LIGHTGRAY);
-
-  // header
-  SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
-  Print(L"Variable Name                         | Data Size | Vendor GUID\n");
-  SetTextAttr(EFI_LIGHTGRAY);
-
-  // rows
-  for (UINTN r = 0; r < PageRows; r++) {
-    UINTN idx = Top + r;
-    if (idx >= Count) {
-      Print(L"\n");
-      continue;
-    }
-
-    if (idx == Sel) {
-      SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
-    } else {
-      SetTextAttr(EFI_LIGHTGRAY);
-    }
-
-    // fixed-ish formatting: name left, size right, GUID
-    // name: 35 chars max (truncate)
-    CHAR16 NameBuf[48];
-    ZeroMem(NameBuf, sizeof(NameBuf));
-    if (Items[idx].Name) {
-      UINTN nlen = StrLen(Items[idx].Name);
-      UINTN copy = (nlen > 35) ? 35 : nlen;
-      CopyMem(NameBuf, Items[idx].Name, copy * sizeof(CHAR16));
-      NameBuf[copy] = L'\0';
-    }
-
-    Print(L"%-35s | %8u | ", NameBuf, (UINT32)Items[idx].DataSize);
-    PrintGuidLine(&Items[idx].Guid);
-    Print(L"\n");
-  }
-
-  SetTextAttr(EFI_LIGHTGRAY);
-
-  // footer
-  UINTN Page = (Count == 0) ? 0 : (Sel / PageRows) + 1;
-  UINTN PageCount = (Count == 0) ? 0 : ((Count + PageRows - 1) / PageRows);
-
-  UINTN ShowStart = (Count == 0) ? 0 : (Top + 1);
-  UINTN ShowEnd   = (Count == 0) ? 0 : ((Top + PageRows) > Count ? Count : (Top + PageRows));
-
-  Print(L"\nTotal: %u   Page: %u/%u   Showing: %u-%u\n",
-        (UINT32)Count, (UINT32)Page, (UINT32)PageCount, (UINT32)ShowStart, (UINT32)ShowEnd);
-  Print(L"Keys: Up/Down  PgUp/PgDn  Home/End  ESC exit\n");
-}
-
-STATIC VOID
-DoListAll(VOID)
-{
-  EFI_STATUS Status;
-  VAR_ITEM *Items = NULL;
-  UINTN Count = 0;
-
-  UINTN Cols = 0, Rows = 0;
-  UINTN PageRows = 15; // fallback
-  UINTN Top = 0;
-  UINTN Sel = 0;
-
-  Status = CollectAllVariables(&Items, &Count);
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Collect variables failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-    WaitAnyKey();
-    return;
-  }
-
-  if (!EFI_ERROR(GetConsoleSize(&Cols, &Rows)) && Rows > 10) {
-    // header: 3 lines + header row(1) + footer(3) => about 7
-    // keep safe margins
-    UINTN usable = Rows > 9 ? (Rows - 9) : 10;
-    PageRows = (usable < 5) ? 5 : usable;
-  }
-
-  while (TRUE) {
-    // adjust Top so Sel always visible
-    if (Sel < Top) Top = Sel;
-    if (Sel >= Top + PageRows) Top = Sel - (PageRows - 1);
-
-    DrawListAllTable(Items, Count, Top, Sel, PageRows);
-
-    EFI_INPUT_KEY Key;
-    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
-      gBS->Stall(1000);
-    }
-
-    if (Key.ScanCode == SCAN_ESC) {
-      break;
-    }
-
-    if (Key.ScanCode == SCAN_UP) {
-      if (Sel > 0) Sel--;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_DOWN) {
-      if (Count > 0 && Sel + 1 < Count) Sel++;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_PAGE_UP) {
-      if (Sel >= PageRows) Sel -= PageRows;
-      else Sel = 0;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_PAGE_DOWN) {
-      if (Count == 0) continue;
-      if (Sel + PageRows < Count) Sel += PageRows;
-      else Sel = Count - 1;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_HOME) {
-      Sel = 0;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_END) {
-      if (Count > 0) Sel = Count - 1;
-      continue;
-    }
-  }
-
-  FreeAllVariables(Items, Count);
-}
-
-STATIC VOID
-DoSearchByName(VOID)
-{
-  CHAR16 Name[LINE_MAX_CHARS];
-  EFI_STATUS Status;
-  UINTN Found = 0;
-
-  ClearScreen();
-  Print(L"Variable name: ");
-  ReadLine(Name, LINE_MAX_CHARS);
-
-  Print(L"\n");
-  Status = ListOrFilterVariablesDetailed(TRUE, Name, FALSE, NULL, &Found);
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Search failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-  } else {
-    Print(L"Number of variables found: %u\n", (UINT32)Found);
-  }
-  WaitAnyKey();
-}
-
-STATIC EFI_STATUS
-PromptVendorGuidMasked(IN EFI_GUID *DefaultGuid, OUT EFI_GUID *OutGuid)
-{
-  CHAR16 GuidMaskStr[64]; // need >= 37
-  EFI_STATUS Status;
-
-  if (DefaultGuid == NULL || OutGuid == NULL) return EFI_INVALID_PARAMETER;
-
-  Print(L"Vendor GUID (leave empty to use default): ");
-
-  Status = ReadGuidMaskedLine(GuidMaskStr, sizeof(GuidMaskStr)/sizeof(GuidMaskStr[0]));
-  if (Status == EFI_NOT_READY) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"GUID not complete. Please fill all hex digits.\n");
-    SetTextAttr(EFI_LIGHTGRAY);
-    return EFI_INVALID_PARAMETER;
-  }
-  if (EFI_ERROR(Status)) return Status;
-
-  if (GuidMaskStr[0] == L'\0') {
-    CopyMem(OutGuid, DefaultGuid, sizeof(EFI_GUID));
-    return EFI_SUCCESS;
-  }
-
-  Status = ParseGuidString(GuidMaskStr, OutGuid);
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Invalid GUID format.\n");
-    SetTextAttr(EFI_LIGHTGRAY);
-    return EFI_INVALID_PARAMETER;
-  }
-
-  return EFI_SUCCESS;
-}
-
-STATIC VOID
-DoSearchByGuid(IN EFI_GUID *DefaultGuid)
-{
-  EFI_GUID Guid;
-  EFI_STATUS Status;
-  UINTN Found = 0;
-
-  ClearScreen();
-  Print(L"Search variables by vendor GUID\n\n");
-
-  Status = PromptVendorGuidMasked(DefaultGuid, &Guid);
-  if (EFI_ERROR(Status)) {
-    WaitAnyKey();
-    return;
-  }
-
-  Print(L"\n");
-  Status = ListOrFilterVariablesDetailed(FALSE, NULL, TRUE, &Guid, &Found);
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Search failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-  } else {
-    Print(L"Number of variables found: %u\n", (UINT32)Found);
-  }
-  WaitAnyKey();
-}
-
-STATIC VOID
-DoDeleteVariable(VOID)
-{
-  CHAR16 Name[LINE_MAX_CHARS];
-  EFI_GUID Guid;
-  EFI_STATUS Status;
-
-  ClearScreen();
-  Print(L"Delete variable\n\n");
-
-  Print(L"Variable name to delete: ");
-  ReadLine(Name, LINE_MAX_CHARS);
-
-  Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
-  if (EFI_ERROR(Status)) {
-    WaitAnyKey();
-    return;
-  }
-
-  // Delete: Attributes=0, DataSize=0, Data=NULL
-  Status = gRT->SetVariable(Name, &Guid, 0, 0, NULL);
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Delete failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-  } else {
-    SetTextAttr(EFI_LIGHTGREEN);
-    Print(L"Deleted OK.\n");
-    SetTextAttr(EFI_LIGHTGRAY);
-  }
-
-  WaitAnyKey();
-}
-
-STATIC VOID
-DoCreateVariable(VOID)
-{
-  // Simple create: value stored as CHAR16 string entered by user
-  CHAR16 Name[LINE_MAX_CHARS];
-  CHAR16 Value[LINE_MAX_CHARS];
-  EFI_GUID Guid;
-  EFI_STATUS Status;
-
-  UINT32 Attr = EFI_VARIABLE_NON_VOLATILE |
-                EFI_VARIABLE_BOOTSERVICE_ACCESS |
-                EFI_VARIABLE_RUNTIME_ACCESS;
-
-  ClearScreen();
-  Print(L"Create new variable\n\n");
-
-  Print(L"New variable name: ");
-  ReadLine(Name, LINE_MAX_CHARS);
-
-  Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
-  if (EFI_ERROR(Status)) {
-    WaitAnyKey();
-    return;
-  }
-
-  Print(L"Value (stored as CHAR16 string): ");
-  ReadLine(Value, LINE_MAX_CHARS);
-
-  // store as UTF-16 including null terminator
-  Status = gRT->SetVariable(
-                  Name,
-                  &Guid,
-                  Attr,
-                  (StrLen(Value) + 1) * sizeof(CHAR16),
-                  Value
-                );
-
-  if (EFI_ERROR(Status)) {
-    SetTextAttr(EFI_LIGHTRED);
-    Print(L"Create/Set failed: %r\n", Status);
-    SetTextAttr(EFI_LIGHTGRAY);
-  } else {
-    SetTextAttr(EFI_LIGHTGREEN);
-    Print(L"Create/Set OK.\n");
-    SetTextAttr(EFI_LIGHTGRAY);
-  }
-
-  WaitAnyKey();
-}
-
-STATIC VOID
-ShowMenu(IN UINTN Sel)
-{
-  ClearScreen();
-
-  SetTextAttr(EFI_LIGHTGREEN);
-  Print(L"Default Vendor GUID: ");
-  PrintGuidLine(&mDefaultVendorGuid);
-  Print(L"\n");
-  Print(L"Variable Application\n\n");
-  SetTextAttr(EFI_LIGHTGRAY);
-
-  // 0 List all
-  // 1 Search by name
-  // 2 Search by vendor GUID
-  // 3 Create
-  // 4 Delete
-  // 5 Exit
-  for (UINTN i = 0; i < 6; i++) {
-    if (i == Sel) {
-      SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
-    } else {
-      SetTextAttr(EFI_LIGHTGRAY);
-    }
-
-    switch (i) {
-      case 0: Print(L"List all variables\n"); break;
-      case 1: Print(L"Search variables by name\n"); break;
-      case 2: Print(L"Search variables by vendor GUID\n"); break;
-      case 3: Print(L"Create new variable\n"); break;
-      case 4: Print(L"Delete variable\n"); break;
-      case 5: Print(L"Exit\n"); break;
-      default: break;
-    }
-  }
-
-  SetTextAttr(EFI_LIGHTGRAY);
-  Print(L"\nUse Up/Down and Enter.\n");
-}
-
-EFI_STATUS
-EFIAPI
-UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *SystemTable)
-{
-  UINTN Sel = 0;
-  EFI_INPUT_KEY Key;
-
-  while (TRUE) {
-    ShowMenu(Sel);
-
-    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
-      gBS->Stall(1000);
-    }
-
-    if (Key.ScanCode == SCAN_UP) {
-      if (Sel > 0) Sel--;
-      continue;
-    }
-
-    if (Key.ScanCode == SCAN_DOWN) {
-      if (Sel < 5) Sel++;
-      continue;
-    }
-
-    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
-      switch (Sel) {
-        case 0: DoListAll(); break;
-        case 1: DoSearchByName(); break;
-        case 2: DoSearchByGuid(&mDefaultVendorGuid); break;
-        case 3: DoCreateVariable(); break;
-        case 4: DoDeleteVariable(); break;
-        case 5: return EFI_SUCCESS;
-        default: break;
-      }
-    }
-  }
-}
+#include "VariableTool.h"
+
+#include <Library/UefiApplicationEntryPoint.h>
+
+#include <Protocol/ShellParameters.h>
+
+#define LINE_MAX_CHARS  128
+#define VALUE_MAX_CHARS 2048   // typed value line (hex / integer lists)
+
+// Default Vendor GUID (as your menu shows)
+STATIC EFI_GUID mDefaultVendorGuid = { 0x37893825, 0x3B85, 0x02D0, { 0x37, 0x89, 0x33, 0xF9, 0x00, 0x00, 0x00, 0x00 } };
+
+// -catcache: List All starts from VAR_CATALOG_CACHE_FILE
+STATIC BOOLEAN mCatalogCacheEnabled = FALSE;
+
+// -guids: extra vendor GUID names (VarGuidNamesLoad), read before the menu
+STATIC CHAR16 *mGuidNamesPath = NULL;
+
+STATIC VOID
+WaitAnyKey(VOID)
+{
+  EFI_INPUT_KEY Key;
+  Print(L"\nPress any key to continue...");
+  while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+    gBS->Stall(1000);
+  }
+  Print(L"\n");
+}
+
+VOID
+SetTextAttr(IN UINTN Attr)
+{
+  if (gST != NULL && gST->ConOut != NULL) {
+    gST->ConOut->SetAttribute(gST->ConOut, Attr);
+  }
+}
+
+STATIC VOID
+ClearScreen(VOID)
+{
+  if (gST && gST->ConOut) {
+    gST->ConOut->ClearScreen(gST->ConOut);
+  }
+}
+
+STATIC EFI_STATUS
+GetConsoleSize(OUT UINTN *OutCols, OUT UINTN *OutRows)
+{
+  UINTN Cols = 0, Rows = 0;
+  EFI_STATUS Status;
+
+  if (gST == NULL || gST->ConOut == NULL || gST->ConOut->QueryMode == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = gST->ConOut->QueryMode(gST->ConOut, gST->ConOut->Mode->Mode, &Cols, &Rows);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+
+  if (OutCols) *OutCols = Cols;
+  if (OutRows) *OutRows = Rows;
+  return EFI_SUCCESS;
+}
+
+STATIC VOID
+PrintGuidLine(IN EFI_GUID *Guid)
+{
+  // canonical form, formatted without PrintLib (VarFormat.c)
+  CHAR16 Text[VAR_GUID_STRING_LENGTH + 1];
+
+  CONST CHAR8 *Name = VarGuidName(Guid);
+
+  VarFormatGuid16(Guid, Text);
+  gST->ConOut->OutputString(gST->ConOut, Text);
+  if (Name != NULL) Print(L" (%a)", Name);
+}
+
+STATIC BOOLEAN
+IsHexChar(CHAR16 C)
+{
+  return ((C >= L'0' && C <= L'9') ||
+          (C >= L'a' && C <= L'f') ||
+          (C >= L'A' && C <= L'F'));
+}
+
+STATIC CHAR16
+ToUpperHex(CHAR16 C)
+{
+  if (C >= L'a' && C <= L'f') return (CHAR16)(C - (L'a' - L'A'));
+  return C;
+}
+
+STATIC INTN
+HexVal(CHAR16 C)
+{
+  if (C >= L'0' && C <= L'9') return (INTN)(C - L'0');
+  if (C >= L'a' && C <= L'f') return (INTN)(C - L'a' + 10);
+  if (C >= L'A' && C <= L'F') return (INTN)(C - L'A' + 10);
+  return -1;
+}
+
+STATIC EFI_STATUS
+ReadLine(IN CHAR16 *Buffer, IN UINTN BufferChars)
+{
+  UINTN Index = 0;
+  EFI_INPUT_KEY Key;
+
+  if (Buffer == NULL || BufferChars == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Buffer[0] = L'\0';
+
+  while (TRUE) {
+    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+      gBS->Stall(1000);
+    }
+
+    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
+      Print(L"\n");
+      Buffer[Index] = L'\0';
+      return EFI_SUCCESS;
+    }
+
+    if (Key.UnicodeChar == CHAR_BACKSPACE) {
+      if (Index > 0) {
+        Index--;
+        Buffer[Index] = L'\0';
+        // erase one char on screen
+        Print(L"\b \b");
+      }
+      continue;
+    }
+
+    // ignore non-printable
+    if (Key.UnicodeChar < 0x20 || Key.UnicodeChar > 0x7E) {
+      continue;
+    }
+
+    if (Index + 1 < BufferChars) {
+      Buffer[Index++] = Key.UnicodeChar;
+      Buffer[Index] = L'\0';
+      Print(L"%c", Key.UnicodeChar);
+    }
+  }
+}
+
+// =============================
+// GUID masked input
+// Desired UI: ________-____-____-____-____________
+// Type replaces '_' from left to right (skip '-')
+// Enter with no input => returns empty string (OutStr[0] = L'\0')
+// If partially filled => returns EFI_NOT_READY
+// =============================
+STATIC EFI_STATUS
+ReadGuidMaskedLine(OUT CHAR16 *OutStr, IN UINTN OutChars)
+{
+  // template length must be 36
+  STATIC CONST CHAR16 *Mask = L"________-____-____-____-____________";
+  UINTN EditablePos[32];
+  UINTN EditCount = 0;
+  UINTN i;
+
+  EFI_INPUT_KEY Key;
+  UINTN StartCol, StartRow;
+  UINTN CurEdit = 0;
+  BOOLEAN AnyTyped = FALSE;
+
+  if (OutStr == NULL || OutChars < 37) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // build editable positions
+  for (i = 0; i < 36; i++) {
+    if (Mask[i] == L'_') {
+      EditablePos[EditCount++] = i;
+    }
+  }
+
+  // init output with mask
+  StrCpyS(OutStr, OutChars, Mask);
+
+  // record cursor position BEFORE printing mask
+  StartCol = gST->ConOut->Mode->CursorColumn;
+  StartRow = gST->ConOut->Mode->CursorRow;
+
+  // print mask
+  Print(L"%s", OutStr);
+
+  // move cursor to first editable
+  gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[0], StartRow);
+
+  while (TRUE) {
+    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+      gBS->Stall(1000);
+    }
+
+    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
+      Print(L"\n");
+
+      if (!AnyTyped) {
+        // user didn't type anything => treat as empty
+        OutStr[0] = L'\0';
+        return EFI_SUCCESS;
+      }
+
+      // if any '_' remains => incomplete
+      for (i = 0; i < 36; i++) {
+        if (OutStr[i] == L'_') {
+          return EFI_NOT_READY;
+        }
+      }
+      return EFI_SUCCESS;
+    }
+
+    if (Key.UnicodeChar == CHAR_BACKSPACE) {
+      if (CurEdit > 0) {
+        CurEdit--;
+        AnyTyped = TRUE; // still typed, but we keep state
+
+        // restore underscore at previous editable slot
+        OutStr[EditablePos[CurEdit]] = L'_';
+
+        // draw it
+        gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
+        Print(L"_");
+
+        // move cursor back to that slot
+        gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
+      }
+      continue;
+    }
+
+    // allow user to type '-' but ignore (we already have it)
+    if (Key.UnicodeChar == L'-') {
+      continue;
+    }
+
+    // only accept hex
+    if (!IsHexChar(Key.UnicodeChar)) {
+      continue;
+    }
+
+    if (CurEdit >= EditCount) {
+      // already full
+      continue;
+    }
+
+    AnyTyped = TRUE;
+
+    // place uppercase hex into the next underscore slot
+    OutStr[EditablePos[CurEdit]] = ToUpperHex(Key.UnicodeChar);
+
+    // draw at that exact position
+    gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
+    Print(L"%c", OutStr[EditablePos[CurEdit]]);
+
+    CurEdit++;
+
+    if (CurEdit < EditCount) {
+      gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + EditablePos[CurEdit], StartRow);
+    } else {
+      // end => keep cursor at end of mask
+      gST->ConOut->SetCursorPosition(gST->ConOut, StartCol + 36, StartRow);
+    }
+  }
+}
+
+STATIC EFI_STATUS
+ParseGuidString(IN CHAR16 *Str, OUT EFI_GUID *OutGuid)
+{
+  // Expect: 8-4-4-4-12 hex (36 chars)
+  // Example: 47C7B227-C42A-11D2-8E57-00A0C969723B
+  UINTN Len;
+  UINTN i;
+  INTN v;
+
+  UINT32 d1 = 0;
+  UINT16 d2 = 0, d3 = 0;
+  UINT8  d4[8];
+
+  if (Str == NULL || OutGuid == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Len = StrLen(Str);
+  if (Len != 36) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // check hyphens
+  if (Str[8] != L'-' || Str[13] != L'-' || Str[18] != L'-' || Str[23] != L'-') {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // d1: 8
+  for (i = 0; i < 8; i++) {
+    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
+    v = HexVal(Str[i]);
+    d1 = (d1 << 4) | (UINT32)v;
+  }
+
+  // d2: 4 at 9..12
+  for (i = 9; i < 13; i++) {
+    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
+    v = HexVal(Str[i]);
+    d2 = (UINT16)((d2 << 4) | (UINT16)v);
+  }
+
+  // d3: 4 at 14..17
+  for (i = 14; i < 18; i++) {
+    if (!IsHexChar(Str[i])) return EFI_INVALID_PARAMETER;
+    v = HexVal(Str[i]);
+    d3 = (UINT16)((d3 << 4) | (UINT16)v);
+  }
+
+  // d4[0..1]: 2+2 at 19..22
+  if (!IsHexChar(Str[19]) || !IsHexChar(Str[20]) || !IsHexChar(Str[21]) || !IsHexChar(Str[22])) {
+    return EFI_INVALID_PARAMETER;
+  }
+  d4[0] = (UINT8)((HexVal(Str[19]) << 4) | HexVal(Str[20]));
+  d4[1] = (UINT8)((HexVal(Str[21]) << 4) | HexVal(Str[22]));
+
+  // d4[2..7]: 12 at 24..35 -> 6 bytes
+  for (i = 0; i < 6; i++) {
+    UINTN pos = 24 + i * 2;
+    if (!IsHexChar(Str[pos]) || !IsHexChar(Str[pos + 1])) return EFI_INVALID_PARAMETER;
+    d4[2 + i] = (UINT8)((HexVal(Str[pos]) << 4) | HexVal(Str[pos + 1]));
+  }
+
+  OutGuid->Data1 = d1;
+  OutGuid->Data2 = d2;
+  OutGuid->Data3 = d3;
+  CopyMem(OutGuid->Data4, d4, sizeof(d4));
+  return EFI_SUCCESS;
+}
+
+STATIC VOID
+PrintHexDump(IN UINT8 *Data, IN UINTN DataSize)
+{
+  CHAR8 Line[64];
+  CHAR16 Wide[64];
+  UINT8 Offset8;
+  UINTN n;
+
+  Print(L"    ");
+  for (UINTN i = 0; i < 16; i++) {
+    Print(L"%02x ", (UINTN)i);
+  }
+  Print(L"\n");
+
+  // one OutputString per line: "oo  xx xx .. xx \r\n"
+  for (UINTN Offset = 0; Offset < DataSize; Offset += 16) {
+    Offset8 = (UINT8)Offset;
+    n = VarFormatHex(&Offset8, 1, Line);
+    Line[n++] = ' ';
+    Line[n++] = ' ';
+    n += VarFormatHexColumns(Data + Offset, MIN(16, DataSize - Offset), Line + n);
+    Line[n++] = '\r';
+    Line[n++] = '\n';
+    VarFormatWiden(Line, n, Wide);
+    Wide[n] = L'\0';
+    gST->ConOut->OutputString(gST->ConOut, Wide);
+  }
+}
+
+STATIC VOID
+PrintOneVariableDetailed(IN CHAR16 *VarName, IN EFI_GUID *VendorGuid)
+{
+  EFI_STATUS Status;
+  UINT8 *Data = NULL;
+  UINTN DataSize = 0;
+
+  if (VarName == NULL || VendorGuid == NULL) {
+    return;
+  }
+
+  Status = VarReadBulk(VarName, VendorGuid, NULL, &Data, &DataSize);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"GetVariable failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    return;
+  }
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"Vendor GUID: ");
+  PrintGuidLine(VendorGuid);
+  Print(L"\n");
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  Print(L"Name: %s  Data Size: %u\n", VarName, (UINT32)DataSize);
+
+  if (DataSize > 0) {
+    PrintHexDump(Data, DataSize);
+  } else {
+    Print(L"(No Data)\n");
+  }
+
+  Print(L"\n");
+}
+
+STATIC EFI_STATUS
+ListOrFilterVariablesDetailed(BOOLEAN FilterByName, CHAR16 *TargetName, BOOLEAN FilterByGuid, EFI_GUID *TargetGuid, OUT UINTN *OutFound)
+{
+  EFI_STATUS Status;
+  UINTN NameBufSize;
+  CHAR16 *NameBuf = NULL;
+  EFI_GUID Guid;
+  UINTN Found = 0;
+
+  NameBufSize = 1024; // bytes
+  NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
+  if (NameBuf == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem(&Guid, sizeof(Guid));
+  NameBuf[0] = L'\0';
+
+  while (TRUE) {
+    UINTN ThisSize = NameBufSize;
+
+    Status = gVarBackend->GetNextVariableName(&ThisSize, NameBuf, &Guid);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      FreePool(NameBuf);
+      NameBufSize = ThisSize + 2 * sizeof(CHAR16);
+      NameBuf = (CHAR16 *)AllocateZeroPool(NameBufSize);
+      if (NameBuf == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      continue;
+    }
+
+    if (Status == EFI_NOT_FOUND) {
+      break;
+    }
+
+    if (EFI_ERROR(Status)) {
+      FreePool(NameBuf);
+      return Status;
+    }
+
+    if (FilterByName) {
+      if (TargetName == NULL) continue;
+      if (StrCmp(NameBuf, TargetName) != 0) continue;
+    }
+
+    if (FilterByGuid) {
+      if (TargetGuid == NULL) continue;
+      if (!CompareGuid(&Guid, TargetGuid)) continue;
+    }
+
+    PrintOneVariableDetailed(NameBuf, &Guid);
+    Found++;
+  }
+
+  if (OutFound) *OutFound = Found;
+
+  FreePool(NameBuf);
+  return EFI_SUCCESS;
+}
+
+// =============================
+// List-all table view (Name | DataSize | GUID) with paging
+// =============================
+// Detail view of one variable: payload comes from the LRU cache and the
+// typed decoders run only here, when the variable is opened.
+STATIC VOID
+ShowVariableDetail(IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+  VAR_PAYLOAD *Payload = NULL;
+  CHAR8 AttrText[32];
+
+  ClearScreen();
+
+  Status = VarCacheGet(Name, Guid, &Payload);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"GetVariable failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"Vendor GUID: ");
+  PrintGuidLine(Guid);
+  Print(L"\n");
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  VarAttributesToAscii(Payload->Attributes, AttrText, sizeof(AttrText));
+  Print(L"Name: %s  Data Size: %u  Attributes: 0x%08x (%a)\n\n",
+        Name, (UINT32)Payload->DataSize, Payload->Attributes, AttrText);
+
+  if (Payload->DataSize > 0) {
+    SetTextAttr(EFI_YELLOW);
+    if (VarDecodeAndPrint(Name, Guid, Payload->Data, Payload->DataSize)) {
+      Print(L"\n");
+    }
+    SetTextAttr(EFI_LIGHTGRAY);
+    PrintHexDump(Payload->Data, Payload->DataSize);
+  } else {
+    Print(L"(No Data)\n");
+  }
+
+  VarCacheRelease(Payload);
+  WaitAnyKey();
+}
+
+STATIC VOID
+EditVariable(IN CHAR16 *Name, IN EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+
+  Status = VarEditVariable(Name, Guid);
+  if (Status == EFI_ABORTED) return;
+
+  if (Status == EFI_ALREADY_STARTED) {
+    Print(L"No changes, nothing written.\n");
+  } else if (Status == EFI_WRITE_PROTECTED) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Authenticated variable: edits need a signed payload.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Edit failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    Print(L"Saved.\n");
+  }
+  WaitAnyKey();
+}
+
+// Row colors for catalog-cache states; confirmed rows look like fresh ones.
+STATIC UINTN
+RowAttribute(IN UINT8 State)
+{
+  switch (State) {
+    case VarItemStale:   return EFI_YELLOW;
+    case VarItemNew:     return EFI_LIGHTCYAN;
+    case VarItemDeleted: return EFI_LIGHTRED;
+    default:             return EFI_LIGHTGRAY;
+  }
+}
+
+// One table row, padded to Width columns and ending in "\r\n", so a redraw is
+// a single OutputString per row. Rebuilt only when the console width or the
+// entry's size (which also moves the growth column) differs from last time.
+STATIC CHAR16 *
+RenderRow(IN OUT VAR_CATALOG *Catalog, IN UINTN Index, IN UINTN Width)
+{
+  VAR_ROW *Row;
+  CHAR16 *Name = VarCatalogName(Catalog, Index);
+  EFI_GUID *VendorGuid = VAR_CATALOG_GUID(Catalog, Index);
+  UINT32 DataSize = Catalog->DataSize[Index];
+  CONST CHAR8 *Known;
+  CHAR16 Grow[16];
+  CHAR16 Guid[VAR_GUID_STRING_LENGTH + 1];
+  UINTN BaseSize;
+  UINTN n;
+
+  if (Catalog->Rows == NULL) {
+    Catalog->Rows = AllocateZeroPool(Catalog->Capacity * sizeof(VAR_ROW));
+    if (Catalog->Rows == NULL) return NULL;
+  }
+  Row = &Catalog->Rows[Index];
+
+  if (Row->Text != NULL && Row->Width == Width && Row->Size == DataSize) {
+    return Row->Text;
+  }
+
+  if (Row->Text != NULL && Row->Width != Width) {
+    FreePool(Row->Text);
+    Row->Text = NULL;
+  }
+  if (Row->Text == NULL) {
+    Row->Text = AllocatePool((Width + 3) * sizeof(CHAR16));
+    if (Row->Text == NULL) return NULL;
+  }
+
+  // growth from appends made in this session
+  Grow[0] = L'\0';
+  if (VarGrowthLookup(Name, VendorGuid, &BaseSize) && DataSize > BaseSize) {
+    UnicodeSPrint(Grow, sizeof(Grow), L"+%u", (UINT32)(DataSize - BaseSize));
+  }
+  // well-known vendors by name, the rest as GUIDs
+  Known = VarGuidName(VendorGuid);
+  if (Known != NULL) {
+    UnicodeSPrint(Guid, sizeof(Guid), L"%a", Known);
+  } else {
+    VarFormatGuid16(VendorGuid, Guid);
+  }
+
+  // name: 30 chars max (truncate); anything past Width is cut off
+  n = UnicodeSPrint(Row->Text, (Width + 1) * sizeof(CHAR16), L"%-30.30s | %8u %-9s | %s", Name, DataSize, Grow, Guid);
+  while (n < Width) Row->Text[n++] = L' ';
+  Row->Text[n++] = L'\r';
+  Row->Text[n++] = L'\n';
+  Row->Text[n] = L'\0';
+
+  Row->Width = (UINT32)Width;
+  Row->Size = DataSize;
+  return Row->Text;
+}
+
+STATIC VOID
+DrawListAllTable(VAR_CATALOG *Catalog, UINTN Top, UINTN Sel, UINTN PageRows, VAR_CATALOG_SYNC *Sync OPTIONAL)
+{
+  UINTN Count = Catalog->Count;
+  UINTN Cols = 0, Rows = 0;
+  UINTN Width = 79;
+  CHAR16 *Row;
+
+  // stay one column short of the edge: a full line auto-wraps on most consoles
+  if (!EFI_ERROR(GetConsoleSize(&Cols, &Rows)) && Cols > 1) {
+    Width = Cols - 1;
+  }
+
+  ClearScreen();
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"Default Vendor GUID: ");
+  PrintGuidLine(&mDefaultVendorGuid);
+  Print(L"\n");
+  Print(L"Variable Application\n\n");
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  // header
+  SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
+  Print(L"Variable Name                  | Data Size (+grown) | Vendor GUID\n");
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  // rows
+  for (UINTN r = 0; r < PageRows; r++) {
+    UINTN idx = Top + r;
+    if (idx >= Count) {
+      Print(L"\n");
+      continue;
+    }
+
+    if (idx == Sel) {
+      SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
+    } else {
+      SetTextAttr(RowAttribute(Catalog->State[idx]));
+    }
+
+    Row = RenderRow(Catalog, idx, Width);
+    if (Row != NULL) {
+      gST->ConOut->OutputString(gST->ConOut, Row);
+    } else {
+      Print(L"%-30.30s\n", VarCatalogName(Catalog, idx));
+    }
+  }
+
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  // footer
+  UINTN Page = (Count == 0) ? 0 : (Sel / PageRows) + 1;
+  UINTN PageCount = (Count == 0) ? 0 : ((Count + PageRows - 1) / PageRows);
+
+  UINTN ShowStart = (Count == 0) ? 0 : (Top + 1);
+  UINTN ShowEnd   = (Count == 0) ? 0 : ((Top + PageRows) > Count ? Count : (Top + PageRows));
+
+  Print(L"\nTotal: %u   Page: %u/%u   Showing: %u-%u",
+        (UINT32)Count, (UINT32)Page, (UINT32)PageCount, (UINT32)ShowStart, (UINT32)ShowEnd);
+  if (Sync != NULL) {
+    if (!Sync->Done) {
+      Print(L"   Cached catalog, validating (%u walked)", (UINT32)Sync->Walked);
+    } else if (EFI_ERROR(Sync->Status)) {
+      Print(L"   Validation stopped: %r", Sync->Status);
+    } else {
+      Print(L"   Validated: ");
+      SetTextAttr(EFI_YELLOW);    Print(L"changed ");
+      SetTextAttr(EFI_LIGHTCYAN); Print(L"new ");
+      SetTextAttr(EFI_LIGHTRED);  Print(L"deleted");
+      SetTextAttr(EFI_LIGHTGRAY);
+    }
+  }
+  Print(L"\nKeys: Up/Down  PgUp/PgDn  Home/End  Enter open  E edit  ESC exit\n");
+}
+
+// GetNextVariableName calls per idle poll while the cached list is checked
+#define CATALOG_SYNC_STEPS  16
+
+STATIC VOID
+DoListAll(VOID)
+{
+  EFI_STATUS Status;
+  VAR_CATALOG Catalog;
+
+  UINTN Cols = 0, Rows = 0;
+  UINTN PageRows = 15; // fallback
+  UINTN Top = 0;
+  UINTN Sel = 0;
+  VAR_CATALOG_SYNC Sync;
+  BOOLEAN Syncing = FALSE;
+
+  // first page from the cache file, validated while waiting for keys
+  if (mCatalogCacheEnabled && !EFI_ERROR(VarCatalogLoad(VAR_CATALOG_CACHE_FILE, &Catalog))) {
+    Syncing = !EFI_ERROR(VarCatalogSyncStart(&Sync));
+    Status = EFI_SUCCESS;
+  } else {
+    Status = CollectAllVariables(&Catalog);
+    if (!EFI_ERROR(Status) && mCatalogCacheEnabled) {
+      VarCatalogSave(VAR_CATALOG_CACHE_FILE, &Catalog);
+    }
+  }
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Collect variables failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  if (!EFI_ERROR(GetConsoleSize(&Cols, &Rows)) && Rows > 10) {
+    // header: 3 lines + header row(1) + footer(3) => about 7
+    // keep safe margins
+    UINTN usable = Rows > 9 ? (Rows - 9) : 10;
+    PageRows = (usable < 5) ? 5 : usable;
+  }
+
+  while (TRUE) {
+    // adjust Top so Sel always visible
+    if (Sel < Top) Top = Sel;
+    if (Sel >= Top + PageRows) Top = Sel - (PageRows - 1);
+
+    DrawListAllTable(&Catalog, Top, Sel, PageRows, Syncing ? &Sync : NULL);
+
+    EFI_INPUT_KEY Key;
+    BOOLEAN Redraw = FALSE;
+    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+      BOOLEAN Changed;
+
+      if (!Syncing || Sync.Done) {
+        gBS->Stall(1000);
+        continue;
+      }
+
+      // idle: a few validation steps, redraw only when rows change
+      VarCatalogSyncStep(&Sync, &Catalog, CATALOG_SYNC_STEPS, &Changed);
+      if (Sync.Done) {
+        if (!EFI_ERROR(Sync.Status)) {
+          VarCatalogSave(VAR_CATALOG_CACHE_FILE, &Catalog);
+        }
+        Redraw = TRUE;
+        break;
+      }
+      if (Changed) {
+        Redraw = TRUE;
+        break;
+      }
+    }
+    if (Redraw) continue;
+
+    if (Key.ScanCode == SCAN_ESC) {
+      break;
+    }
+
+    if (Key.ScanCode == SCAN_UP) {
+      if (Sel > 0) Sel--;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_DOWN) {
+      if (Catalog.Count > 0 && Sel + 1 < Catalog.Count) Sel++;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_PAGE_UP) {
+      if (Sel >= PageRows) Sel -= PageRows;
+      else Sel = 0;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_PAGE_DOWN) {
+      if (Catalog.Count == 0) continue;
+      if (Sel + PageRows < Catalog.Count) Sel += PageRows;
+      else Sel = Catalog.Count - 1;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_HOME) {
+      Sel = 0;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_END) {
+      if (Catalog.Count > 0) Sel = Catalog.Count - 1;
+      continue;
+    }
+
+    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
+      if (Catalog.Count > 0) ShowVariableDetail(VarCatalogName(&Catalog, Sel), VAR_CATALOG_GUID(&Catalog, Sel));
+      continue;
+    }
+
+    if (Key.UnicodeChar == L'e' || Key.UnicodeChar == L'E') {
+      if (Catalog.Count > 0) {
+        UINTN DataSize = 0;
+        EditVariable(VarCatalogName(&Catalog, Sel), VAR_CATALOG_GUID(&Catalog, Sel));
+        GetVariableDataSizeQuick(VarCatalogName(&Catalog, Sel), VAR_CATALOG_GUID(&Catalog, Sel), &DataSize, &Catalog.Attributes[Sel]);
+        Catalog.DataSize[Sel] = (UINT32)DataSize;
+      }
+      continue;
+    }
+  }
+
+  if (Syncing) VarCatalogSyncAbort(&Sync);
+  FreeAllVariables(&Catalog);
+}
+
+STATIC VOID
+DoSearchByName(VOID)
+{
+  CHAR16 Name[LINE_MAX_CHARS];
+  EFI_STATUS Status;
+  UINTN Found = 0;
+
+  ClearScreen();
+  Print(L"Variable name: ");
+  ReadLine(Name, LINE_MAX_CHARS);
+
+  Print(L"\n");
+  Status = ListOrFilterVariablesDetailed(TRUE, Name, FALSE, NULL, &Found);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Search failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    Print(L"Number of variables found: %u\n", (UINT32)Found);
+  }
+  WaitAnyKey();
+}
+
+STATIC EFI_STATUS
+PromptVendorGuidMasked(IN EFI_GUID *DefaultGuid, OUT EFI_GUID *OutGuid)
+{
+  CHAR16 GuidMaskStr[64]; // need >= 37
+  EFI_STATUS Status;
+
+  if (DefaultGuid == NULL || OutGuid == NULL) return EFI_INVALID_PARAMETER;
+
+  Print(L"Vendor GUID (leave empty to use default): ");
+
+  Status = ReadGuidMaskedLine(GuidMaskStr, sizeof(GuidMaskStr)/sizeof(GuidMaskStr[0]));
+  if (Status == EFI_NOT_READY) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"GUID not complete. Please fill all hex digits.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    return EFI_INVALID_PARAMETER;
+  }
+  if (EFI_ERROR(Status)) return Status;
+
+  if (GuidMaskStr[0] == L'\0') {
+    CopyMem(OutGuid, DefaultGuid, sizeof(EFI_GUID));
+    return EFI_SUCCESS;
+  }
+
+  Status = ParseGuidString(GuidMaskStr, OutGuid);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Invalid GUID format.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC VOID
+DoSearchByGuid(IN EFI_GUID *DefaultGuid)
+{
+  EFI_GUID Guid;
+  EFI_STATUS Status;
+  UINTN Found = 0;
+
+  ClearScreen();
+  Print(L"Search variables by vendor GUID\n\n");
+
+  Status = PromptVendorGuidMasked(DefaultGuid, &Guid);
+  if (EFI_ERROR(Status)) {
+    WaitAnyKey();
+    return;
+  }
+
+  Print(L"\n");
+  Status = ListOrFilterVariablesDetailed(FALSE, NULL, TRUE, &Guid, &Found);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Search failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    Print(L"Number of variables found: %u\n", (UINT32)Found);
+  }
+  WaitAnyKey();
+}
+
+STATIC VOID
+DoDeleteVariable(VOID)
+{
+  CHAR16 Name[LINE_MAX_CHARS];
+  EFI_GUID Guid;
+  EFI_STATUS Status;
+
+  ClearScreen();
+  Print(L"Delete variable\n\n");
+
+  Print(L"Variable name to delete: ");
+  ReadLine(Name, LINE_MAX_CHARS);
+
+  Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
+  if (EFI_ERROR(Status)) {
+    WaitAnyKey();
+    return;
+  }
+
+  // Delete: Attributes=0, DataSize=0, Data=NULL
+  Status = VarSetVariable(Name, &Guid, 0, 0, NULL);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Delete failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"Deleted OK.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+  }
+
+  WaitAnyKey();
+}
+
+// Bulk delete from one catalog walk: name pattern ('*', '?', '#') and an
+// optional vendor GUID, previewed and confirmed once.
+#define DELETE_PREVIEW_ROWS  10
+
+// Only * and ?: nothing in the pattern narrows it to particular names.
+STATIC BOOLEAN
+PatternHasNoLiteral(IN CONST CHAR16 *Pattern)
+{
+  for (; *Pattern != L'\0'; Pattern++) {
+    if (*Pattern != L'*' && *Pattern != L'?') return FALSE;
+  }
+  return TRUE;
+}
+
+STATIC VOID
+DoDeleteByPattern(VOID)
+{
+  CHAR16 Pattern[LINE_MAX_CHARS];
+  CHAR16 Line[LINE_MAX_CHARS];
+  EFI_GUID Guid;
+  BOOLEAN AnyGuid;
+  EFI_STATUS Status;
+  VAR_CATALOG Catalog;
+  UINT16 GuidIndex = VAR_GUID_INDEX_NONE;
+  UINTN *Match = NULL;
+  UINTN Matched = 0;
+  UINTN Deleted = 0, Failed = 0;
+
+  ClearScreen();
+  Print(L"Delete variables by pattern\n\n");
+
+  Print(L"Name pattern (* any, ? one char, # hex digit; empty = *): ");
+  ReadLine(Pattern, LINE_MAX_CHARS);
+  if (Pattern[0] == L'\0') {
+    StrCpyS(Pattern, LINE_MAX_CHARS, L"*");
+  }
+
+  Print(L"Limit to one vendor GUID? [Y/n]: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  AnyGuid = (CharToUpper(Line[0]) == L'N');
+  if (!AnyGuid) {
+    Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
+    if (EFI_ERROR(Status)) {
+      WaitAnyKey();
+      return;
+    }
+  } else if (PatternHasNoLiteral(Pattern)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Refusing to delete every variable of every vendor.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  Status = CollectAllVariables(&Catalog);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Collect variables failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  Match = AllocatePool(MAX(Catalog.Count, 1) * sizeof(UINTN));
+  if (Match == NULL) {
+    FreeAllVariables(&Catalog);
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Out of memory.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  // the vendor filter is one integer compare per entry; a GUID no entry
+  // has matches nothing
+  if (!AnyGuid) GuidIndex = VarCatalogFindGuid(&Catalog, &Guid);
+  for (UINTN i = 0; i < Catalog.Count && (AnyGuid || GuidIndex != VAR_GUID_INDEX_NONE); i++) {
+    if (!AnyGuid && Catalog.GuidIndex[i] != GuidIndex) continue;
+    if (!VarCatalogNameMatch(&Catalog, i, Pattern)) continue;
+    Match[Matched++] = i;
+  }
+
+  // the same refusal for a pattern that happens to match every name
+  if (AnyGuid && Matched > 0 && Matched == Catalog.Count) {
+    FreePool(Match);
+    FreeAllVariables(&Catalog);
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"\nPattern matches all %u variables; refusing to delete every variable of every vendor.\n",
+          (UINT32)Matched);
+    SetTextAttr(EFI_LIGHTGRAY);
+    WaitAnyKey();
+    return;
+  }
+
+  Print(L"\n%u of %u variable(s) match:\n", (UINT32)Matched, (UINT32)Catalog.Count);
+  for (UINTN m = 0; m < Matched && m < DELETE_PREVIEW_ROWS; m++) {
+    Print(L"  %-35s %g\n", VarCatalogName(&Catalog, Match[m]), VAR_CATALOG_GUID(&Catalog, Match[m]));
+  }
+  if (Matched > DELETE_PREVIEW_ROWS) {
+    Print(L"  ... and %u more\n", (UINT32)(Matched - DELETE_PREVIEW_ROWS));
+  }
+
+  if (Matched > 0) {
+    SetTextAttr(EFI_YELLOW);
+    Print(L"\nDelete %u variable(s)? [y/N]: ", (UINT32)Matched);
+    SetTextAttr(EFI_LIGHTGRAY);
+    ReadLine(Line, LINE_MAX_CHARS);
+
+    if (CharToUpper(Line[0]) == L'Y') {
+      for (UINTN m = 0; m < Matched; m++) {
+        CHAR16 *Name = VarCatalogName(&Catalog, Match[m]);
+        Status = VarSetVariable(Name, VAR_CATALOG_GUID(&Catalog, Match[m]), 0, 0, NULL);
+        if (EFI_ERROR(Status)) {
+          if (Failed++ < DELETE_PREVIEW_ROWS) {
+            SetTextAttr(EFI_LIGHTRED);
+            Print(L"  %s: %r\n", Name, Status);
+            SetTextAttr(EFI_LIGHTGRAY);
+          }
+        } else {
+          Deleted++;
+        }
+      }
+      SetTextAttr(Failed ? EFI_YELLOW : EFI_LIGHTGREEN);
+      Print(L"Deleted %u, failed %u.\n", (UINT32)Deleted, (UINT32)Failed);
+      SetTextAttr(EFI_LIGHTGRAY);
+    } else {
+      Print(L"Nothing deleted.\n");
+    }
+  }
+
+  FreePool(Match);
+  FreeAllVariables(&Catalog);
+  WaitAnyKey();
+}
+
+// Show the store usage the write would leave; refuse writes that cannot
+// fit and ask before ones likely to force a reclaim.
+STATIC BOOLEAN
+ConfirmSpace(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attr, IN UINTN DataSize)
+{
+  VAR_SPACE_CHECK Check;
+  CHAR16 Line[LINE_MAX_CHARS];
+
+  if ((Attr & EFI_VARIABLE_NON_VOLATILE) == 0) return TRUE;
+
+  if (VarSpaceCheck(Name, Guid, Attr, DataSize, &Check) == VarSpaceUnknown) {
+    return TRUE;
+  }
+
+  Print(L"NV store: %lu of %lu bytes free, this write needs ~%lu and frees ~%lu\n",
+        Check.Remaining, Check.MaxStorage, Check.Needed, Check.Freed);
+
+  switch (Check.Verdict) {
+    case VarSpaceTooLarge:
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"Larger than the maximum variable size (%lu bytes).\n", Check.MaxVariableSize);
+      SetTextAttr(EFI_LIGHTGRAY);
+      return FALSE;
+
+    case VarSpaceNoRoom:
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"Not enough variable storage left.\n");
+      SetTextAttr(EFI_LIGHTGRAY);
+      return FALSE;
+
+    case VarSpaceLow:
+      SetTextAttr(EFI_YELLOW);
+      Print(L"Store nearly full: this write may force a reclaim. Continue? [y/N]: ");
+      SetTextAttr(EFI_LIGHTGRAY);
+      ReadLine(Line, LINE_MAX_CHARS);
+      return (CharToUpper(Line[0]) == L'Y');
+
+    default:
+      return TRUE;
+  }
+}
+
+STATIC CONST struct {
+  CHAR16          Key;
+  VAR_INPUT_TYPE  Type;
+} mInputTypeKeys[] = {
+  { L's', VarInputUtf16  },
+  { L'a', VarInputAscii  },
+  { L'h', VarInputHex    },
+  { L'1', VarInputUint8  },
+  { L'2', VarInputUint16 },
+  { L'4', VarInputUint32 },
+  { L'8', VarInputUint64 },
+  { L'f', VarInputFile   },
+};
+
+// Ask for the value type and the value itself; returns a pool buffer.
+STATIC EFI_STATUS
+PromptTypedValue(OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  CHAR16 Line[LINE_MAX_CHARS];
+  CHAR16 *Value;
+  VAR_INPUT_TYPE Type = VarInputUtf16;
+  EFI_STATUS Status;
+
+  Print(L"Value type: [S]tring UTF-16 / [A]SCII / [H]ex bytes /\n");
+  Print(L"            UINT[1]/[2]/[4]/[8] bytes (little-endian) / [F]ile: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  for (UINTN i = 0; i < ARRAY_SIZE(mInputTypeKeys); i++) {
+    if (CharToUpper(Line[0]) == CharToUpper(mInputTypeKeys[i].Key)) {
+      Type = mInputTypeKeys[i].Type;
+      break;
+    }
+  }
+
+  Value = AllocateZeroPool(VALUE_MAX_CHARS * sizeof(CHAR16));
+  if (Value == NULL) return EFI_OUT_OF_RESOURCES;
+
+  switch (Type) {
+    case VarInputFile:   Print(L"Payload file path: "); break;
+    case VarInputHex:    Print(L"Hex bytes: "); break;
+    case VarInputUtf16:
+    case VarInputAscii:  Print(L"Value: "); break;
+    default:             Print(L"Value(s), decimal or 0x hex, space separated: "); break;
+  }
+  ReadLine(Value, VALUE_MAX_CHARS);
+
+  Status = VarParseTypedValue(Type, Value, Data, DataSize);
+  FreePool(Value);
+
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Invalid value: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  }
+  return Status;
+}
+
+STATIC VOID
+DoCreateVariable(VOID)
+{
+  CHAR16 Name[LINE_MAX_CHARS];
+  EFI_GUID Guid;
+  EFI_STATUS Status;
+  UINT8 *Data = NULL;
+  UINTN DataSize = 0;
+  UINTN OldSize = 0;
+  UINT32 OldAttr = 0;
+  CHAR16 Line[LINE_MAX_CHARS];
+
+  UINT32 Attr = EFI_VARIABLE_NON_VOLATILE |
+                EFI_VARIABLE_BOOTSERVICE_ACCESS |
+                EFI_VARIABLE_RUNTIME_ACCESS;
+
+  ClearScreen();
+  Print(L"Create new variable\n\n");
+
+  Print(L"New variable name: ");
+  ReadLine(Name, LINE_MAX_CHARS);
+
+  Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
+  if (EFI_ERROR(Status)) {
+    WaitAnyKey();
+    return;
+  }
+
+  // existing variable: appending writes only the new bytes
+  if (!EFI_ERROR(GetVariableDataSizeQuick(Name, &Guid, &OldSize, &OldAttr))) {
+    Print(L"Variable exists (%u bytes). [A]ppend or [R]eplace (default R): ", (UINT32)OldSize);
+    ReadLine(Line, LINE_MAX_CHARS);
+    if (CharToUpper(Line[0]) == L'A') {
+      Attr = OldAttr | EFI_VARIABLE_APPEND_WRITE;
+    }
+  }
+
+  Status = PromptTypedValue(&Data, &DataSize);
+  if (EFI_ERROR(Status)) {
+    WaitAnyKey();
+    return;
+  }
+
+  if (DataSize == 0) {
+    // a zero-length SetVariable would delete the variable instead
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Empty payload, nothing written.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    FreePool(Data);
+    WaitAnyKey();
+    return;
+  }
+
+  Print(L"Payload: %u byte(s)%s\n", (UINT32)DataSize, (Attr & EFI_VARIABLE_APPEND_WRITE) ? L" (append)" : L"");
+
+  if (!ConfirmSpace(Name, &Guid, Attr, DataSize)) {
+    Print(L"Nothing written.\n");
+    FreePool(Data);
+    WaitAnyKey();
+    return;
+  }
+
+  // whole payload in one SetVariable call
+  Status = VarSetVariable(Name, &Guid, Attr, DataSize, Data);
+  FreePool(Data);
+
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Create/Set failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"Create/Set OK.\n");
+    SetTextAttr(EFI_LIGHTGRAY);
+    if (Attr & EFI_VARIABLE_APPEND_WRITE) {
+      UINTN NewSize = 0;
+      GetVariableDataSizeQuick(Name, &Guid, &NewSize, NULL);
+      Print(L"Size: %u -> %u bytes\n", (UINT32)OldSize, (UINT32)NewSize);
+    }
+  }
+
+  WaitAnyKey();
+}
+
+// =============================
+// Signed .auth payloads (Secure Boot provisioning)
+// =============================
+STATIC EFI_STATUS
+WriteAuthFile(IN CHAR16 *Name, IN EFI_GUID *Guid, IN CHAR16 *Path, IN BOOLEAN Append)
+{
+  EFI_STATUS Status;
+  EFI_TIME Signed;
+  UINTN PayloadSize = 0;
+
+  ZeroMem(&Signed, sizeof(Signed));
+  Status = VarWriteAuthFile(Name, Guid, Path, Append, &Signed, &PayloadSize);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    if (Status == EFI_COMPROMISED_DATA || Status == EFI_BAD_BUFFER_SIZE) {
+      Print(L"%s is not an EFI_VARIABLE_AUTHENTICATION_2 payload.\n", Path);
+    } else if (Status == EFI_SECURITY_VIOLATION) {
+      Print(L"Firmware rejected the signature or timestamp: %r\n", Status);
+    } else {
+      Print(L"%s %s failed: %r\n", Append ? L"Append" : L"Write", Name, Status);
+    }
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"%s %s OK: %u payload byte(s), signed %04u-%02u-%02u %02u:%02u:%02u\n",
+        Append ? L"Appended to" : L"Wrote", Name, (UINT32)PayloadSize,
+        Signed.Year, Signed.Month, Signed.Day, Signed.Hour, Signed.Minute, Signed.Second);
+  SetTextAttr(EFI_LIGHTGRAY);
+  return EFI_SUCCESS;
+}
+
+STATIC VOID
+DoWriteAuthFile(VOID)
+{
+  CHAR16 Name[LINE_MAX_CHARS];
+  CHAR16 Path[LINE_MAX_CHARS];
+  CHAR16 Line[LINE_MAX_CHARS];
+  EFI_GUID Guid;
+  BOOLEAN CanAppend = FALSE;
+  BOOLEAN Append = FALSE;
+  EFI_STATUS Status;
+
+  ClearScreen();
+  Print(L"Write signed .auth payload (time-based authenticated variable)\n\n");
+
+  Print(L"Variable name (PK, KEK, db, dbx, dbt or other): ");
+  ReadLine(Name, LINE_MAX_CHARS);
+  if (Name[0] == L'\0') return;
+
+  if (VarAuthLookupTarget(Name, &Guid, &CanAppend)) {
+    Print(L"Vendor GUID: ");
+    PrintGuidLine(&Guid);
+    Print(L"\n");
+  } else {
+    Status = PromptVendorGuidMasked(&mDefaultVendorGuid, &Guid);
+    if (EFI_ERROR(Status)) {
+      WaitAnyKey();
+      return;
+    }
+    CanAppend = TRUE;
+  }
+
+  Print(L".auth file path: ");
+  ReadLine(Path, LINE_MAX_CHARS);
+  if (Path[0] == L'\0') return;
+
+  if (CanAppend) {
+    Print(L"[A]ppend or [R]eplace (default A): ");
+    ReadLine(Line, LINE_MAX_CHARS);
+    Append = (CharToUpper(Line[0]) != L'R');
+  }
+
+  Print(L"\n");
+  WriteAuthFile(Name, &Guid, Path, Append);
+  WaitAnyKey();
+}
+
+// =============================
+// Batch apply from a plan file (all or nothing)
+// =============================
+#define DEFAULT_PLAN_FILE  L"\\VarPlan.txt"
+
+STATIC CONST CHAR16 *mOpVerbs[] = { L"set", L"append", L"delete" };
+
+STATIC EFI_STATUS
+ApplyPlanFile(IN CHAR16 *Path)
+{
+  EFI_STATUS Status;
+  VAR_OP *Ops = NULL;
+  UINTN Count = 0;
+  UINTN ErrorLine = 0;
+  VAR_APPLY_RESULT Result;
+  VAR_SPACE_CHECK Space;
+
+  Status = VarLoadPlan(Path, &mDefaultVendorGuid, &Ops, &Count, &ErrorLine);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    if (ErrorLine != 0) {
+      Print(L"%s line %u: %r\n", Path, (UINT32)ErrorLine, Status);
+    } else {
+      Print(L"Load %s failed: %r\n", Path, Status);
+    }
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+
+  // projected NV usage for the whole plan, before anything is written
+  if (VarSpaceProjectPlan(Ops, Count, &Space) != VarSpaceUnknown) {
+    Print(L"NV store: %lu of %lu bytes free; plan adds ~%lu, frees ~%lu\n",
+          Space.Remaining, Space.MaxStorage, Space.Needed, Space.Freed);
+    if (Space.Verdict >= VarSpaceNoRoom) {
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"%s: plan not applied, nothing written.\n",
+            (Space.Verdict == VarSpaceTooLarge) ? L"A variable exceeds the maximum size" : L"Not enough variable storage");
+      SetTextAttr(EFI_LIGHTGRAY);
+      VarFreeOps(Ops, Count);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    if (Space.Verdict == VarSpaceLow) {
+      SetTextAttr(EFI_YELLOW);
+      Print(L"Store nearly full after this plan: a reclaim is likely on the next boot.\n");
+      SetTextAttr(EFI_LIGHTGRAY);
+    }
+  }
+
+  Print(L"Applying %u operation(s) from %s\n\n", (UINT32)Count, Path);
+  Status = VarApplyOps(Ops, Count, &Result);
+
+  for (UINTN i = 0; i < Count; i++) {
+    SetTextAttr(EFI_ERROR(Ops[i].Status) && Ops[i].Status != EFI_NOT_STARTED ? EFI_LIGHTRED : EFI_LIGHTGRAY);
+    Print(L"%-6s %-30s %g  %r", mOpVerbs[Ops[i].Kind], Ops[i].Name, &Ops[i].Guid, Ops[i].Status);
+    if (Ops[i].RestoreStatus != EFI_NOT_STARTED) {
+      Print(L"  restore: %r", Ops[i].RestoreStatus);
+    }
+    Print(L"\n");
+  }
+
+  if (!EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"\nApplied %u operation(s)", (UINT32)Result.Applied);
+  } else if (Result.FailedIndex < Count) {
+    SetTextAttr(Result.RestoreErrors ? EFI_LIGHTRED : EFI_YELLOW);
+    Print(L"\nOperation %u failed (%r), rolled back %u write(s), %u restore error(s)",
+          (UINT32)Result.FailedIndex + 1, Status, (UINT32)Result.RolledBack, (UINT32)Result.RestoreErrors);
+  } else {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"\nSnapshot failed (%r), nothing written", Status);
+  }
+  if (Result.ElapsedNs == VAR_ELAPSED_UNKNOWN) {
+    Print(L" (time unavailable)\n");
+  } else {
+    Print(L" in %lu.%03lu ms\n", DivU64x32(Result.ElapsedNs, 1000000), DivU64x32(Result.ElapsedNs, 1000) % 1000);
+  }
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  VarFreeOps(Ops, Count);
+  return Status;
+}
+
+STATIC VOID
+DoApplyPlan(VOID)
+{
+  CHAR16 Path[LINE_MAX_CHARS];
+
+  ClearScreen();
+  Print(L"Apply batch file (rolls back on failure)\n\n");
+  Print(L"Lines: set <name> <guid|*> <attr|*> <type>:<value>\n");
+  Print(L"       append <name> <guid|*> <type>:<value>\n");
+  Print(L"       delete <name> <guid|*>\n");
+  Print(L"Types: str ascii hex u8 u16 u32 u64 file   Attr: NV|BS|RT|HR|AT or 0x..\n\n");
+
+  Print(L"Plan file (leave empty for %s): ", DEFAULT_PLAN_FILE);
+  ReadLine(Path, LINE_MAX_CHARS);
+  if (Path[0] == L'\0') {
+    StrCpyS(Path, LINE_MAX_CHARS, DEFAULT_PLAN_FILE);
+  }
+
+  Print(L"\n");
+  ApplyPlanFile(Path);
+  WaitAnyKey();
+}
+
+// =============================
+// Change watcher
+// =============================
+#define DEFAULT_WATCH_INTERVAL_MS  1000
+
+STATIC EFI_STATUS
+WatchVariables(IN UINTN IntervalMs, IN CHAR16 *LogPath OPTIONAL)
+{
+  EFI_STATUS Status;
+  VAR_WRITER Log;
+  VAR_WATCH_STATS Stats;
+
+  if (LogPath != NULL) {
+    Status = VarWriterOpenFile(&Log, LogPath);
+  } else {
+    Status = VarWriterOpenConsole(&Log);
+  }
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Open %s failed: %r\n", LogPath != NULL ? LogPath : L"console", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+
+  if (LogPath != NULL) {
+    Print(L"Logging changes to %s, ESC to stop\n", LogPath);
+  }
+
+  ZeroMem(&Stats, sizeof(Stats));
+  Status = VarWatch(&Log, IntervalMs, &Stats);
+  if (!EFI_ERROR(Status)) {
+    Status = VarWriterClose(&Log);
+  } else {
+    VarWriterClose(&Log);
+  }
+
+  SetTextAttr(EFI_ERROR(Status) ? EFI_LIGHTRED : EFI_LIGHTGREEN);
+  Print(L"\n%u poll(s): %u created, %u deleted, %u modified; %u payload read(s) for %u variables (%r)\n",
+        (UINT32)Stats.Polls, (UINT32)Stats.Created, (UINT32)Stats.Deleted, (UINT32)Stats.Modified,
+        (UINT32)Stats.Reads, (UINT32)Stats.Baseline, Status);
+  SetTextAttr(EFI_LIGHTGRAY);
+  return Status;
+}
+
+STATIC VOID
+DoWatch(VOID)
+{
+  CHAR16 Line[LINE_MAX_CHARS];
+  UINTN IntervalMs;
+
+  ClearScreen();
+  Print(L"Watch for variable changes\n\n");
+
+  Print(L"Poll interval in ms (leave empty for %u): ", DEFAULT_WATCH_INTERVAL_MS);
+  ReadLine(Line, LINE_MAX_CHARS);
+  IntervalMs = (Line[0] == L'\0') ? DEFAULT_WATCH_INTERVAL_MS : StrDecimalToUintn(Line);
+
+  Print(L"\n");
+  WatchVariables(IntervalMs, NULL);
+  WaitAnyKey();
+}
+
+// =============================
+// Dump all variables to a file
+// =============================
+#define DEFAULT_DUMP_FILE  L"\\VarDump.txt"
+#define DEFAULT_JSON_FILE  L"\\VarCatalog.json"
+#define DEFAULT_CSV_FILE   L"\\VarCatalog.csv"
+
+STATIC EFI_STATUS
+DumpAllToFile(IN CHAR16 *Path)
+{
+  EFI_STATUS Status;
+  VAR_WRITER Writer;
+  UINTN Count = 0;
+
+  Status = VarWriterOpenFile(&Writer, Path);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Open %s failed: %r\n", Path, Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+
+  Status = VarDumpAll(&Writer, &Count);
+  if (!EFI_ERROR(Status)) {
+    Status = VarWriterClose(&Writer);
+  } else {
+    VarWriterClose(&Writer);
+  }
+
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Dump failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"Dumped %u variables (%lu bytes) to %s\n", (UINT32)Count, Writer.Total, Path);
+    SetTextAttr(EFI_LIGHTGRAY);
+  }
+  return Status;
+}
+
+STATIC VOID
+DoDumpAll(VOID)
+{
+  CHAR16 Path[LINE_MAX_CHARS];
+
+  ClearScreen();
+  Print(L"Dump all variables to file\n\n");
+
+  Print(L"Output file (leave empty for %s): ", DEFAULT_DUMP_FILE);
+  ReadLine(Path, LINE_MAX_CHARS);
+  if (Path[0] == L'\0') {
+    StrCpyS(Path, LINE_MAX_CHARS, DEFAULT_DUMP_FILE);
+  }
+
+  DumpAllToFile(Path);
+  WaitAnyKey();
+}
+
+// =============================
+// Export catalog as JSON/CSV
+// Path == NULL writes to the console (batch mode / shell redirection).
+// =============================
+STATIC EFI_STATUS
+ExportCatalog(IN VAR_EXPORT_FORMAT Format, IN UINT32 Flags, IN CHAR16 *Path OPTIONAL)
+{
+  EFI_STATUS Status;
+  VAR_CATALOG Catalog;
+  UINTN Count;
+  VAR_WRITER Writer;
+
+  Status = CollectAllVariables(&Catalog);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Collect variables failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+  Count = Catalog.Count;
+
+  Status = (Path != NULL) ? VarWriterOpenFile(&Writer, Path) : VarWriterOpenConsole(&Writer);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Open %s failed: %r\n", (Path != NULL) ? Path : L"console", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    FreeAllVariables(&Catalog);
+    return Status;
+  }
+
+  VarExportCatalog(&Writer, &Catalog, Format, Flags);
+  Status = VarWriterClose(&Writer);
+  FreeAllVariables(&Catalog);
+
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Export failed: %r\n", Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+  } else if (Path != NULL) {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"Exported %u variables (%lu bytes) to %s\n", (UINT32)Count, Writer.Total, Path);
+    SetTextAttr(EFI_LIGHTGRAY);
+  }
+  return Status;
+}
+
+STATIC VOID
+DoExport(VOID)
+{
+  CHAR16 Line[LINE_MAX_CHARS];
+  CHAR16 Path[LINE_MAX_CHARS];
+  VAR_EXPORT_FORMAT Format;
+  UINT32 Flags = 0;
+
+  ClearScreen();
+  Print(L"Export variable catalog\n\n");
+
+  Print(L"Format [J]SON / [C]SV: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  Format = (Line[0] == L'c' || Line[0] == L'C') ? VarExportCsv : VarExportJson;
+
+  Print(L"Include SHA-256 hash? [y/N]: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  if (Line[0] == L'y' || Line[0] == L'Y') Flags |= VAR_EXPORT_HASH;
+
+  Print(L"Include data? [N]o / [H]ex / [B]ase64: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  if (Line[0] == L'h' || Line[0] == L'H') Flags |= VAR_EXPORT_HEX;
+  if (Line[0] == L'b' || Line[0] == L'B') Flags |= VAR_EXPORT_BASE64;
+
+  Print(L"Output file (leave empty for %s): ",
+        (Format == VarExportCsv) ? DEFAULT_CSV_FILE : DEFAULT_JSON_FILE);
+  ReadLine(Path, LINE_MAX_CHARS);
+  if (Path[0] == L'\0') {
+    StrCpyS(Path, LINE_MAX_CHARS, (Format == VarExportCsv) ? DEFAULT_CSV_FILE : DEFAULT_JSON_FILE);
+  }
+
+  ExportCatalog(Format, Flags, Path);
+  WaitAnyKey();
+}
+
+// =============================
+// Binary snapshot / restore
+// =============================
+#define DEFAULT_SNAPSHOT_FILE  L"\\VarSnap.vts"
+
+STATIC EFI_STATUS
+SnapshotToFile(IN CHAR16 *Path, IN UINT32 Flags)
+{
+  EFI_STATUS Status;
+  VAR_WRITER Writer;
+  VAR_SNAPSHOT_STATS Stats;
+
+  Status = VarWriterOpenFile(&Writer, Path);
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Open %s failed: %r\n", Path, Status);
+    SetTextAttr(EFI_LIGHTGRAY);
+    return Status;
+  }
+
+  Status = VarSnapshotSave(&Writer, Flags, &Stats);
+  if (!EFI_ERROR(Status)) {
+    Status = VarWriterClose(&Writer);
+  } else {
+    VarWriterClose(&Writer);
+  }
+
+  if (EFI_ERROR(Status)) {
+    SetTextAttr(EFI_LIGHTRED);
+    Print(L"Snapshot failed: %r\n", Status);
+  } else {
+    SetTextAttr(EFI_LIGHTGREEN);
+    Print(L"Saved %u variables to %s: %lu bytes of data stored in %lu (file %lu bytes, %u CPU(s))\n",
+          (UINT32)Stats.Count, Path, Stats.RawBytes, Stats.StoredBytes, Writer.Total, (UINT32)VarMpWorkerCount());
+    if (Stats.Skipped != 0) {
+      SetTextAttr(EFI_YELLOW);
+      Print(L"%u variable(s) could not be read and are not in the snapshot\n", (UINT32)Stats.Skipped);
+    }
+  }
+  SetTextAttr(EFI_LIGHTGRAY);
+  return Status;
+}
+
+STATIC EFI_STATUS
+RestoreSnapshot(IN CHAR16 *Path, IN BOOLEAN DryRun)
+{
+  EFI_STATUS Status;
+  VAR_WRITER Log;
+  VAR_SNAPSHOT_STATS Stats;
+
+  Status = VarWriterOpenConsole(&Log);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = VarSnapshotRestore(Path, DryRun, &Log, &Stats);
+  VarWriterClose(&Log);
+
+  SetTextAttr((EFI_ERROR(Status) || Stats.Failed != 0) ? EFI_LIGHTRED : EFI_LIGHTGREEN);
+  if (EFI_ERROR(Status)) {
+    Print(L"\nRestore from %s stopped after %u record(s): %r\n", Path, (UINT32)Stats.Count, Status);
+  }
+  Print(L"%u record(s): %u %a, %u unchanged, %u skipped, %u failed\n",
+        (UINT32)Stats.Count, (UINT32)Stats.Restored, DryRun ? "differ" : "restored",
+        (UINT32)Stats.Unchanged, (UINT32)Stats.Skipped, (UINT32)Stats.Failed);
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  if (!EFI_ERROR(Status) && Stats.Failed != 0) Status = EFI_DEVICE_ERROR;
+  return Status;
+}
+
+STATIC VOID
+DoSnapshot(VOID)
+{
+  CHAR16 Line[LINE_MAX_CHARS];
+  CHAR16 Path[LINE_MAX_CHARS];
+  EFI_TIME Now;
+
+  ClearScreen();
+  Print(L"Save binary snapshot\n\n");
+
+  // timestamped default so generations pile up side by side
+  ZeroMem(&Now, sizeof(Now));
+  if (!EFI_ERROR(gRT->GetTime(&Now, NULL))) {
+    UnicodeSPrint(Path, sizeof(Path), L"\\VarSnap-%04u%02u%02u-%02u%02u%02u.vts",
+                  Now.Year, Now.Month, Now.Day, Now.Hour, Now.Minute, Now.Second);
+  } else {
+    StrCpyS(Path, LINE_MAX_CHARS, DEFAULT_SNAPSHOT_FILE);
+  }
+
+  Print(L"Output file (leave empty for %s): ", Path);
+  ReadLine(Line, LINE_MAX_CHARS);
+  if (Line[0] != L'\0') {
+    StrCpyS(Path, LINE_MAX_CHARS, Line);
+  }
+
+  Print(L"Compress? [Y/n]: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+
+  Print(L"\n");
+  SnapshotToFile(Path, (Line[0] == L'n' || Line[0] == L'N') ? 0 : VAR_SNAPSHOT_COMPRESS);
+  WaitAnyKey();
+}
+
+STATIC VOID
+DoRestore(VOID)
+{
+  CHAR16 Line[LINE_MAX_CHARS];
+  CHAR16 Path[LINE_MAX_CHARS];
+
+  ClearScreen();
+  Print(L"Restore binary snapshot\n\n");
+
+  Print(L"Snapshot file (leave empty for %s): ", DEFAULT_SNAPSHOT_FILE);
+  ReadLine(Path, LINE_MAX_CHARS);
+  if (Path[0] == L'\0') {
+    StrCpyS(Path, LINE_MAX_CHARS, DEFAULT_SNAPSHOT_FILE);
+  }
+
+  // compare first, write only after confirmation
+  Print(L"\n");
+  if (EFI_ERROR(RestoreSnapshot(Path, TRUE))) {
+    WaitAnyKey();
+    return;
+  }
+
+  Print(L"\nWrite the differing variables? [y/N]: ");
+  ReadLine(Line, LINE_MAX_CHARS);
+  if (Line[0] == L'y' || Line[0] == L'Y') {
+    Print(L"\n");
+    RestoreSnapshot(Path, FALSE);
+  }
+  WaitAnyKey();
+}
+
+// =============================
+// Main menu
+// =============================
+typedef struct {
+  CONST CHAR16  *Text;
+  VOID          (*Handler)(VOID);   // NULL => exit
+} MENU_ENTRY;
+
+STATIC VOID
+DoSearchByDefaultGuid(VOID)
+{
+  DoSearchByGuid(&mDefaultVendorGuid);
+}
+
+STATIC CONST MENU_ENTRY mMenu[] = {
+  { L"List all variables",              DoListAll },
+  { L"Search variables by name",        DoSearchByName },
+  { L"Search variables by vendor GUID", DoSearchByDefaultGuid },
+  { L"Create new variable",             DoCreateVariable },
+  { L"Delete variable",                 DoDeleteVariable },
+  { L"Delete variables by pattern",     DoDeleteByPattern },
+  { L"Apply batch file (rollback)",     DoApplyPlan },
+  { L"Write signed .auth payload",      DoWriteAuthFile },
+  { L"Watch for changes",               DoWatch },
+  { L"Dump all variables to file",      DoDumpAll },
+  { L"Export catalog (JSON/CSV)",       DoExport },
+  { L"Save binary snapshot",            DoSnapshot },
+  { L"Restore binary snapshot",         DoRestore },
+  { L"Exit",                            NULL },
+};
+
+STATIC VOID
+ShowMenu(IN UINTN Sel)
+{
+  VAR_CACHE_STATS Stats;
+
+  ClearScreen();
+
+  SetTextAttr(EFI_LIGHTGREEN);
+  Print(L"Default Vendor GUID: ");
+  PrintGuidLine(&mDefaultVendorGuid);
+  Print(L"\n");
+  Print(L"Variable Application\n\n");
+  SetTextAttr(EFI_LIGHTGRAY);
+
+  for (UINTN i = 0; i < ARRAY_SIZE(mMenu); i++) {
+    if (i == Sel) {
+      SetTextAttr(EFI_WHITE | EFI_BACKGROUND_BLUE);
+    } else {
+      SetTextAttr(EFI_LIGHTGRAY);
+    }
+    Print(L"%s\n", mMenu[i].Text);
+  }
+
+  SetTextAttr(EFI_LIGHTGRAY);
+  Print(L"\nUse Up/Down and Enter.\n");
+
+  VarCacheGetStats(&Stats);
+  Print(L"Payload cache: %u hits  %u misses  %u evictions  %u/%u KiB\n",
+        (UINT32)Stats.Hits, (UINT32)Stats.Misses, (UINT32)Stats.Evictions,
+        (UINT32)(Stats.Bytes / SIZE_1KB), (UINT32)(Stats.Limit / SIZE_1KB));
+  Print(L"Variables read through: %s\n", gVarBackend->Description);
+}
+
+// =============================
+// Command line (when started from the UEFI Shell)
+//   -cache <KiB>   payload cache limit, 0 disables caching
+//   -cpus <n>      processors used for hashing/compression, 1 = BSP only
+//   -guids <file>  vendor GUID names (default VAR_GUID_NAMES_FILE if present)
+//   -catcache      start List All from VAR_CATALOG_CACHE_FILE, checked while idle
+//   -flash         enumerate and read NV variables from the memory-mapped
+//                  store (VarFlash.c); volatile ones, and all of them if it
+//                  cannot be used, through runtime services
+//   -dump <file>   dump all variables to <file> and exit
+//   -export json|csv [-hash] [-data hex|base64] [-o <file>]
+//                  export the catalog to <file> (default: console) and exit
+//   -snapshot <file> [-raw]
+//                  save a (compressed) binary snapshot and exit
+//   -restore <file> [-dryrun]
+//                  write variables that differ from <file> and exit
+//   -apply <file>  apply a batch plan, rolled back on any failure, and exit
+//   -auth <name> <file> [-append]
+//                  write <name> from a signed .auth file and exit
+//   -watch <ms> [-o <file>]
+//                  log variable changes every <ms> until ESC, then exit
+// Returns TRUE when a batch command ran and the tool should exit.
+// =============================
+STATIC BOOLEAN
+ParseCommandLine(IN EFI_HANDLE ImageHandle, OUT EFI_STATUS *BatchStatus)
+{
+  EFI_STATUS Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL *Params = NULL;
+  CHAR16 *DumpPath = NULL;
+  CHAR16 *PlanPath = NULL;
+  CHAR16 *AuthName = NULL;
+  CHAR16 *AuthPath = NULL;
+  BOOLEAN AuthAppend = FALSE;
+  UINTN WatchMs = 0;
+  CHAR16 *SnapPath = NULL;
+  CHAR16 *RestorePath = NULL;
+  UINT32 SnapFlags = VAR_SNAPSHOT_COMPRESS;
+  BOOLEAN DryRun = FALSE;
+  CHAR16 *OutPath = NULL;
+  BOOLEAN Export = FALSE;
+  VAR_EXPORT_FORMAT Format = VarExportJson;
+  UINT32 Flags = 0;
+  BOOLEAN Flash = FALSE;
+
+  *BatchStatus = EFI_SUCCESS;
+
+  Status = gBS->HandleProtocol(ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **)&Params);
+  if (EFI_ERROR(Status) || Params == NULL) {
+    return FALSE;
+  }
+
+  for (UINTN i = 1; i < Params->Argc; i++) {
+    if (StrCmp(Params->Argv[i], L"-cache") == 0 && i + 1 < Params->Argc) {
+      VarCacheSetLimit(StrDecimalToUintn(Params->Argv[++i]) * SIZE_1KB);
+    } else if (StrCmp(Params->Argv[i], L"-cpus") == 0 && i + 1 < Params->Argc) {
+      VarMpSetLimit(StrDecimalToUintn(Params->Argv[++i]));
+    } else if (StrCmp(Params->Argv[i], L"-auth") == 0 && i + 2 < Params->Argc) {
+      AuthName = Params->Argv[++i];
+      AuthPath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-append") == 0) {
+      AuthAppend = TRUE;
+    } else if (StrCmp(Params->Argv[i], L"-watch") == 0 && i + 1 < Params->Argc) {
+      WatchMs = StrDecimalToUintn(Params->Argv[++i]);
+    } else if (StrCmp(Params->Argv[i], L"-apply") == 0 && i + 1 < Params->Argc) {
+      PlanPath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-snapshot") == 0 && i + 1 < Params->Argc) {
+      SnapPath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-raw") == 0) {
+      SnapFlags &= ~VAR_SNAPSHOT_COMPRESS;
+    } else if (StrCmp(Params->Argv[i], L"-restore") == 0 && i + 1 < Params->Argc) {
+      RestorePath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-dryrun") == 0) {
+      DryRun = TRUE;
+    } else if (StrCmp(Params->Argv[i], L"-guids") == 0 && i + 1 < Params->Argc) {
+      mGuidNamesPath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-catcache") == 0) {
+      mCatalogCacheEnabled = TRUE;
+    } else if (StrCmp(Params->Argv[i], L"-flash") == 0) {
+      Flash = TRUE;
+    } else if (StrCmp(Params->Argv[i], L"-dump") == 0 && i + 1 < Params->Argc) {
+      DumpPath = Params->Argv[++i];
+    } else if (StrCmp(Params->Argv[i], L"-export") == 0 && i + 1 < Params->Argc) {
+      Export = TRUE;
+      Format = (StrCmp(Params->Argv[++i], L"csv") == 0) ? VarExportCsv : VarExportJson;
+    } else if (StrCmp(Params->Argv[i], L"-hash") == 0) {
+      Flags |= VAR_EXPORT_HASH;
+    } else if (StrCmp(Params->Argv[i], L"-data") == 0 && i + 1 < Params->Argc) {
+      Flags |= (StrCmp(Params->Argv[++i], L"base64") == 0) ? VAR_EXPORT_BASE64 : VAR_EXPORT_HEX;
+    } else if (StrCmp(Params->Argv[i], L"-o") == 0 && i + 1 < Params->Argc) {
+      OutPath = Params->Argv[++i];
+    }
+  }
+
+  if (Flash) {
+    Status = VarFlashEnable();
+    if (EFI_ERROR(Status)) {
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"NV flash mapping not usable: %r, using runtime services\n", Status);
+      SetTextAttr(EFI_LIGHTGRAY);
+    }
+  }
+
+  if (WatchMs != 0) {
+    *BatchStatus = WatchVariables(WatchMs, OutPath);
+    return TRUE;
+  }
+
+  if (AuthName != NULL) {
+    EFI_GUID Guid;
+    BOOLEAN CanAppend;
+    if (!VarAuthLookupTarget(AuthName, &Guid, &CanAppend)) {
+      CopyGuid(&Guid, &mDefaultVendorGuid);
+    }
+    *BatchStatus = WriteAuthFile(AuthName, &Guid, AuthPath, AuthAppend);
+    return TRUE;
+  }
+
+  if (SnapPath != NULL) {
+    *BatchStatus = SnapshotToFile(SnapPath, SnapFlags);
+    return TRUE;
+  }
+
+  if (RestorePath != NULL) {
+    *BatchStatus = RestoreSnapshot(RestorePath, DryRun);
+    return TRUE;
+  }
+
+  if (PlanPath != NULL) {
+    *BatchStatus = ApplyPlanFile(PlanPath);
+    return TRUE;
+  }
+
+  if (Export) {
+    *BatchStatus = ExportCatalog(Format, Flags, OutPath);
+    return TRUE;
+  }
+
+  if (DumpPath != NULL) {
+    *BatchStatus = DumpAllToFile(DumpPath);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+EFI_STATUS
+EFIAPI
+UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *SystemTable)
+{
+  UINTN Sel = 0;
+  EFI_INPUT_KEY Key;
+  EFI_STATUS BatchStatus;
+
+  if (ParseCommandLine(ImageHandle, &BatchStatus)) {
+    VarFlashDisable();
+    VarCacheShutdown();
+    VarGrowthReset();
+    return BatchStatus;
+  }
+
+  // the default file is optional; a file named with -guids is not
+  if (mGuidNamesPath != NULL) {
+    EFI_STATUS Status = VarGuidNamesLoad(mGuidNamesPath, NULL);
+    if (EFI_ERROR(Status)) {
+      SetTextAttr(EFI_LIGHTRED);
+      Print(L"Load %s failed: %r\n", mGuidNamesPath, Status);
+      SetTextAttr(EFI_LIGHTGRAY);
+      WaitAnyKey();
+    }
+  } else {
+    VarGuidNamesLoad(VAR_GUID_NAMES_FILE, NULL);
+  }
+
+  while (TRUE) {
+    ShowMenu(Sel);
+
+    while (gST->ConIn->ReadKeyStroke(gST->ConIn, &Key) == EFI_NOT_READY) {
+      gBS->Stall(1000);
+    }
+
+    if (Key.ScanCode == SCAN_UP) {
+      if (Sel > 0) Sel--;
+      continue;
+    }
+
+    if (Key.ScanCode == SCAN_DOWN) {
+      if (Sel + 1 < ARRAY_SIZE(mMenu)) Sel++;
+      continue;
+    }
+
+    if (Key.UnicodeChar == CHAR_CARRIAGE_RETURN) {
+      if (mMenu[Sel].Handler == NULL) {
+        VarFlashDisable();
+        VarCacheShutdown();
+        VarGrowthReset();
+        VarGuidNamesReset();
+        return EFI_SUCCESS;
+      }
+      mMenu[Sel].Handler();
+    }
+  }
+}
@@ -0,0 +1,692 @@
+#ifndef VARIABLE_TOOL_H_
+#define VARIABLE_TOOL_H_
+
+#include <Uefi.h>
+#include <Base.h>
+
+#include <Library/UefiLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+
+#include <Protocol/SimpleFileSystem.h>
+
+// =============================
+// Variable service backends (VarBackend.c)
+// =============================
+// Zero-copy read: *Data points into the backend's own (read-only) memory
+// and stays valid while the backend is selected.
+typedef EFI_STATUS (*VAR_READ_IN_PLACE)(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL,
+                                        OUT UINT8 **Data, OUT UINTN *DataSize);
+
+typedef struct {
+  CONST CHAR16                *Description;
+  EFI_GET_VARIABLE            GetVariable;
+  EFI_GET_NEXT_VARIABLE_NAME  GetNextVariableName;
+  EFI_SET_VARIABLE            SetVariable;
+  EFI_QUERY_VARIABLE_INFO     QueryVariableInfo;
+  VAR_READ_IN_PLACE           ReadInPlace;      // OPTIONAL
+} VAR_BACKEND;
+
+extern VAR_BACKEND *gVarBackend;
+
+// NULL selects runtime services again.
+VOID
+VarBackendSelect(IN VAR_BACKEND *Backend OPTIONAL);
+
+// =============================
+// Variable store images (VarStore.c)
+// Parses the on-flash layout of MdeModulePkg's variable driver in place:
+// VARIABLE_STORE_HEADER followed by 4-byte aligned VARIABLE_HEADER or
+// AUTHENTICATED_VARIABLE_HEADER records, each followed by name and data.
+// =============================
+#define VAR_STORE_HEADER_SIZE     28
+#define VAR_STORE_FORMATTED       0x5A
+#define VAR_STORE_HEALTHY         0xFE
+
+#define VAR_STORE_START_ID        0x55AA
+#define VAR_STORE_ADDED           0x3F
+#define VAR_STORE_DELETED         0xFD    // bit cleared from VAR_STORE_ADDED
+#define VAR_STORE_IN_TRANSITION   0xFE    // ditto
+#define VAR_STORE_HEADER_ONLY     0x7F
+
+typedef struct {
+  UINT8    *Base;               // VARIABLE_STORE_HEADER
+  UINTN    Size;                // header Size, clipped to the image
+  UINTN    Offset;              // of Base within the image
+  BOOLEAN  Authenticated;
+  UINT8    Format;
+  UINT8    State;
+} VAR_STORE;
+
+typedef struct {
+  UINTN     Offset;             // of the header within the store
+  UINTN     HeaderSize;
+  UINT8     State;
+  UINT32    Attributes;
+  EFI_GUID  *Guid;
+  CHAR16    *Name;
+  UINTN     NameSize;
+  UINT8     *Data;
+  UINTN     DataSize;
+  UINTN     Next;               // offset of the following header
+} VAR_STORE_ENTRY;
+
+// Searches Image from *Offset for a store header and advances *Offset past
+// it, so repeated calls find every copy (FTW spare blocks hold one too).
+EFI_STATUS
+VarStoreFind(IN UINT8 *Image, IN UINTN ImageSize, IN OUT UINTN *Offset, OUT VAR_STORE *Store);
+
+// Entry at *Cursor (0 = first); FALSE at the end of the written area.
+// *Cursor is advanced to the next entry.
+BOOLEAN
+VarStoreNextEntry(IN CONST VAR_STORE *Store, IN OUT UINTN *Cursor, OUT VAR_STORE_ENTRY *Entry);
+
+typedef struct {
+  UINTN  Count;
+  UINTN  Bytes;                 // headers, names, data and alignment padding
+} VAR_STORE_TALLY;
+
+// What makes the variable driver reclaim before the OS on the next boot.
+typedef enum {
+  VarReclaimNone,
+  VarReclaimDirtyFree,          // area after the last record not erased: at driver init
+  VarReclaimLowSpace            // a maximum-size variable no longer fits: at EndOfDxe/ReadyToBoot
+} VAR_RECLAIM_TRIGGER;
+
+typedef struct {
+  VAR_STORE_TALLY      Added;
+  VAR_STORE_TALLY      Deleted;
+  VAR_STORE_TALLY      InTransition;        // live only without a VAR_ADDED twin
+  VAR_STORE_TALLY      Incomplete;          // torn: header written, record not completed
+  UINTN                Used;                // store header through the last record
+  UINTN                Free;                // after the last record
+  UINTN                LargestFree;         // longest erased (0xFF) run in Free
+  UINTN                Reclaimable;         // dead records a reclaim drops
+  UINTN                Headroom;            // common space left, as the driver counts it
+  VAR_RECLAIM_TRIGGER  Trigger;
+  UINTN                WritesBeforeReclaim; // record bytes until VarReclaimLowSpace
+} VAR_STORE_HEALTH;
+
+// MaxVariableSize and HwErrStorageSize are the platform's PcdMaxVariableSize
+// (or PcdMaxAuthVariableSize, if larger) and PcdHwErrStorageSize.
+VOID
+VarStoreHealth(IN CONST VAR_STORE *Store, IN UINTN MaxVariableSize, IN UINTN HwErrStorageSize,
+               OUT VAR_STORE_HEALTH *Health);
+
+// Read-only backend over Store (the store memory must outlive it).
+// Variables are indexed once; reads are served in place.
+EFI_STATUS
+VarStoreBackendOpen(IN VAR_STORE *Store, OUT VAR_BACKEND **Backend);
+
+VOID
+VarStoreBackendClose(VOID);
+
+// =============================
+// NV store fast path (VarFlash.c)
+// Enumeration and reads straight from the memory-mapped variable FV;
+// writes, QueryVariableInfo and variables the flash does not hold
+// (volatile ones) still go to runtime services.
+// =============================
+// Fails, leaving runtime services selected, when no mapped store is found
+// or it disagrees with GetVariable.
+EFI_STATUS
+VarFlashEnable(VOID);
+
+VOID
+VarFlashDisable(VOID);
+
+// =============================
+// Payload cache (VarCache.c)
+// Bounded LRU cache of variable payloads, keyed by (name, GUID).
+// =============================
+#define VAR_CACHE_DEFAULT_LIMIT  SIZE_1MB
+
+typedef struct {
+  UINT32  Attributes;
+  UINTN   DataSize;
+  UINT8   *Data;
+} VAR_PAYLOAD;
+
+typedef struct {
+  UINT64  Hits;
+  UINT64  Misses;
+  UINT64  Evictions;
+  UINTN   Entries;
+  UINTN   Bytes;
+  UINTN   Limit;
+} VAR_CACHE_STATS;
+
+//
+// Returns a pinned payload; release it with VarCacheRelease().
+// The payload stays valid until released, even if the variable is evicted
+// or invalidated meanwhile.
+//
+EFI_STATUS
+VarCacheGet(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT VAR_PAYLOAD **Payload);
+
+VOID
+VarCacheRelease(IN VAR_PAYLOAD *Payload);
+
+//
+// Bulk read for walks over many variables (search results, dumps, export).
+// Serves cache hits without promoting them; misses are read with a single
+// GetVariable call into a shared scratch buffer and cached while the cache
+// has free room, never by evicting. *Data is only valid until the next
+// VarReadBulk/VarCache* call or variable write.
+//
+EFI_STATUS
+VarReadBulk(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize);
+
+// Like VarReadBulk but bypasses the cache (watcher, rollback snapshots),
+// dropping a cached copy that no longer matches the store.
+EFI_STATUS
+VarReadFresh(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize);
+
+VOID
+VarCacheInvalidate(IN CHAR16 *Name, IN EFI_GUID *Guid);
+
+VOID
+VarCacheInvalidateAll(VOID);
+
+VOID
+VarCacheSetLimit(IN UINTN LimitBytes);
+
+VOID
+VarCacheGetStats(OUT VAR_CACHE_STATS *Stats);
+
+// Free all cached payloads and the scratch buffer (on exit).
+VOID
+VarCacheShutdown(VOID);
+
+// =============================
+// Variable catalog (VarCatalog.c)
+// =============================
+typedef enum {
+  VarItemVerified,     // read from the store this session
+  VarItemCached,       // from the catalog cache file, not yet confirmed
+  VarItemStale,        // cache entry whose size/attributes changed
+  VarItemNew,          // in the store but not in the cache file
+  VarItemDeleted       // in the cache file but gone from the store
+} VAR_ITEM_STATE;
+
+// Rendered List All row (VariableTool.c), rebuilt when stale.
+typedef struct {
+  CHAR16  *Text;
+  UINT32  Size;       // DataSize Text was built from
+  UINT32  Width;      // console width Text was built for
+} VAR_ROW;
+
+// The catalog is kept as parallel arrays. A variable is an index: its name
+// is an offset into one shared name pool and its vendor GUID a 16-bit
+// index into a table of the distinct GUIDs (a store has a few dozen), so
+// GUID filters compare integers and an entry costs 15 bytes plus the name.
+// Pure ASCII names (nearly all) are pooled one byte per character; the
+// rest keep their UTF-16 form and are flagged with VAR_NAME_WIDE.
+#define VAR_GUID_INDEX_NONE  MAX_UINT16
+#define VAR_NAME_WIDE        BIT31      // in NameOffset
+
+typedef struct {
+  UINTN     Count;
+  UINTN     Capacity;
+  UINT32    *NameOffset;    // byte offset into Names, | VAR_NAME_WIDE
+  UINT16    *GuidIndex;     // index into Guids
+  UINT32    *DataSize;
+  UINT32    *Attributes;
+  UINT8     *State;         // VAR_ITEM_STATE
+  VAR_ROW   *Rows;          // NULL until List All draws
+  UINT8     *Names;         // NUL-terminated names, back to back
+  UINTN     NamesUsed;      // bytes
+  UINTN     NamesSize;      // bytes
+  CHAR16    *NameScratch;   // widened name, see VarCatalogName()
+  UINTN     NameScratchSize;  // bytes, fits the longest name
+  EFI_GUID  *Guids;         // interned vendor GUIDs
+  UINTN     GuidCount;
+  UINTN     GuidCapacity;
+} VAR_CATALOG;
+
+#define VAR_CATALOG_GUID(Catalog, Index)  (&(Catalog)->Guids[(Catalog)->GuidIndex[Index]])
+
+VOID
+VarCatalogInit(OUT VAR_CATALOG *Catalog);
+
+EFI_STATUS
+VarCatalogAdd(IN OUT VAR_CATALOG *Catalog, IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, IN UINTN DataSize,
+              IN UINT32 Attributes, IN VAR_ITEM_STATE State);
+
+// Name as UTF-16. ASCII names are widened into the catalog's scratch
+// buffer, so the result is only valid until the next call.
+CHAR16 *
+VarCatalogName(IN VAR_CATALOG *Catalog, IN UINTN Index);
+
+// Compare/match against the pooled form, without widening.
+BOOLEAN
+VarCatalogNameEqual(IN VAR_CATALOG *Catalog, IN UINTN Index, IN CONST CHAR16 *Name);
+
+BOOLEAN
+VarCatalogNameMatch(IN VAR_CATALOG *Catalog, IN UINTN Index, IN CONST CHAR16 *Pattern);
+
+// Index of Guid in the intern table, VAR_GUID_INDEX_NONE if no entry has it.
+UINT16
+VarCatalogFindGuid(IN VAR_CATALOG *Catalog, IN CONST EFI_GUID *Guid);
+
+EFI_STATUS
+CollectAllVariables(OUT VAR_CATALOG *Catalog);
+
+VOID
+FreeAllVariables(IN OUT VAR_CATALOG *Catalog);
+
+BOOLEAN
+VarNameMatch(IN CONST CHAR16 *Pattern, IN CONST CHAR16 *Name);
+
+UINT32
+VarNameHash(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid);
+
+// Walks GetNextVariableName with one growing name buffer; the callback
+// returns FALSE to stop early.
+typedef BOOLEAN (*VAR_ENUM_CALLBACK)(IN CHAR16 *Name, IN EFI_GUID *Guid, IN VOID *Context);
+
+EFI_STATUS
+VarForEachVariable(IN VAR_ENUM_CALLBACK Callback, IN VOID *Context);
+
+EFI_STATUS
+GetVariableDataSizeQuick(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINTN *OutSize, OUT UINT32 *OutAttr);
+
+// SetVariable + cache invalidation. Non-volatile writes over the maximum
+// variable size, or that cannot fit even with the replaced record
+// reclaimed (VarSpaceCheck), fail with EFI_OUT_OF_RESOURCES without
+// reaching the firmware. With EFI_VARIABLE_APPEND_WRITE the size before the first
+// append of the session is journaled.
+EFI_STATUS
+VarSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data);
+
+BOOLEAN
+VarGrowthLookup(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, OUT UINTN *BaseSize);
+
+VOID
+VarGrowthReset(VOID);
+
+// =============================
+// Files and buffered output (VarFile.c, VarWriter.c)
+// =============================
+#define VAR_WRITER_BUFFER_SIZE  SIZE_256KB
+
+typedef struct {
+  EFI_FILE_PROTOCOL  *File;    // NULL => console
+  CHAR8              *Buffer;
+  UINTN              Used;
+  UINTN              Size;
+  UINT64             Total;    // bytes produced so far
+  EFI_STATUS         Status;   // first error, sticky
+} VAR_WRITER;
+
+// Open Path on the volume the tool was loaded from; Create truncates.
+EFI_STATUS
+VarFileOpen(IN CHAR16 *Path, IN BOOLEAN Create, OUT EFI_FILE_PROTOCOL **File);
+
+EFI_STATUS
+VarFileReadAll(IN CHAR16 *Path, OUT VOID **Buffer, OUT UINTN *Size);
+
+EFI_STATUS
+VarWriterOpenFile(OUT VAR_WRITER *Writer, IN CHAR16 *Path);
+
+// UTF-8/ASCII output converted for ConOut (batch mode, shell redirection).
+EFI_STATUS
+VarWriterOpenConsole(OUT VAR_WRITER *Writer);
+
+VOID
+VarWriterPut(IN OUT VAR_WRITER *Writer, IN CONST VOID *Data, IN UINTN Length);
+
+VOID
+VarWriterPrint(IN OUT VAR_WRITER *Writer, IN CONST CHAR8 *Format, ...);
+
+EFI_STATUS
+VarWriterFlush(IN OUT VAR_WRITER *Writer);
+
+EFI_STATUS
+VarWriterClose(IN OUT VAR_WRITER *Writer);
+
+// =============================
+// Formatting kernel (VarFormat.c)
+// =============================
+#define VAR_GUID_STRING_LENGTH  36      // without terminator
+
+// Plain lowercase hex, 2 * Size characters, no terminator.
+UINTN
+VarFormatHex(IN CONST UINT8 *Data, IN UINTN Size, OUT CHAR8 *Out);
+
+// "xx " for Count (<= 16) bytes, blank-padded to 16 columns (48 chars).
+UINTN
+VarFormatHexColumns(IN CONST UINT8 *Data, IN UINTN Count, OUT CHAR8 *Out);
+
+// "00000010  xx xx .. xx  |................|\n", at most 79 chars.
+UINTN
+VarFormatDumpLine(IN UINTN Offset, IN CONST UINT8 *Data, IN UINTN Count, OUT CHAR8 *Line);
+
+// Same text as %g; VAR_GUID_STRING_LENGTH chars, no terminator.
+UINTN
+VarFormatGuid(IN CONST EFI_GUID *Guid, OUT CHAR8 *Out);
+
+// Terminated; Out holds VAR_GUID_STRING_LENGTH + 1 characters.
+VOID
+VarFormatGuid16(IN CONST EFI_GUID *Guid, OUT CHAR16 *Out);
+
+VOID
+VarFormatWiden(IN CONST CHAR8 *In, IN UINTN Length, OUT CHAR16 *Out);
+
+// =============================
+// Dump (VarDump.c)
+// =============================
+VOID
+VarAttributesToAscii(IN UINT32 Attributes, OUT CHAR8 *Buffer, IN UINTN BufferSize);
+
+EFI_STATUS
+VarDumpAll(IN OUT VAR_WRITER *Writer, OUT UINTN *OutCount);
+
+// =============================
+// Typed value entry (VarInput.c)
+// =============================
+typedef enum {
+  VarInputUtf16,    // text, stored as UTF-16 with terminator
+  VarInputAscii,    // text, stored as ASCII with terminator
+  VarInputHex,      // raw bytes: "de ad be ef", "0xDE,0xAD", "DEADBEEF"
+  VarInputUint8,    // integers (decimal or 0x), little-endian
+  VarInputUint16,
+  VarInputUint32,
+  VarInputUint64,
+  VarInputFile      // text is a path; payload is the whole file
+} VAR_INPUT_TYPE;
+
+// Allocates *Data from pool; the caller frees it.
+EFI_STATUS
+VarParseTypedValue(IN VAR_INPUT_TYPE Type, IN CHAR16 *Text, OUT UINT8 **Data, OUT UINTN *DataSize);
+
+// =============================
+// Typed decoders (VarDecode.c)
+// =============================
+// Print a decoded view if a decoder is registered for (GUID, name);
+// returns FALSE when the payload has no known structure.
+BOOLEAN
+VarDecodeAndPrint(IN CHAR16 *Name, IN EFI_GUID *Guid, IN CONST UINT8 *Data, IN UINTN DataSize);
+
+// =============================
+// Hashing (VarHash.c)
+// =============================
+#define VAR_SHA256_DIGEST_SIZE  32
+
+typedef struct {
+  UINT32  State[8];
+  UINT64  Length;
+  UINT8   Block[64];
+  UINTN   Used;
+} VAR_SHA256_CTX;
+
+VOID
+VarSha256Init(OUT VAR_SHA256_CTX *Ctx);
+
+VOID
+VarSha256Update(IN OUT VAR_SHA256_CTX *Ctx, IN CONST VOID *Data, IN UINTN Size);
+
+VOID
+VarSha256Final(IN OUT VAR_SHA256_CTX *Ctx, OUT UINT8 *Digest);
+
+VOID
+VarSha256(IN CONST VOID *Data, IN UINTN Size, OUT UINT8 *Digest);
+
+// =============================
+// Export (VarExport.c)
+// =============================
+typedef enum {
+  VarExportJson,
+  VarExportCsv
+} VAR_EXPORT_FORMAT;
+
+#define VAR_EXPORT_HASH    BIT0   // add SHA-256 of the payload
+#define VAR_EXPORT_HEX     BIT1   // add payload as hex
+#define VAR_EXPORT_BASE64  BIT2   // add payload as base64
+
+EFI_STATUS
+VarExportCatalog(IN OUT VAR_WRITER *Writer, IN VAR_CATALOG *Catalog, IN VAR_EXPORT_FORMAT Format, IN UINT32 Flags);
+
+// =============================
+// Console (VariableTool.c)
+// =============================
+// ConOut text attribute (EFI_LIGHTRED, ...); a no-op without a console.
+VOID
+SetTextAttr(IN UINTN Attr);
+
+// =============================
+// Hex editor (VarEdit.c)
+// =============================
+// Returns EFI_SUCCESS after writing, EFI_ALREADY_STARTED when saved with
+// no changes (nothing written), EFI_ABORTED when the edit was discarded.
+// Bytes added past the original end are written with APPEND_WRITE when
+// the original bytes are untouched.
+EFI_STATUS
+VarEditVariable(IN CHAR16 *Name, IN EFI_GUID *Guid);
+
+// =============================
+// Batch apply with rollback (VarApply.c)
+// =============================
+typedef enum {
+  VarOpSet,
+  VarOpAppend,
+  VarOpDelete
+} VAR_OP_KIND;
+
+typedef struct {
+  VAR_OP_KIND  Kind;
+  CHAR16       *Name;
+  EFI_GUID     Guid;
+  UINT32       Attributes;
+  BOOLEAN      ExplicitAttributes;  // FALSE: keep existing / NV|BS|RT
+  UINT8        *Data;
+  UINTN        DataSize;
+  // snapshot taken before the first write
+  BOOLEAN      Existed;
+  UINT32       OrigAttributes;
+  UINT8        *OrigData;
+  UINTN        OrigSize;
+  // results
+  EFI_STATUS   Status;
+  EFI_STATUS   RestoreStatus;
+} VAR_OP;
+
+#define VAR_ELAPSED_UNKNOWN  MAX_UINT64
+
+typedef struct {
+  UINTN    Applied;
+  UINTN    FailedIndex;     // op whose write failed, Count if none did
+  UINTN    RolledBack;      // writes undone after that failure, else 0
+  UINTN    RestoreErrors;   // of those, the ones that could not be undone
+  UINT64   ElapsedNs;       // VAR_ELAPSED_UNKNOWN if the timer has no frequency
+} VAR_APPLY_RESULT;
+
+EFI_STATUS
+VarLoadPlan(IN CHAR16 *Path, IN EFI_GUID *DefaultGuid, OUT VAR_OP **OutOps, OUT UINTN *OutCount, OUT UINTN *ErrorLine);
+
+EFI_STATUS
+VarApplyOps(IN OUT VAR_OP *Ops, IN UINTN Count, OUT VAR_APPLY_RESULT *Result);
+
+VOID
+VarFreeOps(IN VAR_OP *Ops, IN UINTN Count);
+
+// =============================
+// Signed .auth payloads (VarAuth.c)
+// =============================
+// PK/KEK/db/dbx/dbt: vendor GUID and whether appending is meaningful.
+BOOLEAN
+VarAuthLookupTarget(IN CONST CHAR16 *Name, OUT EFI_GUID *Guid, OUT BOOLEAN *CanAppend);
+
+// Validates the EFI_VARIABLE_AUTHENTICATION_2 header (PKCS#7 cert type).
+EFI_STATUS
+VarAuthInspect(IN CONST UINT8 *Data, IN UINTN Size, OUT EFI_TIME *TimeStamp, OUT UINTN *PayloadOffset);
+
+// Reads the whole file and writes it with NV|BS|RT|AT (+APPEND_WRITE).
+EFI_STATUS
+VarWriteAuthFile(IN CHAR16 *Name, IN EFI_GUID *Guid, IN CHAR16 *Path, IN BOOLEAN Append,
+                 OUT EFI_TIME *TimeStamp OPTIONAL, OUT UINTN *PayloadSize OPTIONAL);
+
+// =============================
+// Space check (VarSpace.c)
+// =============================
+typedef enum {
+  VarSpaceOk,
+  VarSpaceUnknown,      // QueryVariableInfo failed
+  VarSpaceLow,          // fits, but leaves little room: reclaim likely
+  VarSpaceNoRoom,       // would fail with EFI_OUT_OF_RESOURCES
+  VarSpaceTooLarge      // over MaximumVariableSize
+} VAR_SPACE_VERDICT;
+
+typedef struct {
+  UINT64             MaxStorage;
+  UINT64             Remaining;
+  UINT64             MaxVariableSize;
+  UINT64             Needed;      // estimated bytes the write adds
+  UINT64             Freed;       // existing NV records the write(s) replace
+  VAR_SPACE_VERDICT  Verdict;
+} VAR_SPACE_CHECK;
+
+UINT64
+VarSpaceRecordSize(IN CONST CHAR16 *Name, IN UINTN DataSize);
+
+VAR_SPACE_VERDICT
+VarSpaceCheck(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, OUT VAR_SPACE_CHECK *Check);
+
+VAR_SPACE_VERDICT
+VarSpaceProjectPlan(IN VAR_OP *Ops, IN UINTN Count, OUT VAR_SPACE_CHECK *Check);
+
+// =============================
+// Change watcher (VarWatch.c)
+// =============================
+typedef struct {
+  UINTN  Baseline;    // variables at start
+  UINTN  Polls;
+  UINTN  Reads;       // payload reads, baseline included
+  UINTN  Created;
+  UINTN  Deleted;
+  UINTN  Modified;
+} VAR_WATCH_STATS;
+
+// Polls every IntervalMs until ESC, logging CREATED/DELETED/MODIFIED lines.
+EFI_STATUS
+VarWatch(IN OUT VAR_WRITER *Log, IN UINTN IntervalMs, OUT VAR_WATCH_STATS *Stats);
+
+// =============================
+// Vendor GUID names (VarGuidName.c)
+// =============================
+#define VAR_GUID_NAMES_FILE  L"\\VarGuids.txt"
+
+// Friendly name of a vendor GUID, NULL when unknown. At most
+// VAR_GUID_STRING_LENGTH characters for the built-in list.
+CONST CHAR8 *
+VarGuidName(IN CONST EFI_GUID *Guid);
+
+// Adds "<guid> <name>" lines from Path; they take precedence over the
+// built-in names.
+EFI_STATUS
+VarGuidNamesLoad(IN CHAR16 *Path, OUT UINTN *Loaded OPTIONAL);
+
+VOID
+VarGuidNamesReset(VOID);
+
+// =============================
+// Persistent catalog cache (VarCatCache.c)
+// =============================
+#define VAR_CATALOG_CACHE_FILE  L"\\VarCatalog.cache"
+
+typedef struct {
+  CHAR16      *NameBuf;       // enumeration cursor
+  UINTN       NameBufSize;
+  EFI_GUID    Guid;
+  UINTN       Hint;
+  UINTN       Walked;
+  BOOLEAN     Done;
+  EFI_STATUS  Status;
+} VAR_CATALOG_SYNC;
+
+// Entries come back as VarItemCached.
+EFI_STATUS
+VarCatalogLoad(IN CHAR16 *Path, OUT VAR_CATALOG *Catalog);
+
+// Deleted entries are left out.
+EFI_STATUS
+VarCatalogSave(IN CHAR16 *Path, IN VAR_CATALOG *Catalog);
+
+EFI_STATUS
+VarCatalogSyncStart(OUT VAR_CATALOG_SYNC *Sync);
+
+// Up to Budget enumeration steps; may append to Catalog. *Changed reports
+// entries that turned stale/new/deleted. Sync->Done is set at the end of
+// the walk.
+EFI_STATUS
+VarCatalogSyncStep(IN OUT VAR_CATALOG_SYNC *Sync, IN OUT VAR_CATALOG *Catalog, IN UINTN Budget, OUT BOOLEAN *Changed);
+
+VOID
+VarCatalogSyncAbort(IN OUT VAR_CATALOG_SYNC *Sync);
+
+// =============================
+// Multi-processor work queue (VarMp.c)
+// =============================
+// Work runs on the BSP and on APs: it must only touch memory it was
+// handed (no boot/runtime services, allocation or console output).
+// Worker is a dense index < VarMpWorkerCount() for per-CPU scratch.
+typedef VOID (*VAR_MP_WORK)(IN VOID *Context, IN UINTN Job, IN UINTN Worker);
+
+// 1 when EFI_MP_SERVICES_PROTOCOL is missing or limited to one CPU.
+UINTN
+VarMpWorkerCount(VOID);
+
+// Cap on workers (BSP included); 0 = all enabled processors.
+VOID
+VarMpSetLimit(IN UINTN Limit);
+
+// Runs Work for Job = 0..JobCount-1 and returns when all are done.
+VOID
+VarMpRun(IN VAR_MP_WORK Work, IN VOID *Context, IN UINTN JobCount);
+
+// =============================
+// LZ codec (VarLz.c)
+// =============================
+#define VAR_LZ_MIN_MATCH   4
+#define VAR_LZ_HASH_BITS   12
+#define VAR_LZ_TABLE_SIZE  (sizeof(UINT32) << VAR_LZ_HASH_BITS)
+#define VAR_LZ_MAX_LENGTH  SIZE_16MB
+
+// Returns the encoded size, or 0 when it would not fit in DstSize.
+// Table is VAR_LZ_TABLE_SIZE bytes of scratch.
+UINTN
+VarLzCompress(IN CONST UINT8 *Src, IN UINTN Size, OUT UINT8 *Dst, IN UINTN DstSize, IN OUT UINT32 *Table);
+
+// Fails unless Src decodes to exactly DstSize bytes.
+EFI_STATUS
+VarLzDecompress(IN CONST UINT8 *Src, IN UINTN SrcSize, OUT UINT8 *Dst, IN UINTN DstSize);
+
+// =============================
+// Binary snapshots (VarSnapshot.c)
+// =============================
+#define VAR_SNAPSHOT_COMPRESS  BIT0   // per-variable LZ, raw when it does not shrink
+
+typedef struct {
+  UINTN   Count;        // records written / read
+  UINT64  RawBytes;
+  UINT64  StoredBytes;
+  UINTN   Restored;     // written (dry run: would be written)
+  UINTN   Unchanged;    // store already holds the same value
+  UINTN   Skipped;      // save: unreadable; restore: authenticated
+  UINTN   Failed;
+} VAR_SNAPSHOT_STATS;
+
+EFI_STATUS
+VarSnapshotSave(IN OUT VAR_WRITER *Writer, IN UINT32 Flags, OUT VAR_SNAPSHOT_STATS *Stats);
+
+// Streams the file one record at a time; per-variable lines go to Log.
+// Variables missing from the snapshot are left alone.
+EFI_STATUS
+VarSnapshotRestore(IN CHAR16 *Path, IN BOOLEAN DryRun, IN OUT VAR_WRITER *Log, OUT VAR_SNAPSHOT_STATS *Stats);
+
+#endif
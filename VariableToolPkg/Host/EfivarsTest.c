@@ -0,0 +1,268 @@
+#include "HostEfivars.h"
+#include "HostTest.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// =============================
+// Host check for the efivarfs backend
+// Lays out a plain directory the way efivarfs does (<Name>-<guid> files
+// holding attributes + data, next to files that are not variables), then
+// lists, reads, writes, appends and deletes through the tool core, and
+// checks that immutable (protected) variables are only written on opt-in.
+// With a path argument the directory is left there for a varimage smoke run
+// (efivarstest [dir]); otherwise a temporary one is used and removed.
+// =============================
+#define GLOBAL_GUID_TEXT  "8be4df61-93ca-11d2-aa0d-00e098032b8c"
+#define NV_BS_RT          (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+
+STATIC EFI_GUID mGlobal = { 0x8BE4DF61, 0x93CA, 0x11D2, { 0xAA, 0x0D, 0x00, 0xE0, 0x98, 0x03, 0x2B, 0x8C } };
+
+STATIC VOID
+PutFile(IN CONST CHAR8 *Dir, IN CONST CHAR8 *File, IN UINT32 Attributes, IN CONST VOID *Data, IN UINTN DataSize)
+{
+  CHAR8 Path[1024];
+  FILE *f;
+
+  snprintf(Path, sizeof(Path), "%s/%s", Dir, File);
+  f = fopen(Path, "wb");
+  CHECK(f != NULL && fwrite(&Attributes, sizeof(Attributes), 1, f) == 1 &&
+        fwrite(Data, 1, DataSize, f) == DataSize && fclose(f) == 0, "write %s", Path);
+}
+
+// Size of <Dir>/<File> as efivarfs would report it, -1 if missing.
+STATIC long
+FileSize(IN CONST CHAR8 *Dir, IN CONST CHAR8 *File)
+{
+  CHAR8 Path[1024];
+  struct stat Info;
+
+  snprintf(Path, sizeof(Path), "%s/%s", Dir, File);
+  return (stat(Path, &Info) == 0) ? (long)Info.st_size : -1;
+}
+
+// chattr +i / -i on <Dir>/<File>; FALSE where the filesystem or a
+// missing CAP_LINUX_IMMUTABLE does not allow it.
+STATIC BOOLEAN
+Chattr(IN CONST CHAR8 *Dir, IN CONST CHAR8 *File, IN BOOLEAN Immutable)
+{
+  CHAR8 Path[1024];
+  int Fd;
+  int Flags;
+  BOOLEAN Done = FALSE;
+
+  snprintf(Path, sizeof(Path), "%s/%s", Dir, File);
+  Fd = open(Path, O_RDONLY);
+  if (Fd < 0) return FALSE;
+  if (ioctl(Fd, FS_IOC_GETFLAGS, &Flags) == 0) {
+    Flags = Immutable ? (Flags | FS_IMMUTABLE_FL) : (Flags & ~FS_IMMUTABLE_FL);
+    Done = ioctl(Fd, FS_IOC_SETFLAGS, &Flags) == 0;
+  }
+  close(Fd);
+  return Done;
+}
+
+STATIC BOOLEAN
+IsImmutable(IN CONST CHAR8 *Dir, IN CONST CHAR8 *File)
+{
+  CHAR8 Path[1024];
+  int Fd;
+  int Flags = 0;
+
+  snprintf(Path, sizeof(Path), "%s/%s", Dir, File);
+  Fd = open(Path, O_RDONLY);
+  if (Fd < 0) return FALSE;
+  if (ioctl(Fd, FS_IOC_GETFLAGS, &Flags) != 0) Flags = 0;
+  close(Fd);
+  return (Flags & FS_IMMUTABLE_FL) != 0;
+}
+
+// Protected variables stay protected unless the caller opts in, and keep
+// the flag across a write made under that opt-in.
+STATIC VOID
+CheckImmutable(IN CONST CHAR8 *Dir)
+{
+  CONST CHAR8 *File = "PlatformLang-" GLOBAL_GUID_TEXT;
+
+  PutFile(Dir, File, NV_BS_RT, "en", 3);
+  if (!Chattr(Dir, File, TRUE)) {
+    printf("immutable files not supported here, skipped\n");
+    return;
+  }
+
+  CHECK(VarSetVariable(L"PlatformLang", &mGlobal, NV_BS_RT, 3, "fr") == EFI_WRITE_PROTECTED &&
+        IsImmutable(Dir, File), "write to an immutable variable without opt-in");
+  CHECK(VarSetVariable(L"PlatformLang", &mGlobal, 0, 0, NULL) == EFI_WRITE_PROTECTED &&
+        FileSize(Dir, File) == 7, "delete of an immutable variable without opt-in");
+
+  EfivarsAllowUnprotect(TRUE);
+  CHECK(!EFI_ERROR(VarSetVariable(L"PlatformLang", &mGlobal, NV_BS_RT, 6, "en-US")) &&
+        FileSize(Dir, File) == 10 && IsImmutable(Dir, File), "write with opt-in keeps the flag");
+  CHECK(!EFI_ERROR(VarSetVariable(L"PlatformLang", &mGlobal, 0, 0, NULL)) && FileSize(Dir, File) == -1,
+        "delete with opt-in");
+  EfivarsAllowUnprotect(FALSE);
+}
+
+STATIC VOID
+RemoveTree(IN CONST CHAR8 *Dir)
+{
+  DIR *d = opendir(Dir);
+  struct dirent *e;
+  CHAR8 Path[1024];
+
+  if (d == NULL) return;
+  while ((e = readdir(d)) != NULL) {
+    if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+    snprintf(Path, sizeof(Path), "%s/%s", Dir, e->d_name);
+    if (e->d_type == DT_DIR) RemoveTree(Path);
+    else unlink(Path);
+  }
+  closedir(d);
+  rmdir(Dir);
+}
+
+STATIC VOID
+CheckDirectory(IN CONST CHAR8 *Dir)
+{
+  VAR_BACKEND *Backend;
+  VAR_CATALOG Catalog;
+  CHAR16 Name[64];
+  UINTN NameSize;
+  EFI_GUID Guid;
+  UINT8 Buffer[16];
+  UINTN DataSize;
+  UINT32 Attr;
+  UINT8 *Data;
+  UINT64 Max;
+  UINT64 Left;
+  UINT64 Largest;
+  CHAR8 Sub[1024];
+  UINT16 Order[] = { 0, 1 };
+  UINT16 More = 2;
+  VAR_CACHE_STATS Stats;
+
+  PutFile(Dir, "Boot0000-" GLOBAL_GUID_TEXT, NV_BS_RT, "\x01\x00\x00\x00\x2a\x00", 6);
+  PutFile(Dir, "BootOrder-" GLOBAL_GUID_TEXT, NV_BS_RT, Order, sizeof(Order));
+  PutFile(Dir, "Lang-" GLOBAL_GUID_TEXT, NV_BS_RT, "eng", 4);
+  PutFile(Dir, "README", 0, "not a variable", 14);
+  PutFile(Dir, "Bad-zzzzzzzz-93ca-11d2-aa0d-00e098032b8c", NV_BS_RT, "x", 1);
+  snprintf(Sub, sizeof(Sub), "%s/Sub-" GLOBAL_GUID_TEXT, Dir);
+  mkdir(Sub, 0755);
+
+  CHECK(EfivarsBackendOpen("/nonexistent/efivars", &Backend) == EFI_NOT_FOUND, "missing directory");
+  CHECK(!EFI_ERROR(EfivarsBackendOpen(Dir, &Backend)), "open %s", Dir);
+  VarBackendSelect(Backend);
+
+  CHECK(!EFI_ERROR(CollectAllVariables(&Catalog)) && Catalog.Count == 3, "listed %lu variables, expected 3",
+        (unsigned long)Catalog.Count);
+  FreeAllVariables(&Catalog);
+
+  CHECK(!EFI_ERROR(VarReadBulk(L"Lang", &mGlobal, &Attr, &Data, &DataSize)) && Attr == NV_BS_RT &&
+        DataSize == 4 && memcmp(Data, "eng", 4) == 0, "read Lang");
+  CHECK(!EFI_ERROR(VarReadBulk(L"Lang", &mGlobal, &Attr, &Data, &DataSize)) && memcmp(Data, "eng", 4) == 0,
+        "read Lang again");
+  VarCacheGetStats(&Stats);
+  CHECK(Stats.Hits == 1 && Stats.Entries == 1, "bulk read misses fill the cache");
+  DataSize = 2;
+  CHECK(gVarBackend->GetVariable(L"Boot0000", &mGlobal, &Attr, &DataSize, Buffer) == EFI_BUFFER_TOO_SMALL &&
+        DataSize == 6, "size probe");
+  CHECK(VarReadBulk(L"Missing", &mGlobal, &Attr, &Data, &DataSize) == EFI_NOT_FOUND, "missing variable");
+
+  // create, replace with a shorter value, append
+  CHECK(!EFI_ERROR(VarSetVariable(L"Timeout", &mGlobal, NV_BS_RT, 2, "\x05\x00")) &&
+        FileSize(Dir, "Timeout-" GLOBAL_GUID_TEXT) == 6, "create Timeout");
+  CHECK(!EFI_ERROR(VarSetVariable(L"Lang", &mGlobal, NV_BS_RT, 3, "fr")) &&
+        FileSize(Dir, "Lang-" GLOBAL_GUID_TEXT) == 7, "replace Lang");
+  CHECK(!EFI_ERROR(VarSetVariable(L"BootOrder", &mGlobal, NV_BS_RT | EFI_VARIABLE_APPEND_WRITE, sizeof(More), &More)),
+        "append BootOrder");
+  DataSize = sizeof(Buffer);
+  CHECK(!EFI_ERROR(gVarBackend->GetVariable(L"BootOrder", &mGlobal, &Attr, &DataSize, Buffer)) && DataSize == 6 &&
+        ReadUnaligned16((UINT16 *)(Buffer + 4)) == 2 && Attr == NV_BS_RT, "BootOrder after append");
+
+  // delete; a walk continues past a variable deleted under it
+  Name[0] = L'\0';
+  NameSize = sizeof(Name);
+  CHECK(!EFI_ERROR(gVarBackend->GetNextVariableName(&NameSize, Name, &Guid)), "walk start");
+  CHECK(!EFI_ERROR(VarSetVariable(Name, &Guid, 0, 0, NULL)), "delete %s", "first listed");
+  CHECK(VarSetVariable(Name, &Guid, 0, 0, NULL) == EFI_NOT_FOUND, "second delete");
+  DataSize = sizeof(Buffer);
+  CHECK(gVarBackend->GetVariable(Name, &Guid, &Attr, &DataSize, Buffer) == EFI_NOT_FOUND, "read deleted");
+  NameSize = sizeof(Name);
+  CHECK(gVarBackend->GetNextVariableName(&NameSize, Name, &Guid) != EFI_INVALID_PARAMETER, "walk after delete");
+
+  CHECK(!EFI_ERROR(CollectAllVariables(&Catalog)) && Catalog.Count == 3, "listed %lu variables after writes, expected 3",
+        (unsigned long)Catalog.Count);
+  FreeAllVariables(&Catalog);
+
+  CHECK(gVarBackend->QueryVariableInfo(NV_BS_RT, &Max, &Left, &Largest) == EFI_UNSUPPORTED,
+        "plain directory has no QueryVariableInfo");
+
+  CheckImmutable(Dir);
+
+  EfivarsBackendClose();
+  CHECK(gVarBackend != Backend, "close must deselect the efivarfs backend");
+}
+
+// Catalog load over Count variable files, as varimage does on a host.
+STATIC VOID
+Benchmark(IN UINTN Count)
+{
+  CHAR8 Dir[] = "/tmp/efivarsbenchXXXXXX";
+  CHAR8 File[128];
+  UINT8 Payload[64];
+  VAR_BACKEND *Backend;
+  VAR_CATALOG Catalog;
+  UINTN Rounds = 50;
+  struct timespec t0, t1;
+
+  if (mkdtemp(Dir) == NULL) return;
+  memset(Payload, 0x5A, sizeof(Payload));
+  for (UINTN i = 0; i < Count; i++) {
+    snprintf(File, sizeof(File), "Var%04u-" GLOBAL_GUID_TEXT, (unsigned)i);
+    PutFile(Dir, File, NV_BS_RT, Payload, i % sizeof(Payload));
+  }
+
+  EfivarsBackendOpen(Dir, &Backend);
+  VarBackendSelect(Backend);
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (UINTN r = 0; r < Rounds; r++) {
+    CollectAllVariables(&Catalog);
+    FreeAllVariables(&Catalog);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  EfivarsBackendClose();
+
+  printf("catalog of %u variable files: %.1f us per listing\n", (unsigned)Count,
+         ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e3 / Rounds);
+  RemoveTree(Dir);
+}
+
+int
+main(int argc, char **argv)
+{
+  CHAR8 Temp[] = "/tmp/efivarsXXXXXX";
+  CONST CHAR8 *Dir;
+
+  if (argc > 1) {
+    Dir = argv[1];
+    RemoveTree(Dir);
+    CHECK(mkdir(Dir, 0755) == 0, "mkdir %s", Dir);
+  } else {
+    Dir = mkdtemp(Temp);
+    CHECK(Dir != NULL, "mkdtemp");
+  }
+
+  if (Dir != NULL) CheckDirectory(Dir);
+  if (argc <= 1 && Dir != NULL) RemoveTree(Dir);
+  Benchmark(300);
+
+  VarCacheShutdown();
+  printf("%s\n", mFailed ? "FAILED" : "ok");
+  return mFailed;
+}
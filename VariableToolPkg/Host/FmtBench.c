@@ -0,0 +1,137 @@
+#include "VariableTool.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// =============================
+// Host check and benchmark for the formatting kernel (VarFormat.c)
+// The baseline formats every byte through a format string, as the tool
+// did with Print(L"%02x ") and %g; libc snprintf stands in for PrintLib,
+// which is not available on the host. Kernel output must match it
+// character for character.
+// =============================
+#define BENCH_BYTES  (16 * SIZE_1MB)
+#define BENCH_GUIDS  200000
+
+STATIC double
+NowSeconds(VOID)
+{
+  struct timespec Ts;
+  clock_gettime(CLOCK_MONOTONIC, &Ts);
+  return Ts.tv_sec + Ts.tv_nsec / 1e9;
+}
+
+// Dump line the old way: one formatted call per field/byte.
+STATIC UINTN
+BaselineDumpLine(IN UINTN Offset, IN CONST UINT8 *Data, IN UINTN Count, OUT CHAR8 *Line)
+{
+  UINTN n = (UINTN)snprintf(Line, 16, "%08x  ", (UINT32)Offset);
+
+  for (UINTN i = 0; i < 16; i++) {
+    if (i < Count) {
+      n += (UINTN)snprintf(Line + n, 8, "%02x ", Data[i]);
+    } else {
+      n += (UINTN)snprintf(Line + n, 8, "   ");
+    }
+  }
+  n += (UINTN)snprintf(Line + n, 4, " |");
+  for (UINTN i = 0; i < Count; i++) {
+    n += (UINTN)snprintf(Line + n, 4, "%c", (Data[i] >= 0x20 && Data[i] <= 0x7E) ? Data[i] : '.');
+  }
+  n += (UINTN)snprintf(Line + n, 4, "|\n");
+  return n;
+}
+
+STATIC UINTN
+BaselineGuid(IN CONST EFI_GUID *G, OUT CHAR8 *Out)
+{
+  return (UINTN)snprintf(Out, 40, "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                         G->Data1, G->Data2, G->Data3, G->Data4[0], G->Data4[1],
+                         G->Data4[2], G->Data4[3], G->Data4[4], G->Data4[5], G->Data4[6], G->Data4[7]);
+}
+
+int
+main(VOID)
+{
+  UINT8 *Data = malloc(BENCH_BYTES);
+  EFI_GUID *Guids = malloc(BENCH_GUIDS * sizeof(EFI_GUID));
+  CHAR8 A[160], B[160];
+  UINT32 Seed = 0x9E3779B9;
+  UINT64 Sink = 0;
+  double t0, tBase, tKernel;
+  int Failed = 0;
+
+  for (UINTN i = 0; i < BENCH_BYTES; i++) {
+    Seed = Seed * 1664525 + 1013904223;
+    Data[i] = (UINT8)(Seed >> 24);
+  }
+  for (UINTN i = 0; i < BENCH_GUIDS * sizeof(EFI_GUID); i++) {
+    Seed = Seed * 1664525 + 1013904223;
+    ((UINT8 *)Guids)[i] = (UINT8)(Seed >> 24);
+  }
+
+  // correctness: every line length 1..16, all byte values, many GUIDs
+  for (UINTN Offset = 0; Offset < SIZE_1MB; Offset += 16) {
+    UINTN Count = 1 + (Offset / 16) % 16;
+    UINTN La = VarFormatDumpLine(Offset * 4099, Data + Offset, Count, A);
+    UINTN Lb = BaselineDumpLine(Offset * 4099, Data + Offset, Count, B);
+    if (La != Lb || memcmp(A, B, La) != 0) {
+      printf("FAIL: dump line at %u\n", (unsigned)Offset);
+      Failed = 1;
+      break;
+    }
+  }
+  for (UINTN Size = 0; Size <= 64; Size++) {
+    UINTN n = VarFormatHex(Data + Size, Size, A);
+    for (UINTN i = 0; i < Size; i++) snprintf(B + 2 * i, 3, "%02x", Data[Size + i]);
+    if (n != 2 * Size || memcmp(A, B, n) != 0) {
+      printf("FAIL: hex run of %u bytes\n", (unsigned)Size);
+      Failed = 1;
+    }
+  }
+  for (UINTN i = 0; i < BENCH_GUIDS; i++) {
+    if (VarFormatGuid(&Guids[i], A) != BaselineGuid(&Guids[i], B) || memcmp(A, B, VAR_GUID_STRING_LENGTH) != 0) {
+      printf("FAIL: GUID %u\n", (unsigned)i);
+      Failed = 1;
+      break;
+    }
+  }
+
+  // dump lines
+  t0 = NowSeconds();
+  for (UINTN Offset = 0; Offset < BENCH_BYTES; Offset += 16) Sink += BaselineDumpLine(Offset, Data + Offset, 16, A);
+  tBase = NowSeconds() - t0;
+  t0 = NowSeconds();
+  for (UINTN Offset = 0; Offset < BENCH_BYTES; Offset += 16) Sink += VarFormatDumpLine(Offset, Data + Offset, 16, A);
+  tKernel = NowSeconds() - t0;
+  printf("dump lines : format string %7.1f MB/s   kernel %7.1f MB/s   x%.1f\n",
+         BENCH_BYTES / tBase / 1e6, BENCH_BYTES / tKernel / 1e6, tBase / tKernel);
+
+  // plain hex (export data / digests)
+  t0 = NowSeconds();
+  for (UINTN Offset = 0; Offset < BENCH_BYTES; Offset += 32) {
+    for (UINTN i = 0; i < 32; i++) snprintf(A + 2 * i, 3, "%02x", Data[Offset + i]);
+    Sink += (UINT8)A[5];
+  }
+  tBase = NowSeconds() - t0;
+  t0 = NowSeconds();
+  for (UINTN Offset = 0; Offset < BENCH_BYTES; Offset += 32) Sink += VarFormatHex(Data + Offset, 32, A) + (UINT8)A[5];
+  tKernel = NowSeconds() - t0;
+  printf("plain hex  : format string %7.1f MB/s   kernel %7.1f MB/s   x%.1f\n",
+         BENCH_BYTES / tBase / 1e6, BENCH_BYTES / tKernel / 1e6, tBase / tKernel);
+
+  // GUIDs
+  t0 = NowSeconds();
+  for (UINTN i = 0; i < BENCH_GUIDS; i++) Sink += BaselineGuid(&Guids[i], A) + (UINT8)A[3];
+  tBase = NowSeconds() - t0;
+  t0 = NowSeconds();
+  for (UINTN i = 0; i < BENCH_GUIDS; i++) Sink += VarFormatGuid(&Guids[i], A) + (UINT8)A[3];
+  tKernel = NowSeconds() - t0;
+  printf("GUIDs      : format string %7.2f M/s    kernel %7.2f M/s    x%.1f\n",
+         BENCH_GUIDS / tBase / 1e6, BENCH_GUIDS / tKernel / 1e6, tBase / tKernel);
+
+  printf("%s (%u)\n", Failed ? "FAILED" : "ok", (unsigned)(Sink & 1));
+  free(Data);
+  free(Guids);
+  return Failed;
+}
@@ -0,0 +1,472 @@
+#include "HostEfivars.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/statfs.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// =============================
+// efivarfs backend
+// A walk lists the directory once, with getdents64 into the backend's
+// buffer, and continues from the previous name without rereading it. A
+// read is one openat + pread of the whole file into that same buffer,
+// grown only when a variable fills it. A write is a single write() of
+// attributes and data, which efivarfs turns into one SetVariable; a delete
+// is an unlink. Files of variables the kernel treats as critical are
+// immutable; writing them fails with EFI_WRITE_PROTECTED unless the caller
+// opted in with EfivarsAllowUnprotect, and then the flag is cleared for
+// that one write, as chattr -i would, and set again afterwards.
+// =============================
+#define EFIVARFS_MAGIC       0xde5e81e4
+#define EFIVARS_PATH_SIZE    512         // NAME_MAX is 255 bytes anyway
+#define EFIVARS_GUID_LENGTH  36
+
+// struct linux_dirent64
+typedef struct {
+  UINT64  Inode;
+  INT64   Offset;
+  UINT16  RecordLength;
+  UINT8   Type;
+  CHAR8   Name[];
+} DIRENT64;
+
+typedef struct {
+  CHAR16    *Name;
+  UINTN     NameSize;
+  EFI_GUID  Guid;
+  BOOLEAN   Deleted;      // unlinked through this backend during the walk
+} EFIVARS_ENTRY;
+
+STATIC int mDirFd = -1;
+STATIC BOOLEAN mEfivarfs = FALSE;       // FALSE: a plain directory standing in for it
+STATIC BOOLEAN mUnprotect = FALSE;      // may clear FS_IMMUTABLE_FL to write
+STATIC EFIVARS_ENTRY *mEntries = NULL;  // last directory listing, in directory order
+STATIC UINTN mEntryCount = 0;
+STATIC UINTN mEntryRoom = 0;
+STATIC UINTN mLast = 0;                 // entry handed out by the last GetNextVariableName
+STATIC UINT8 *mBuffer = NULL;
+STATIC UINTN mBufferSize = 0;
+
+// Kernel errnos as efi_status_to_err() produces them, mapped back.
+STATIC EFI_STATUS
+StatusFromErrno(IN int Error)
+{
+  switch (Error) {
+  case ENOENT:  return EFI_NOT_FOUND;
+  case EACCES:  return EFI_ACCESS_DENIED;
+  case EPERM:
+  case EROFS:   return EFI_WRITE_PROTECTED;
+  case ENOSPC:
+  case ENOMEM:  return EFI_OUT_OF_RESOURCES;
+  case EINVAL:  return EFI_INVALID_PARAMETER;
+  default:      return EFI_DEVICE_ERROR;
+  }
+}
+
+STATIC BOOLEAN
+BufferReserve(IN UINTN Size)
+{
+  UINTN NewSize = MAX(mBufferSize, SIZE_4KB);
+  UINT8 *New;
+
+  if (Size <= mBufferSize) return TRUE;
+  while (NewSize < Size) NewSize *= 2;
+  New = ReallocatePool(mBufferSize, NewSize, mBuffer);
+  if (New == NULL) return FALSE;
+  mBuffer = New;
+  mBufferSize = NewSize;
+  return TRUE;
+}
+
+// <Name>-<guid> as efivarfs spells it (lower-case GUID).
+STATIC BOOLEAN
+FileName(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid, OUT CHAR8 *Path)
+{
+  UINTN Length;
+
+  for (Length = 0; Name[Length] != L'\0'; Length++) {
+    if (Name[Length] == L'/') return FALSE;
+  }
+  if (Length == 0 || Length * 3 + EFIVARS_GUID_LENGTH + 2 > EFIVARS_PATH_SIZE) return FALSE;
+
+  Length = HostToUtf8(Name, Path, EFIVARS_PATH_SIZE);
+  AsciiSPrint(Path + Length, EFIVARS_PATH_SIZE - Length, "-%g", Guid);
+  return TRUE;
+}
+
+// UTF-8 name part of a file name -> terminated UTF-16; FALSE if malformed.
+STATIC BOOLEAN
+NameFromUtf8(IN CONST CHAR8 *In, IN UINTN Length, OUT CHAR16 *Out)
+{
+  CONST UINT8 *s = (CONST UINT8 *)In;
+  UINTN n = 0;
+
+  for (UINTN i = 0; i < Length; ) {
+    if (s[i] < 0x80) {
+      Out[n++] = s[i];
+      i += 1;
+    } else if ((s[i] & 0xE0) == 0xC0 && i + 1 < Length) {
+      Out[n++] = (CHAR16)(((s[i] & 0x1F) << 6) | (s[i + 1] & 0x3F));
+      i += 2;
+    } else if ((s[i] & 0xF0) == 0xE0 && i + 2 < Length) {
+      Out[n++] = (CHAR16)(((s[i] & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F));
+      i += 3;
+    } else {
+      return FALSE;
+    }
+  }
+  Out[n] = L'\0';
+  return TRUE;
+}
+
+STATIC VOID
+ClearEntries(VOID)
+{
+  for (UINTN i = 0; i < mEntryCount; i++) FreePool(mEntries[i].Name);
+  mEntryCount = 0;
+  mLast = 0;
+}
+
+STATIC EFI_STATUS
+AddEntry(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid)
+{
+  EFIVARS_ENTRY *Entry;
+
+  if (mEntryCount == mEntryRoom) {
+    UINTN Room = MAX(2 * mEntryRoom, 64);
+    EFIVARS_ENTRY *New = ReallocatePool(mEntryRoom * sizeof(EFIVARS_ENTRY), Room * sizeof(EFIVARS_ENTRY), mEntries);
+    if (New == NULL) return EFI_OUT_OF_RESOURCES;
+    mEntries = New;
+    mEntryRoom = Room;
+  }
+
+  Entry = &mEntries[mEntryCount];
+  Entry->NameSize = StrSize(Name);
+  Entry->Name = AllocateCopyPool(Entry->NameSize, Name);
+  if (Entry->Name == NULL) return EFI_OUT_OF_RESOURCES;
+  CopyGuid(&Entry->Guid, Guid);
+  Entry->Deleted = FALSE;
+  mEntryCount++;
+  return EFI_SUCCESS;
+}
+
+// Anything not shaped <Name>-<guid> (lost+found, leftovers in a test
+// directory) is not a variable and is skipped.
+STATIC EFI_STATUS
+AddFile(IN CONST CHAR8 *File)
+{
+  UINTN Length = AsciiStrLen(File);
+  UINTN NameLength;
+  CHAR16 Name[EFIVARS_PATH_SIZE];
+  EFI_GUID Guid;
+
+  if (Length < EFIVARS_GUID_LENGTH + 2 || Length >= EFIVARS_PATH_SIZE) return EFI_SUCCESS;
+  NameLength = Length - EFIVARS_GUID_LENGTH - 1;
+  if (File[NameLength] != '-' || EFI_ERROR(AsciiStrToGuid(File + NameLength + 1, &Guid))) return EFI_SUCCESS;
+  if (!NameFromUtf8(File, NameLength, Name)) return EFI_SUCCESS;
+  return AddEntry(Name, &Guid);
+}
+
+STATIC EFI_STATUS
+Rescan(VOID)
+{
+  EFI_STATUS Status;
+
+  ClearEntries();
+  if (lseek(mDirFd, 0, SEEK_SET) < 0) return StatusFromErrno(errno);
+  if (!BufferReserve(SIZE_32KB)) return EFI_OUT_OF_RESOURCES;
+
+  while (TRUE) {
+    long Got = syscall(SYS_getdents64, mDirFd, mBuffer, mBufferSize);
+
+    if (Got < 0) return StatusFromErrno(errno);
+    if (Got == 0) return EFI_SUCCESS;
+
+    for (long Pos = 0; Pos < Got; ) {
+      DIRENT64 *Dirent = (DIRENT64 *)(mBuffer + Pos);
+
+      Pos += Dirent->RecordLength;
+      if (Dirent->Type == DT_DIR) continue;
+      Status = AddFile(Dirent->Name);
+      if (EFI_ERROR(Status)) return Status;
+    }
+  }
+}
+
+STATIC UINTN
+FindEntry(IN CONST CHAR16 *Name, IN CONST EFI_GUID *Guid)
+{
+  // a walk asks for the entry it was just given
+  if (mLast < mEntryCount && CompareGuid(&mEntries[mLast].Guid, Guid) && StrCmp(mEntries[mLast].Name, Name) == 0) {
+    return mLast;
+  }
+  for (UINTN i = 0; i < mEntryCount; i++) {
+    if (CompareGuid(&mEntries[i].Guid, Guid) && StrCmp(mEntries[i].Name, Name) == 0) return i;
+  }
+  return mEntryCount;
+}
+
+// Whole file into mBuffer; *Data points behind the attributes.
+STATIC EFI_STATUS
+ReadFile(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, OUT UINT8 **Data, OUT UINTN *DataSize)
+{
+  CHAR8 Path[EFIVARS_PATH_SIZE];
+  ssize_t Got = -1;
+  int Error = 0;
+  int Fd;
+
+  if (!FileName(Name, Guid, Path)) return EFI_NOT_FOUND;
+  Fd = openat(mDirFd, Path, O_RDONLY | O_CLOEXEC);
+  if (Fd < 0) return StatusFromErrno(errno);
+
+  while (BufferReserve(SIZE_4KB)) {
+    Got = pread(Fd, mBuffer, mBufferSize, 0);
+    if (Got < 0 || (UINTN)Got < mBufferSize) break;
+    if (!BufferReserve(2 * mBufferSize)) {
+      Got = -1;
+      errno = ENOMEM;
+      break;
+    }
+  }
+  Error = (Got < 0) ? errno : 0;
+  close(Fd);
+
+  if (Got < 0) return StatusFromErrno(Error);
+  // an empty file is a variable deleted while we looked
+  if ((UINTN)Got < sizeof(UINT32)) return EFI_NOT_FOUND;
+
+  if (Attributes != NULL) *Attributes = ReadUnaligned32((UINT32 *)mBuffer);
+  *Data = mBuffer + sizeof(UINT32);
+  *DataSize = (UINTN)Got - sizeof(UINT32);
+  return EFI_SUCCESS;
+}
+
+// TRUE if FS_IMMUTABLE_FL was changed to Immutable.
+STATIC BOOLEAN
+SetImmutable(IN CONST CHAR8 *Path, IN BOOLEAN Immutable)
+{
+  int Fd = openat(mDirFd, Path, O_RDONLY | O_CLOEXEC);
+  int Flags;
+  BOOLEAN Changed = FALSE;
+
+  if (Fd < 0) return FALSE;
+  if (ioctl(Fd, FS_IOC_GETFLAGS, &Flags) == 0 && ((Flags & FS_IMMUTABLE_FL) != 0) != Immutable) {
+    Flags ^= FS_IMMUTABLE_FL;
+    Changed = ioctl(Fd, FS_IOC_SETFLAGS, &Flags) == 0;
+  }
+  close(Fd);
+  return Changed;
+}
+
+// Only when the caller allowed it; the flag goes back on with SetImmutable.
+STATIC BOOLEAN
+Unprotect(IN CONST CHAR8 *Path, IN int Error)
+{
+  return mUnprotect && Error == EPERM && SetImmutable(Path, FALSE);
+}
+
+STATIC EFI_STATUS
+WriteFile(IN CONST CHAR8 *Path, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  BOOLEAN Append = (Attributes & EFI_VARIABLE_APPEND_WRITE) != 0;
+  int OpenFlags = O_WRONLY | O_CREAT | O_CLOEXEC;
+  BOOLEAN Unprotected = FALSE;
+  UINTN Start = 0;
+  ssize_t Put = -1;
+  int Error;
+  int Fd;
+
+  if (!BufferReserve(sizeof(UINT32) + DataSize)) return EFI_OUT_OF_RESOURCES;
+  WriteUnaligned32((UINT32 *)mBuffer, Attributes);
+  CopyMem(mBuffer + sizeof(UINT32), Data, DataSize);
+
+  // efivarfs replaces or appends by itself; a plain file has to be told
+  if (!mEfivarfs) OpenFlags |= Append ? O_APPEND : O_TRUNC;
+
+  Fd = openat(mDirFd, Path, OpenFlags, 0644);
+  Error = errno;
+  if (Fd < 0 && Unprotect(Path, Error)) {
+    Unprotected = TRUE;
+    Fd = openat(mDirFd, Path, OpenFlags, 0644);
+    Error = errno;
+  }
+
+  if (Fd >= 0) {
+    // appending to a plain file that already has its attributes adds data only
+    if (!mEfivarfs && Append && lseek(Fd, 0, SEEK_END) > 0) Start = sizeof(UINT32);
+
+    Put = write(Fd, mBuffer + Start, sizeof(UINT32) + DataSize - Start);
+    Error = errno;
+    close(Fd);
+  }
+
+  // written or not, the variable is still there and stays protected
+  if (Unprotected) SetImmutable(Path, TRUE);
+  if (Put < 0) return StatusFromErrno(Error);
+  return ((UINTN)Put == sizeof(UINT32) + DataSize - Start) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+EfivarsGetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, OUT UINT32 *Attributes OPTIONAL, IN OUT UINTN *DataSize, OUT VOID *Data OPTIONAL)
+{
+  EFI_STATUS Status;
+  UINT8 *Payload;
+  UINTN Size;
+
+  if (Name == NULL || Guid == NULL || DataSize == NULL) return EFI_INVALID_PARAMETER;
+
+  Status = ReadFile(Name, Guid, Attributes, &Payload, &Size);
+  if (EFI_ERROR(Status)) return Status;
+
+  if (*DataSize < Size) {
+    *DataSize = Size;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  if (Data == NULL && Size != 0) return EFI_INVALID_PARAMETER;
+
+  CopyMem(Data, Payload, Size);
+  *DataSize = Size;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+EfivarsGetNextVariableName(IN OUT UINTN *NameSize, IN OUT CHAR16 *Name, IN OUT EFI_GUID *Guid)
+{
+  EFI_STATUS Status;
+  EFIVARS_ENTRY *Entry;
+  UINTN Next = 0;
+
+  if (NameSize == NULL || Name == NULL || Guid == NULL) return EFI_INVALID_PARAMETER;
+
+  if (Name[0] == L'\0') {
+    Status = Rescan();
+    if (EFI_ERROR(Status)) return Status;
+  } else {
+    Next = FindEntry(Name, Guid);
+    if (Next == mEntryCount) return EFI_INVALID_PARAMETER;
+    Next++;
+  }
+  while (Next < mEntryCount && mEntries[Next].Deleted) Next++;
+  if (Next >= mEntryCount) return EFI_NOT_FOUND;
+
+  Entry = &mEntries[Next];
+  if (*NameSize < Entry->NameSize) {
+    *NameSize = Entry->NameSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  CopyMem(Name, Entry->Name, Entry->NameSize);
+  CopyGuid(Guid, &Entry->Guid);
+  *NameSize = Entry->NameSize;
+  mLast = Next;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+EFIAPI
+EfivarsSetVariable(IN CHAR16 *Name, IN EFI_GUID *Guid, IN UINT32 Attributes, IN UINTN DataSize, IN VOID *Data)
+{
+  EFI_STATUS Status;
+  CHAR8 Path[EFIVARS_PATH_SIZE];
+  UINTN Index;
+
+  if (Name == NULL || Guid == NULL || (DataSize != 0 && Data == NULL)) return EFI_INVALID_PARAMETER;
+  if (!FileName(Name, Guid, Path)) return EFI_INVALID_PARAMETER;
+
+  if (DataSize == 0 && (Attributes & EFI_VARIABLE_APPEND_WRITE) == 0) {
+    int Result = unlinkat(mDirFd, Path, 0);
+    int Error = errno;
+
+    if (Result != 0 && Unprotect(Path, Error)) {
+      Result = unlinkat(mDirFd, Path, 0);
+      Error = errno;
+      if (Result != 0) SetImmutable(Path, TRUE);
+    }
+    if (Result != 0) return StatusFromErrno(Error);
+
+    // kept in the listing so a walk can continue past it
+    Index = FindEntry(Name, Guid);
+    if (Index < mEntryCount) mEntries[Index].Deleted = TRUE;
+    return EFI_SUCCESS;
+  }
+
+  Status = WriteFile(Path, Attributes, DataSize, Data);
+  if (EFI_ERROR(Status)) return Status;
+
+  // a new variable joins the running walk at its end; the write itself
+  // succeeded even if it cannot be listed
+  Index = FindEntry(Name, Guid);
+  if (Index == mEntryCount) AddEntry(Name, Guid);
+  else mEntries[Index].Deleted = FALSE;
+  return EFI_SUCCESS;
+}
+
+// Recent kernels answer QueryVariableInfo through statfs on efivarfs;
+// older ones and plain directories have nothing to report.
+STATIC EFI_STATUS
+EFIAPI
+EfivarsQueryVariableInfo(IN UINT32 Attributes, OUT UINT64 *MaxStorage, OUT UINT64 *Remaining, OUT UINT64 *MaxVariableSize)
+{
+  struct statfs Info;
+
+  if (MaxStorage == NULL || Remaining == NULL || MaxVariableSize == NULL) return EFI_INVALID_PARAMETER;
+  if (!mEfivarfs || fstatfs(mDirFd, &Info) != 0 || Info.f_blocks == 0) return EFI_UNSUPPORTED;
+
+  *MaxStorage = (UINT64)Info.f_blocks * Info.f_bsize;
+  *Remaining = (UINT64)Info.f_bfree * Info.f_bsize;
+  *MaxVariableSize = *Remaining;      // not exported; bounded by what is left
+  return EFI_SUCCESS;
+}
+
+// No ReadInPlace: mBuffer is reused by every call, so payloads are copied
+// out (to the core's scratch buffer) like runtime services results.
+STATIC VAR_BACKEND mEfivarsBackend = {
+  L"efivarfs",
+  EfivarsGetVariable,
+  EfivarsGetNextVariableName,
+  EfivarsSetVariable,
+  EfivarsQueryVariableInfo,
+  NULL
+};
+
+VOID
+EfivarsBackendClose(VOID)
+{
+  if (gVarBackend == &mEfivarsBackend) VarBackendSelect(NULL);
+  ClearEntries();
+  if (mEntries != NULL) FreePool(mEntries);
+  if (mBuffer != NULL) FreePool(mBuffer);
+  if (mDirFd >= 0) close(mDirFd);
+  mUnprotect = FALSE;
+  mEntries = NULL;
+  mEntryRoom = 0;
+  mBuffer = NULL;
+  mBufferSize = 0;
+  mDirFd = -1;
+}
+
+VOID
+EfivarsAllowUnprotect(IN BOOLEAN Allow)
+{
+  mUnprotect = Allow;
+}
+
+EFI_STATUS
+EfivarsBackendOpen(IN CONST CHAR8 *Directory OPTIONAL, OUT VAR_BACKEND **Backend)
+{
+  struct statfs Info;
+
+  EfivarsBackendClose();
+
+  mDirFd = open((Directory != NULL) ? Directory : EFIVARS_DEFAULT_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (mDirFd < 0) return StatusFromErrno(errno);
+  mEfivarfs = fstatfs(mDirFd, &Info) == 0 && (UINT32)Info.f_type == EFIVARFS_MAGIC;
+
+  *Backend = &mEfivarsBackend;
+  return EFI_SUCCESS;
+}
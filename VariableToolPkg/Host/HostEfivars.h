@@ -0,0 +1,27 @@
+#ifndef HOST_EFIVARS_H_
+#define HOST_EFIVARS_H_
+
+#include "VariableTool.h"
+
+// =============================
+// efivarfs backend (HostEfivars.c)
+// Runs the tool core against a live Linux host: one file per variable,
+// named <Name>-<guid>, holding the UINT32 attributes and then the data.
+// =============================
+#define EFIVARS_DEFAULT_DIR  "/sys/firmware/efi/efivars"
+
+// Backend over Directory (NULL = EFIVARS_DEFAULT_DIR). Any directory laid
+// out the same way works, which is how the tests run without firmware.
+EFI_STATUS
+EfivarsBackendOpen(IN CONST CHAR8 *Directory OPTIONAL, OUT VAR_BACKEND **Backend);
+
+// Let writes and deletes clear FS_IMMUTABLE_FL on protected variables
+// (set again after each one). Off by default, so those return
+// EFI_WRITE_PROTECTED; call after EfivarsBackendOpen, which resets it.
+VOID
+EfivarsAllowUnprotect(IN BOOLEAN Allow);
+
+VOID
+EfivarsBackendClose(VOID);
+
+#endif
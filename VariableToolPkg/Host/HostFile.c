@@ -0,0 +1,155 @@
+#include "VariableTool.h"
+
+#include <stdio.h>
+
+// =============================
+// Files and console over stdio
+// Stands in for VarFile.c and the firmware console: tool paths are
+// ordinary host paths (UTF-16 in, UTF-8 on the host), ConOut is stdout.
+// =============================
+typedef struct {
+  EFI_FILE_PROTOCOL  Protocol;
+  FILE               *Stream;
+} HOST_FILE;
+
+UINTN
+HostToUtf8(IN CONST CHAR16 *In, OUT CHAR8 *Out, IN UINTN OutSize)
+{
+  UINTN n = 0;
+
+  for (; *In != 0 && n + 4 < OutSize; In++) {
+    CHAR16 c = *In;
+    if (c < 0x80) {
+      Out[n++] = (CHAR8)c;
+    } else if (c < 0x800) {
+      Out[n++] = (CHAR8)(0xC0 | (c >> 6));
+      Out[n++] = (CHAR8)(0x80 | (c & 0x3F));
+    } else {
+      Out[n++] = (CHAR8)(0xE0 | (c >> 12));
+      Out[n++] = (CHAR8)(0x80 | ((c >> 6) & 0x3F));
+      Out[n++] = (CHAR8)(0x80 | (c & 0x3F));
+    }
+  }
+  Out[n] = '\0';
+  return n;
+}
+
+STATIC EFI_STATUS
+HostClose(IN EFI_FILE_PROTOCOL *This)
+{
+  HOST_FILE *File = (HOST_FILE *)This;
+  BOOLEAN Failed = (fclose(File->Stream) != 0);
+
+  FreePool(File);
+  return Failed ? EFI_VOLUME_FULL : EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+HostRead(IN EFI_FILE_PROTOCOL *This, IN OUT UINTN *Size, OUT VOID *Buffer)
+{
+  HOST_FILE *File = (HOST_FILE *)This;
+
+  *Size = fread(Buffer, 1, *Size, File->Stream);
+  return ferror(File->Stream) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+HostWrite(IN EFI_FILE_PROTOCOL *This, IN OUT UINTN *Size, IN VOID *Buffer)
+{
+  HOST_FILE *File = (HOST_FILE *)This;
+
+  *Size = fwrite(Buffer, 1, *Size, File->Stream);
+  return ferror(File->Stream) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarFileOpen(IN CHAR16 *Path, IN BOOLEAN Create, OUT EFI_FILE_PROTOCOL **File)
+{
+  CHAR8 HostPath[4096];
+  HOST_FILE *Host;
+
+  if (Path == NULL || File == NULL) return EFI_INVALID_PARAMETER;
+  *File = NULL;
+
+  Host = AllocateZeroPool(sizeof(HOST_FILE));
+  if (Host == NULL) return EFI_OUT_OF_RESOURCES;
+
+  HostToUtf8(Path, HostPath, sizeof(HostPath));
+  Host->Stream = fopen(HostPath, Create ? "wb" : "rb");
+  if (Host->Stream == NULL) {
+    FreePool(Host);
+    return Create ? EFI_ACCESS_DENIED : EFI_NOT_FOUND;
+  }
+
+  Host->Protocol.Close = HostClose;
+  Host->Protocol.Read = HostRead;
+  Host->Protocol.Write = HostWrite;
+  *File = &Host->Protocol;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+VarFileReadAll(IN CHAR16 *Path, OUT VOID **Buffer, OUT UINTN *Size)
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File;
+  UINT8 *Data = NULL;
+  UINTN Used = 0;
+  UINTN Room = 0;
+
+  if (Buffer == NULL || Size == NULL) return EFI_INVALID_PARAMETER;
+  *Buffer = NULL;
+  *Size = 0;
+
+  Status = VarFileOpen(Path, FALSE, &File);
+  if (EFI_ERROR(Status)) return Status;
+
+  // no GetInfo here: grow until a short read
+  while (TRUE) {
+    UINTN Chunk;
+
+    if (Used == Room) {
+      UINT8 *New = ReallocatePool(Room, MAX(2 * Room, SIZE_64KB), Data);
+      if (New == NULL) { Status = EFI_OUT_OF_RESOURCES; break; }
+      Data = New;
+      Room = MAX(2 * Room, SIZE_64KB);
+    }
+    Chunk = Room - Used;
+    Status = File->Read(File, &Chunk, Data + Used);
+    if (EFI_ERROR(Status) || Chunk == 0) break;
+    Used += Chunk;
+  }
+  File->Close(File);
+
+  if (EFI_ERROR(Status)) {
+    if (Data != NULL) FreePool(Data);
+    return Status;
+  }
+  *Buffer = Data;
+  *Size = Used;
+  return EFI_SUCCESS;
+}
+
+// ConOut: the writer's console sink emits "\r\n"; stdout wants "\n".
+STATIC EFI_STATUS
+HostOutputString(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN CHAR16 *String)
+{
+  CHAR8 Line[1024];
+
+  while (*String != 0) {
+    UINTN n = 0;
+
+    for (; *String != 0 && n + 4 < sizeof(Line); String++) {
+      CHAR16 One[2] = { *String, 0 };
+      if (*String == L'\r') continue;
+      n += HostToUtf8(One, Line + n, sizeof(Line) - n);
+    }
+    fwrite(Line, 1, n, stdout);
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL mHostConOut = { HostOutputString };
+STATIC EFI_SYSTEM_TABLE mHostSystemTable = { &mHostConOut };
+
+EFI_SYSTEM_TABLE *gST = &mHostSystemTable;
@@ -0,0 +1,238 @@
+#include "HostEfi.h"
+
+// =============================
+// BaseLib pieces the shim cannot inline
+// =============================
+// CRC-32 as in EDK2 BaseLib (reflected, polynomial 0xEDB88320).
+UINT32
+CalculateCrc32(VOID *Buffer, UINTN Length)
+{
+  STATIC UINT32 Table[256];
+  STATIC BOOLEAN Ready = FALSE;
+  CONST UINT8 *p = Buffer;
+  UINT32 Crc = 0xFFFFFFFF;
+
+  if (!Ready) {
+    for (UINT32 i = 0; i < 256; i++) {
+      UINT32 c = i;
+      for (UINTN k = 0; k < 8; k++) {
+        c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : (c >> 1);
+      }
+      Table[i] = c;
+    }
+    __atomic_store_n(&Ready, TRUE, __ATOMIC_RELEASE);
+  }
+
+  while (Length-- > 0) {
+    Crc = Table[(Crc ^ *p++) & 0xFF] ^ (Crc >> 8);
+  }
+  return Crc ^ 0xFFFFFFFF;
+}
+
+VOID *
+AllocateCopyPool(UINTN Size, CONST VOID *Buffer)
+{
+  VOID *Copy = malloc(MAX(Size, 1));
+
+  if (Copy != NULL) memcpy(Copy, Buffer, Size);
+  return Copy;
+}
+
+// =============================
+// Strings
+// =============================
+UINTN
+StrLen(CONST CHAR16 *String)
+{
+  UINTN Length = 0;
+
+  while (String[Length] != 0) Length++;
+  return Length;
+}
+
+UINTN
+StrSize(CONST CHAR16 *String)
+{
+  return (StrLen(String) + 1) * sizeof(CHAR16);
+}
+
+INTN
+StrCmp(CONST CHAR16 *First, CONST CHAR16 *Second)
+{
+  while (*First != 0 && *First == *Second) {
+    First++;
+    Second++;
+  }
+  return (INTN)*First - (INTN)*Second;
+}
+
+UINTN
+AsciiStrLen(CONST CHAR8 *String)
+{
+  return strlen(String);
+}
+
+UINTN
+AsciiStrSize(CONST CHAR8 *String)
+{
+  return strlen(String) + 1;
+}
+
+STATIC BOOLEAN
+ParseHex(CONST CHAR8 **Text, UINTN Digits, UINT64 *Value)
+{
+  *Value = 0;
+  for (UINTN i = 0; i < Digits; i++) {
+    CHAR8 c = (*Text)[i];
+    UINT8 Nibble;
+
+    if (c >= '0' && c <= '9') Nibble = c - '0';
+    else if (c >= 'a' && c <= 'f') Nibble = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') Nibble = c - 'A' + 10;
+    else return FALSE;
+    *Value = (*Value << 4) | Nibble;
+  }
+  *Text += Digits;
+  return TRUE;
+}
+
+// "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" as in BaseLib
+EFI_STATUS
+AsciiStrToGuid(CONST CHAR8 *String, EFI_GUID *Guid)
+{
+  UINT64 Value;
+  EFI_GUID Out;
+
+  if (!ParseHex(&String, 8, &Value) || *String++ != '-') return EFI_UNSUPPORTED;
+  Out.Data1 = (UINT32)Value;
+  if (!ParseHex(&String, 4, &Value) || *String++ != '-') return EFI_UNSUPPORTED;
+  Out.Data2 = (UINT16)Value;
+  if (!ParseHex(&String, 4, &Value) || *String++ != '-') return EFI_UNSUPPORTED;
+  Out.Data3 = (UINT16)Value;
+  for (UINTN i = 0; i < 8; i++) {
+    if (i == 2 && *String++ != '-') return EFI_UNSUPPORTED;
+    if (!ParseHex(&String, 2, &Value)) return EFI_UNSUPPORTED;
+    Out.Data4[i] = (UINT8)Value;
+  }
+  CopyGuid(Guid, &Out);
+  return EFI_SUCCESS;
+}
+
+// =============================
+// Doubly linked lists
+// =============================
+LIST_ENTRY *
+InitializeListHead(LIST_ENTRY *ListHead)
+{
+  ListHead->ForwardLink = ListHead;
+  ListHead->BackLink = ListHead;
+  return ListHead;
+}
+
+LIST_ENTRY *
+InsertHeadList(LIST_ENTRY *ListHead, LIST_ENTRY *Entry)
+{
+  Entry->ForwardLink = ListHead->ForwardLink;
+  Entry->BackLink = ListHead;
+  Entry->ForwardLink->BackLink = Entry;
+  ListHead->ForwardLink = Entry;
+  return ListHead;
+}
+
+LIST_ENTRY *
+InsertTailList(LIST_ENTRY *ListHead, LIST_ENTRY *Entry)
+{
+  Entry->ForwardLink = ListHead;
+  Entry->BackLink = ListHead->BackLink;
+  Entry->BackLink->ForwardLink = Entry;
+  ListHead->BackLink = Entry;
+  return ListHead;
+}
+
+LIST_ENTRY *
+GetFirstNode(CONST LIST_ENTRY *List)
+{
+  return List->ForwardLink;
+}
+
+LIST_ENTRY *
+GetNextNode(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node)
+{
+  return Node->ForwardLink;
+}
+
+LIST_ENTRY *
+GetPreviousNode(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node)
+{
+  return Node->BackLink;
+}
+
+BOOLEAN
+IsNull(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node)
+{
+  return List == Node;
+}
+
+BOOLEAN
+IsListEmpty(CONST LIST_ENTRY *ListHead)
+{
+  return ListHead->ForwardLink == ListHead;
+}
+
+LIST_ENTRY *
+RemoveEntryList(CONST LIST_ENTRY *Entry)
+{
+  Entry->ForwardLink->BackLink = Entry->BackLink;
+  Entry->BackLink->ForwardLink = Entry->ForwardLink;
+  return Entry->ForwardLink;
+}
+
+// =============================
+// GUIDs and runtime services
+// There is no firmware underneath: every runtime service reports
+// EFI_UNSUPPORTED, so the tool core only sees variables through a backend
+// such as a store image (VarStore.c).
+// =============================
+EFI_GUID gEfiGlobalVariableGuid        = { 0x8BE4DF61, 0x93CA, 0x11D2, { 0xAA, 0x0D, 0x00, 0xE0, 0x98, 0x03, 0x2B, 0x8C } };
+EFI_GUID gEfiImageSecurityDatabaseGuid = { 0xD719B2CB, 0x3D3A, 0x4596, { 0xA3, 0xBC, 0xDA, 0xD0, 0x0E, 0x67, 0x65, 0x6F } };
+EFI_GUID gEfiCertPkcs7Guid             = { 0x4AAFD29D, 0x68DF, 0x49EE, { 0x8A, 0xA9, 0x34, 0x7D, 0x37, 0x56, 0x65, 0xA7 } };
+
+STATIC EFI_STATUS
+HostGetTime(EFI_TIME *Time, VOID *Capabilities)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS
+HostGetVariable(CHAR16 *Name, EFI_GUID *Guid, UINT32 *Attributes, UINTN *DataSize, VOID *Data)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS
+HostGetNextVariableName(UINTN *NameSize, CHAR16 *Name, EFI_GUID *Guid)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS
+HostSetVariable(CHAR16 *Name, EFI_GUID *Guid, UINT32 Attributes, UINTN DataSize, VOID *Data)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS
+HostQueryVariableInfo(UINT32 Attributes, UINT64 *MaxStorage, UINT64 *Remaining, UINT64 *MaxVariableSize)
+{
+  return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_RUNTIME_SERVICES mHostRuntime = {
+  HostGetTime,
+  HostGetVariable,
+  HostGetNextVariableName,
+  HostSetVariable,
+  HostQueryVariableInfo
+};
+
+EFI_RUNTIME_SERVICES *gRT = &mHostRuntime;
@@ -0,0 +1,125 @@
+#include "VariableTool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+// =============================
+// Host work queue (pthreads)
+// Same contract as VarMp.c: worker 0 is the calling thread, the others
+// come from a pool created on first use and kept for the process lifetime.
+// Jobs are pulled from one shared counter exactly as the APs do.
+// =============================
+#define HOST_MP_MAX_WORKERS  64
+
+typedef struct {
+  VAR_MP_WORK      Work;
+  VOID             *Context;
+  UINT32           JobCount;
+  UINT32           Workers;
+  volatile UINT32  NextJob;
+} MP_QUEUE;
+
+STATIC pthread_mutex_t mLock = PTHREAD_MUTEX_INITIALIZER;
+STATIC pthread_cond_t mStart = PTHREAD_COND_INITIALIZER;
+STATIC pthread_cond_t mFinished = PTHREAD_COND_INITIALIZER;
+STATIC MP_QUEUE *mCurrent = NULL;
+STATIC UINT64 mGeneration = 0;
+STATIC UINTN mRunning = 0;
+STATIC UINTN mPoolSize = 0;     // threads besides the caller
+STATIC UINTN mOnline = 0;
+STATIC UINTN mLimit = 0;
+STATIC UINT64 mJoinGeneration[HOST_MP_MAX_WORKERS];   // last run before the thread existed
+
+STATIC VOID
+RunJobs(IN MP_QUEUE *Q, IN UINTN Worker)
+{
+  while (TRUE) {
+    UINT32 Job = InterlockedIncrement(&Q->NextJob) - 1;
+    if (Job >= Q->JobCount) break;
+    Q->Work(Q->Context, Job, Worker);
+  }
+}
+
+STATIC VOID *
+PoolThread(IN VOID *Arg)
+{
+  UINTN Worker = (UINTN)Arg;
+  UINT64 Seen = mJoinGeneration[Worker];
+
+  while (TRUE) {
+    MP_QUEUE *Q;
+
+    pthread_mutex_lock(&mLock);
+    while (mGeneration == Seen) pthread_cond_wait(&mStart, &mLock);
+    Seen = mGeneration;
+    Q = mCurrent;
+    pthread_mutex_unlock(&mLock);
+
+    if (Worker < Q->Workers) RunJobs(Q, Worker);
+
+    pthread_mutex_lock(&mLock);
+    if (--mRunning == 0) pthread_cond_signal(&mFinished);
+    pthread_mutex_unlock(&mLock);
+  }
+  return NULL;
+}
+
+UINTN
+VarMpWorkerCount(VOID)
+{
+  if (mOnline == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    mOnline = (n < 1) ? 1 : MIN((UINTN)n, HOST_MP_MAX_WORKERS);
+  }
+  // unlike firmware, an explicit limit may oversubscribe (tests on small hosts)
+  return (mLimit != 0) ? MIN(mLimit, HOST_MP_MAX_WORKERS) : mOnline;
+}
+
+VOID
+VarMpSetLimit(IN UINTN Limit)
+{
+  mLimit = Limit;
+}
+
+VOID
+VarMpRun(IN VAR_MP_WORK Work, IN VOID *Context, IN UINTN JobCount)
+{
+  MP_QUEUE Q;
+
+  ZeroMem(&Q, sizeof(Q));
+  Q.Work = Work;
+  Q.Context = Context;
+  Q.JobCount = (UINT32)JobCount;
+  Q.Workers = (UINT32)VarMpWorkerCount();
+
+  if (Q.Workers < 2 || JobCount < 2) {
+    RunJobs(&Q, 0);
+    return;
+  }
+
+  // the pool only grows; idle threads skip runs with fewer workers
+  while (mPoolSize + 1 < Q.Workers) {
+    pthread_t Thread;
+    mJoinGeneration[mPoolSize + 1] = mGeneration;
+    if (pthread_create(&Thread, NULL, PoolThread, (VOID *)(mPoolSize + 1)) != 0) break;
+    pthread_detach(Thread);
+    mPoolSize++;
+  }
+  if (mPoolSize == 0) {
+    RunJobs(&Q, 0);
+    return;
+  }
+
+  pthread_mutex_lock(&mLock);
+  mCurrent = &Q;
+  mRunning = mPoolSize;
+  mGeneration++;
+  pthread_cond_broadcast(&mStart);
+  pthread_mutex_unlock(&mLock);
+
+  RunJobs(&Q, 0);
+
+  pthread_mutex_lock(&mLock);
+  while (mRunning != 0) pthread_cond_wait(&mFinished, &mLock);
+  pthread_mutex_unlock(&mLock);
+}
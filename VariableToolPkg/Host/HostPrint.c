@@ -0,0 +1,182 @@
+#include "HostEfi.h"
+
+#include <stdio.h>
+
+// =============================
+// PrintLib subset
+// EDK2 semantics, not libc ones: %s is a CHAR16 string and %a an ASCII
+// one, %r prints an EFI_STATUS by name and %g a GUID. Output is always
+// terminated and silently truncated to BufferSize.
+// =============================
+STATIC CONST CHAR8 *mStatusNames[] = {
+  "Success",              "Load Error",         "Invalid Parameter",  "Unsupported",
+  "Bad Buffer Size",      "Buffer Too Small",   "Not Ready",          "Device Error",
+  "Write Protected",      "Out of Resources",   "Volume Corrupt",     "Volume Full",
+  "No Media",             "Media changed",      "Not Found",          "Access Denied",
+  "No Response",          "No mapping",         "Time out",           "Not started",
+  "Already started",      "Aborted",            "ICMP Error",         "TFTP Error",
+  "Protocol Error",       "Incompatible Version", "Security Violation", "CRC Error",
+  "End of Media",         "Reserved (29)",      "Reserved (30)",      "End of File",
+  "Invalid Language",     "Compromised Data"
+};
+
+typedef struct {
+  CHAR8  *Buffer;
+  UINTN  Size;          // room, terminator included
+  UINTN  Used;
+} PRINT_OUT;
+
+STATIC VOID
+PutChar(IN OUT PRINT_OUT *Out, IN CHAR8 c)
+{
+  if (Out->Used + 1 < Out->Size) Out->Buffer[Out->Used++] = c;
+}
+
+// Field of Length characters taken from Ascii or Wide, padded to Width.
+STATIC VOID
+PutField(IN OUT PRINT_OUT *Out, IN CONST CHAR8 *Ascii, IN CONST CHAR16 *Wide, IN UINTN Length,
+         IN UINTN Width, IN BOOLEAN Left, IN CHAR8 Pad)
+{
+  UINTN Fill = (Width > Length) ? Width - Length : 0;
+
+  if (!Left) while (Fill-- > 0) PutChar(Out, Pad);
+  for (UINTN i = 0; i < Length; i++) {
+    // non-ASCII CHAR16 has no single-byte form here
+    PutChar(Out, (Ascii != NULL) ? Ascii[i] : (Wide[i] < 0x80 ? (CHAR8)Wide[i] : '?'));
+  }
+  if (Left) while (Fill-- > 0) PutChar(Out, ' ');
+}
+
+STATIC UINTN
+FormatNumber(IN UINT64 Value, IN UINTN Radix, IN BOOLEAN Upper, OUT CHAR8 *Text)
+{
+  CONST CHAR8 *Digits = Upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  CHAR8 Reverse[24];
+  UINTN n = 0;
+  UINTN Length = 0;
+
+  do {
+    Reverse[n++] = Digits[Value % Radix];
+    Value /= Radix;
+  } while (Value != 0);
+  while (n > 0) Text[Length++] = Reverse[--n];
+  return Length;
+}
+
+UINTN
+AsciiVSPrint(CHAR8 *Buffer, UINTN BufferSize, CONST CHAR8 *Format, VA_LIST Marker)
+{
+  PRINT_OUT Out = { Buffer, BufferSize, 0 };
+  va_list Args;
+
+  if (Buffer == NULL || BufferSize == 0) return 0;
+  va_copy(Args, Marker);
+
+  for (; *Format != '\0'; Format++) {
+    BOOLEAN Left = FALSE;
+    BOOLEAN Long = FALSE;
+    CHAR8 Pad = ' ';
+    UINTN Width = 0;
+    CHAR8 Text[48];
+    UINTN Length;
+
+    if (*Format != '%') {
+      PutChar(&Out, *Format);
+      continue;
+    }
+
+    for (Format++; *Format == '-' || *Format == '0'; Format++) {
+      if (*Format == '-') Left = TRUE;
+      else Pad = '0';
+    }
+    for (; *Format >= '0' && *Format <= '9'; Format++) Width = Width * 10 + (*Format - '0');
+    if (*Format == 'l' || *Format == 'L') {
+      Long = TRUE;
+      Format++;
+    }
+
+    switch (*Format) {
+    case 'a': {
+      CONST CHAR8 *s = va_arg(Args, CONST CHAR8 *);
+      if (s == NULL) s = "<null string>";
+      PutField(&Out, s, NULL, strlen(s), Width, Left, ' ');
+      break;
+    }
+    case 's': {
+      CONST CHAR16 *s = va_arg(Args, CONST CHAR16 *);
+      if (s == NULL) PutField(&Out, "<null string>", NULL, 13, Width, Left, ' ');
+      else PutField(&Out, NULL, s, StrLen(s), Width, Left, ' ');
+      break;
+    }
+    case 'c':
+      Text[0] = (CHAR8)va_arg(Args, int);      // promoted CHAR8/CHAR16
+      PutField(&Out, Text, NULL, 1, Width, Left, ' ');
+      break;
+    case 'd': {
+      INT64 Value = Long ? va_arg(Args, INT64) : va_arg(Args, INT32);
+      UINTN Sign = (Value < 0) ? 1 : 0;
+      if (Sign) Text[0] = '-';
+      Length = Sign + FormatNumber(Sign ? (UINT64)-Value : (UINT64)Value, 10, FALSE, Text + Sign);
+      PutField(&Out, Text, NULL, Length, Width, Left, Pad);
+      break;
+    }
+    case 'u':
+    case 'x':
+    case 'X': {
+      UINT64 Value = Long ? va_arg(Args, UINT64) : va_arg(Args, UINT32);
+      Length = FormatNumber(Value, (*Format == 'u') ? 10 : 16, *Format == 'X', Text);
+      PutField(&Out, Text, NULL, Length, Width, Left, Pad);
+      break;
+    }
+    case 'p':
+      Length = FormatNumber((UINT64)(UINTN)va_arg(Args, VOID *), 16, TRUE, Text);
+      PutField(&Out, Text, NULL, Length, Width, Left, Pad);
+      break;
+    case 'r': {
+      EFI_STATUS Status = va_arg(Args, EFI_STATUS);
+      UINTN Code = Status & ~MAX_BIT;
+      if ((Status == EFI_SUCCESS || EFI_ERROR(Status)) && Code < ARRAY_SIZE(mStatusNames)) {
+        PutField(&Out, mStatusNames[Code], NULL, strlen(mStatusNames[Code]), Width, Left, ' ');
+      } else {
+        Length = FormatNumber(Status, 16, TRUE, Text);
+        PutField(&Out, Text, NULL, Length, Width, Left, ' ');
+      }
+      break;
+    }
+    case 'g': {
+      CONST EFI_GUID *Guid = va_arg(Args, CONST EFI_GUID *);
+      Length = (UINTN)snprintf(Text, sizeof(Text), "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                               Guid->Data1, Guid->Data2, Guid->Data3, Guid->Data4[0], Guid->Data4[1],
+                               Guid->Data4[2], Guid->Data4[3], Guid->Data4[4], Guid->Data4[5],
+                               Guid->Data4[6], Guid->Data4[7]);
+      PutField(&Out, Text, NULL, Length, Width, Left, ' ');
+      break;
+    }
+    case '%':
+      PutChar(&Out, '%');
+      break;
+    default:
+      // unknown conversion: copy it through so the mistake is visible
+      PutChar(&Out, '%');
+      if (*Format == '\0') Format--;
+      else PutChar(&Out, *Format);
+      break;
+    }
+  }
+
+  va_end(Args);
+  Buffer[Out.Used] = '\0';
+  return Out.Used;
+}
+
+UINTN
+AsciiSPrint(CHAR8 *Buffer, UINTN BufferSize, CONST CHAR8 *Format, ...)
+{
+  VA_LIST Marker;
+  UINTN Length;
+
+  VA_START(Marker, Format);
+  Length = AsciiVSPrint(Buffer, BufferSize, Format, Marker);
+  VA_END(Marker);
+  return Length;
+}
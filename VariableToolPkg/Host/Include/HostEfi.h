@@ -0,0 +1,250 @@
+#ifndef HOST_EFI_H_
+#define HOST_EFI_H_
+
+// =============================
+// Host build shim
+// Just enough of the EDK2 base types and libraries for the pure-compute
+// modules of VariableTool (hashing, LZ codec, work queue) and the tool core
+// over a store image (catalog, dump, export) to build and run as a normal
+// user-space program. Runtime services are present but report
+// EFI_UNSUPPORTED; files and the console map to stdio (HostFile.c).
+// =============================
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef uint8_t   UINT8;
+typedef uint16_t  UINT16;
+typedef uint32_t  UINT32;
+typedef uint64_t  UINT64;
+typedef int8_t    INT8;
+typedef int16_t   INT16;
+typedef int32_t   INT32;
+typedef int64_t   INT64;
+typedef uintptr_t UINTN;
+typedef intptr_t  INTN;
+typedef char      CHAR8;
+typedef uint16_t  CHAR16;
+typedef uint8_t   BOOLEAN;
+
+#define VOID      void
+#define CONST     const
+#define STATIC    static
+#define IN
+#define OUT
+#define OPTIONAL
+#define EFIAPI
+#define TRUE      ((BOOLEAN)1)
+#define FALSE     ((BOOLEAN)0)
+
+#define VA_LIST   va_list
+#define VA_START  va_start
+#define VA_END    va_end
+#define VA_ARG    va_arg
+
+typedef UINTN EFI_STATUS;
+typedef VOID  *EFI_HANDLE;
+typedef VOID  *EFI_EVENT;
+
+#define MAX_BIT                 ((UINTN)1 << (sizeof(UINTN) * 8 - 1))
+#define ENCODE_ERROR(a)         ((EFI_STATUS)(MAX_BIT | (a)))
+#define EFI_ERROR(a)            (((INTN)(EFI_STATUS)(a)) < 0)
+#define EFI_SUCCESS             0
+#define EFI_INVALID_PARAMETER   ENCODE_ERROR(2)
+#define EFI_UNSUPPORTED         ENCODE_ERROR(3)
+#define EFI_BAD_BUFFER_SIZE     ENCODE_ERROR(4)
+#define EFI_BUFFER_TOO_SMALL    ENCODE_ERROR(5)
+#define EFI_DEVICE_ERROR        ENCODE_ERROR(7)
+#define EFI_WRITE_PROTECTED     ENCODE_ERROR(8)
+#define EFI_OUT_OF_RESOURCES    ENCODE_ERROR(9)
+#define EFI_VOLUME_CORRUPTED    ENCODE_ERROR(10)
+#define EFI_VOLUME_FULL         ENCODE_ERROR(11)
+#define EFI_NOT_FOUND           ENCODE_ERROR(14)
+#define EFI_ACCESS_DENIED       ENCODE_ERROR(15)
+#define EFI_CRC_ERROR           ENCODE_ERROR(27)
+#define EFI_END_OF_FILE         ENCODE_ERROR(31)
+#define EFI_COMPROMISED_DATA    ENCODE_ERROR(33)
+
+typedef struct {
+  UINT32  Data1;
+  UINT16  Data2;
+  UINT16  Data3;
+  UINT8   Data4[8];
+} EFI_GUID;
+
+typedef struct {
+  UINT16  Year;
+  UINT8   Month, Day, Hour, Minute, Second, Pad1;
+  UINT32  Nanosecond;
+  INT16   TimeZone;
+  UINT8   Daylight, Pad2;
+} EFI_TIME;
+
+// Only what the tool calls on files and the console.
+typedef struct _EFI_FILE_PROTOCOL EFI_FILE_PROTOCOL;
+struct _EFI_FILE_PROTOCOL {
+  EFI_STATUS  (*Close)(EFI_FILE_PROTOCOL *This);
+  EFI_STATUS  (*Read)(EFI_FILE_PROTOCOL *This, UINTN *Size, VOID *Buffer);
+  EFI_STATUS  (*Write)(EFI_FILE_PROTOCOL *This, UINTN *Size, VOID *Buffer);
+};
+
+typedef struct _EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL;
+struct _EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL {
+  EFI_STATUS  (*OutputString)(EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, CHAR16 *String);
+};
+
+typedef struct {
+  EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *ConOut;
+} EFI_SYSTEM_TABLE;
+
+typedef EFI_STATUS (*EFI_GET_TIME)(EFI_TIME *Time, VOID *Capabilities);
+typedef EFI_STATUS (*EFI_GET_VARIABLE)(CHAR16 *Name, EFI_GUID *Guid, UINT32 *Attributes, UINTN *DataSize, VOID *Data);
+typedef EFI_STATUS (*EFI_GET_NEXT_VARIABLE_NAME)(UINTN *NameSize, CHAR16 *Name, EFI_GUID *Guid);
+typedef EFI_STATUS (*EFI_SET_VARIABLE)(CHAR16 *Name, EFI_GUID *Guid, UINT32 Attributes, UINTN DataSize, VOID *Data);
+typedef EFI_STATUS (*EFI_QUERY_VARIABLE_INFO)(UINT32 Attributes, UINT64 *MaxStorage, UINT64 *Remaining, UINT64 *MaxVariableSize);
+
+typedef struct {
+  EFI_GET_TIME                GetTime;
+  EFI_GET_VARIABLE            GetVariable;
+  EFI_GET_NEXT_VARIABLE_NAME  GetNextVariableName;
+  EFI_SET_VARIABLE            SetVariable;
+  EFI_QUERY_VARIABLE_INFO     QueryVariableInfo;
+} EFI_RUNTIME_SERVICES;
+
+extern EFI_SYSTEM_TABLE      *gST;
+extern EFI_RUNTIME_SERVICES  *gRT;
+
+typedef struct _LIST_ENTRY LIST_ENTRY;
+struct _LIST_ENTRY {
+  LIST_ENTRY  *ForwardLink;
+  LIST_ENTRY  *BackLink;
+};
+
+#define INITIALIZE_LIST_HEAD_VARIABLE(ListHead)  { &(ListHead), &(ListHead) }
+
+// Guid/GlobalVariable.h, Guid/ImageAuthentication.h (GUIDs in HostLib.c)
+#define EFI_PLATFORM_KEY_NAME          L"PK"
+#define EFI_KEY_EXCHANGE_KEY_NAME      L"KEK"
+#define EFI_IMAGE_SECURITY_DATABASE    L"db"
+#define EFI_IMAGE_SECURITY_DATABASE1   L"dbx"
+#define EFI_IMAGE_SECURITY_DATABASE2   L"dbt"
+#define WIN_CERT_TYPE_EFI_GUID         0x0EF1
+
+typedef struct {
+  UINT32  dwLength;
+  UINT16  wRevision;
+  UINT16  wCertificateType;
+} WIN_CERTIFICATE;
+
+typedef struct {
+  WIN_CERTIFICATE  Hdr;
+  EFI_GUID         CertType;
+  UINT8            CertData[1];
+} WIN_CERTIFICATE_UEFI_GUID;
+
+typedef struct {
+  EFI_TIME                   TimeStamp;
+  WIN_CERTIFICATE_UEFI_GUID  AuthInfo;
+} EFI_VARIABLE_AUTHENTICATION_2;
+
+extern EFI_GUID gEfiGlobalVariableGuid;
+extern EFI_GUID gEfiImageSecurityDatabaseGuid;
+extern EFI_GUID gEfiCertPkcs7Guid;
+
+#define MIN(a, b)              (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)              (((a) > (b)) ? (a) : (b))
+#define ARRAY_SIZE(a)          (sizeof(a) / sizeof((a)[0]))
+#define OFFSET_OF(TYPE, Field)  ((UINTN)offsetof(TYPE, Field))
+#define BASE_CR(Record, TYPE, Field)  ((TYPE *)((CHAR8 *)(Record) - offsetof(TYPE, Field)))
+#define ALIGN_VALUE(v, a)      ((v) + (((a) - (v)) & ((a) - 1)))
+#define SIGNATURE_16(A, B)     ((A) | ((B) << 8))
+#define SIGNATURE_32(A, B, C, D)  (SIGNATURE_16(A, B) | (SIGNATURE_16(C, D) << 16))
+
+#define BIT0  0x00000001
+#define BIT1  0x00000002
+#define BIT2  0x00000004
+#define BIT3  0x00000008
+#define BIT4  0x00000010
+#define BIT5  0x00000020
+#define BIT6  0x00000040
+#define BIT7  0x00000080
+#define BIT31 0x80000000
+
+#define SIZE_1KB    0x00000400
+#define SIZE_4KB    0x00001000
+#define SIZE_32KB   0x00008000
+#define SIZE_64KB   0x00010000
+#define SIZE_256KB  0x00040000
+#define SIZE_1MB    0x00100000
+#define SIZE_2MB    0x00200000
+#define SIZE_16MB   0x01000000
+
+#define MAX_UINT8   0xFF
+#define MAX_UINT16  0xFFFF
+#define MAX_UINT32  0xFFFFFFFFU
+#define MAX_UINTN   UINTPTR_MAX
+
+#define EFI_VARIABLE_NON_VOLATILE                           0x00000001
+#define EFI_VARIABLE_BOOTSERVICE_ACCESS                     0x00000002
+#define EFI_VARIABLE_RUNTIME_ACCESS                         0x00000004
+#define EFI_VARIABLE_HARDWARE_ERROR_RECORD                  0x00000008
+#define EFI_VARIABLE_AUTHENTICATED_WRITE_ACCESS             0x00000010
+#define EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS  0x00000020
+#define EFI_VARIABLE_APPEND_WRITE                           0x00000040
+
+// BaseMemoryLib / MemoryAllocationLib
+// BaseMemoryLib allows NULL with a zero length, libc does not
+static inline VOID *CopyMem(VOID *D, CONST VOID *S, UINTN N) { return (N != 0) ? memmove(D, S, N) : D; }
+static inline VOID *SetMem(VOID *D, UINTN N, UINT8 V) { return memset(D, V, N); }
+static inline VOID *ZeroMem(VOID *D, UINTN N) { return memset(D, 0, N); }
+static inline INTN CompareMem(CONST VOID *A, CONST VOID *B, UINTN N) { return (N != 0) ? memcmp(A, B, N) : 0; }
+static inline BOOLEAN CompareGuid(CONST EFI_GUID *A, CONST EFI_GUID *B) { return memcmp(A, B, sizeof(*A)) == 0; }
+static inline EFI_GUID *CopyGuid(EFI_GUID *D, CONST EFI_GUID *S) { return memcpy(D, S, sizeof(*D)); }
+static inline VOID *AllocatePool(UINTN N) { return malloc(N); }
+static inline VOID *AllocateZeroPool(UINTN N) { return calloc(1, N); }
+static inline VOID *ReallocatePool(UINTN Old, UINTN New, VOID *P) { (void)Old; return realloc(P, New); }
+static inline VOID FreePool(VOID *P) { free(P); }
+
+// BaseLib / SynchronizationLib
+static inline UINT16 ReadUnaligned16(CONST UINT16 *P) { UINT16 V; memcpy(&V, P, sizeof(V)); return V; }
+static inline UINT32 ReadUnaligned32(CONST UINT32 *P) { UINT32 V; memcpy(&V, P, sizeof(V)); return V; }
+static inline UINT64 ReadUnaligned64(CONST UINT64 *P) { UINT64 V; memcpy(&V, P, sizeof(V)); return V; }
+static inline UINT16 WriteUnaligned16(UINT16 *P, UINT16 V) { memcpy(P, &V, sizeof(V)); return V; }
+static inline UINT32 WriteUnaligned32(UINT32 *P, UINT32 V) { memcpy(P, &V, sizeof(V)); return V; }
+static inline UINT64 WriteUnaligned64(UINT64 *P, UINT64 V) { memcpy(P, &V, sizeof(V)); return V; }
+static inline UINT32 SwapBytes32(UINT32 V) { return __builtin_bswap32(V); }
+static inline UINT32 InterlockedIncrement(volatile UINT32 *V) { return __atomic_add_fetch(V, 1, __ATOMIC_SEQ_CST); }
+UINT32 CalculateCrc32(VOID *Buffer, UINTN Length);
+VOID *AllocateCopyPool(UINTN Size, CONST VOID *Buffer);
+
+// Strings (HostLib.c); CHAR16 is UTF-16 as in firmware, not wchar_t
+UINTN StrLen(CONST CHAR16 *String);
+UINTN StrSize(CONST CHAR16 *String);
+INTN StrCmp(CONST CHAR16 *First, CONST CHAR16 *Second);
+UINTN AsciiStrLen(CONST CHAR8 *String);
+UINTN AsciiStrSize(CONST CHAR8 *String);
+EFI_STATUS AsciiStrToGuid(CONST CHAR8 *String, EFI_GUID *Guid);
+
+// Linked lists (HostLib.c)
+LIST_ENTRY *InitializeListHead(LIST_ENTRY *ListHead);
+LIST_ENTRY *InsertHeadList(LIST_ENTRY *ListHead, LIST_ENTRY *Entry);
+LIST_ENTRY *InsertTailList(LIST_ENTRY *ListHead, LIST_ENTRY *Entry);
+LIST_ENTRY *GetFirstNode(CONST LIST_ENTRY *List);
+LIST_ENTRY *GetNextNode(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node);
+LIST_ENTRY *GetPreviousNode(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node);
+BOOLEAN IsNull(CONST LIST_ENTRY *List, CONST LIST_ENTRY *Node);
+BOOLEAN IsListEmpty(CONST LIST_ENTRY *ListHead);
+LIST_ENTRY *RemoveEntryList(CONST LIST_ENTRY *Entry);
+
+// UTF-16 -> UTF-8 for host paths (HostFile.c); BMP only, which is all
+// variable names and paths use. Returns the bytes written, Out terminated.
+UINTN HostToUtf8(CONST CHAR16 *In, CHAR8 *Out, UINTN OutSize);
+
+// PrintLib subset (HostPrint.c): %a %s(CHAR16) %c %d %u %x %X %lu %lx %r,
+// with '-', '0' and width
+UINTN AsciiVSPrint(CHAR8 *Buffer, UINTN BufferSize, CONST CHAR8 *Format, VA_LIST Marker);
+UINTN AsciiSPrint(CHAR8 *Buffer, UINTN BufferSize, CONST CHAR8 *Format, ...);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+
+// =============================
+// Host test checks (storetest, efivarstest)
+// A failed CHECK is reported and the run goes on, so one run lists every
+// broken case; main returns mFailed.
+// =============================
+STATIC int mFailed = 0;
+
+#define CHECK(Cond, ...)  do { if (!(Cond)) { printf("FAIL: " __VA_ARGS__); printf("\n"); mFailed = 1; } } while (0)
+
+#endif
@@ -0,0 +1 @@
+#include "../HostEfi.h"
@@ -0,0 +1,151 @@
+#include "VariableTool.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// =============================
+// Host check and benchmark for the work queue
+// Builds a synthetic variable store (zero-padded config blobs, dbx-like
+// hash lists, random payloads), then hashes and compresses it with 1..N
+// workers (mptest [payloads] [max workers]). Every run must produce the single-worker digests and sizes,
+// and every compressed payload must decode back to its input.
+// =============================
+typedef struct {
+  UINT8   *Data;
+  UINTN   Size;
+  UINT8   Digest[VAR_SHA256_DIGEST_SIZE];
+  UINT8   *Packed;
+  UINTN   Stored;
+} TEST_JOB;
+
+typedef struct {
+  TEST_JOB  *Jobs;
+  UINT32    *Tables;
+} TEST_CONTEXT;
+
+STATIC UINT32 mSeed = 0x12345678;
+
+STATIC UINT32
+NextRandom(VOID)
+{
+  mSeed ^= mSeed << 13;
+  mSeed ^= mSeed >> 17;
+  mSeed ^= mSeed << 5;
+  return mSeed;
+}
+
+STATIC VOID
+FillPayload(IN OUT TEST_JOB *Job, IN UINTN Kind)
+{
+  UINTN i;
+
+  switch (Kind % 3) {
+    case 0:   // config structure: a few fields, mostly zero padding
+      Job->Size = 512 + NextRandom() % 8192;
+      Job->Data = calloc(1, Job->Size);
+      for (i = 0; i < Job->Size; i += 64 + NextRandom() % 192) Job->Data[i] = (UINT8)NextRandom();
+      break;
+    case 1:   // signature list: owner GUID + 32-byte hash per entry
+      Job->Size = 28 + 48 * (16 + NextRandom() % 512);
+      Job->Data = malloc(Job->Size);
+      memset(Job->Data, 0xA5, 28);
+      for (i = 28; i < Job->Size; i += 48) {
+        memset(Job->Data + i, 0x77, 16);
+        for (UINTN k = 16; k < 48; k++) Job->Data[i + k] = (UINT8)NextRandom();
+      }
+      break;
+    default:  // incompressible
+      Job->Size = 16 + NextRandom() % 2048;
+      Job->Data = malloc(Job->Size);
+      for (i = 0; i < Job->Size; i++) Job->Data[i] = (UINT8)NextRandom();
+      break;
+  }
+  Job->Packed = malloc(Job->Size);
+}
+
+STATIC VOID
+Work(IN VOID *Context, IN UINTN Index, IN UINTN Worker)
+{
+  TEST_CONTEXT *Ctx = Context;
+  TEST_JOB *Job = &Ctx->Jobs[Index];
+
+  VarSha256(Job->Data, Job->Size, Job->Digest);
+  Job->Stored = VarLzCompress(Job->Data, Job->Size, Job->Packed, Job->Size - 1,
+                              Ctx->Tables + Worker * (VAR_LZ_TABLE_SIZE / sizeof(UINT32)));
+}
+
+STATIC double
+NowSeconds(VOID)
+{
+  struct timespec Ts;
+  clock_gettime(CLOCK_MONOTONIC, &Ts);
+  return Ts.tv_sec + Ts.tv_nsec / 1e9;
+}
+
+int
+main(int argc, char **argv)
+{
+  UINTN Count = (argc > 1) ? strtoul(argv[1], NULL, 0) : 3000;
+  UINTN MaxWorkers;
+  UINT64 Total = 0;
+  UINT64 Stored = 0;
+  TEST_CONTEXT Ctx;
+  UINT8 (*RefDigest)[VAR_SHA256_DIGEST_SIZE];
+  UINTN *RefStored;
+  double Base = 0;
+  int Failed = 0;
+
+  if (argc > 2) VarMpSetLimit(strtoul(argv[2], NULL, 0));
+  MaxWorkers = VarMpWorkerCount();
+  Ctx.Jobs = calloc(Count, sizeof(TEST_JOB));
+  Ctx.Tables = malloc(MaxWorkers * VAR_LZ_TABLE_SIZE);
+  RefDigest = malloc(Count * VAR_SHA256_DIGEST_SIZE);
+  RefStored = malloc(Count * sizeof(UINTN));
+
+  for (UINTN i = 0; i < Count; i++) {
+    FillPayload(&Ctx.Jobs[i], i);
+    Total += Ctx.Jobs[i].Size;
+  }
+
+  printf("%u payloads, %.1f MiB, up to %u workers\n",
+         (unsigned)Count, Total / 1048576.0, (unsigned)MaxWorkers);
+
+  for (UINTN Workers = 1; Workers <= MaxWorkers; Workers = (Workers < MaxWorkers && Workers * 2 > MaxWorkers) ? MaxWorkers : Workers * 2) {
+    double Start, Elapsed;
+
+    VarMpSetLimit(Workers);
+    Start = NowSeconds();
+    VarMpRun(Work, &Ctx, Count);
+    Elapsed = NowSeconds() - Start;
+    if (Workers == 1) Base = Elapsed;
+
+    for (UINTN i = 0; i < Count; i++) {
+      TEST_JOB *Job = &Ctx.Jobs[i];
+      if (Workers == 1) {
+        memcpy(RefDigest[i], Job->Digest, VAR_SHA256_DIGEST_SIZE);
+        RefStored[i] = Job->Stored;
+        if (Job->Stored != 0) {
+          UINT8 *Back = malloc(Job->Size);
+          if (EFI_ERROR(VarLzDecompress(Job->Packed, Job->Stored, Back, Job->Size)) ||
+              memcmp(Back, Job->Data, Job->Size) != 0) {
+            printf("FAIL: payload %u does not round-trip\n", (unsigned)i);
+            Failed = 1;
+          }
+          free(Back);
+        }
+        Stored += (Job->Stored != 0) ? Job->Stored : Job->Size;
+      } else if (memcmp(RefDigest[i], Job->Digest, VAR_SHA256_DIGEST_SIZE) != 0 || RefStored[i] != Job->Stored) {
+        printf("FAIL: payload %u differs with %u workers\n", (unsigned)i, (unsigned)Workers);
+        Failed = 1;
+      }
+    }
+
+    printf("  %2u worker(s): %8.1f MB/s  x%.2f\n",
+           (unsigned)Workers, Total / Elapsed / 1e6, Base / Elapsed);
+    if (Workers == MaxWorkers) break;
+  }
+
+  printf("compressed %.1f MiB -> %.1f MiB\n", Total / 1048576.0, Stored / 1048576.0);
+  printf("%s\n", Failed ? "FAILED" : "ok");
+  return Failed;
+}
@@ -0,0 +1,244 @@
+#include "VariableTool.h"
+#include "HostTest.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// =============================
+// Host check for the store parser and backend
+// Builds flash images by hand (0xFF filler, a decoy store GUID, then a
+// normal or authenticated store with deleted, in-transition and torn
+// records), runs the tool core over them and checks what it sees. With a
+// path argument the authenticated image is also written there for a
+// varimage smoke run (storetest [image]).
+// =============================
+#define IMAGE_SIZE    (64 * SIZE_1KB)
+#define STORE_OFFSET  0x1048      // behind a typical NV FV header
+#define STORE_SIZE    (32 * SIZE_1KB)
+
+STATIC EFI_GUID mGlobal = { 0x8BE4DF61, 0x93CA, 0x11D2, { 0xAA, 0x0D, 0x00, 0xE0, 0x98, 0x03, 0x2B, 0x8C } };
+STATIC EFI_GUID mVendor = { 0x3A997502, 0x647A, 0x4C82, { 0x99, 0x8E, 0x52, 0xEF, 0x94, 0x86, 0xA2, 0x47 } };
+STATIC EFI_GUID mStoreGuid = { 0xddcf3616, 0x3275, 0x4164, { 0x98, 0xb6, 0xfe, 0x85, 0x70, 0x7f, 0xfe, 0x7d } };
+STATIC EFI_GUID mAuthStoreGuid = { 0xaaf32c78, 0x947b, 0x439a, { 0xa1, 0x80, 0x2e, 0x14, 0x4e, 0xc3, 0x77, 0x92 } };
+
+typedef struct {
+  UINT8    *Image;
+  UINTN    End;               // next record, relative to the image
+  BOOLEAN  Auth;
+} IMAGE_BUILDER;
+
+STATIC VOID
+BeginImage(OUT IMAGE_BUILDER *B, IN BOOLEAN Auth)
+{
+  UINT8 *Store;
+
+  B->Image = malloc(IMAGE_SIZE);
+  B->Auth = Auth;
+  memset(B->Image, 0xFF, IMAGE_SIZE);
+
+  // decoy: the store GUID in code, not followed by a formatted header
+  memcpy(B->Image + 0x200, &mStoreGuid, sizeof(EFI_GUID));
+  B->Image[0x214] = 0x00;
+
+  Store = B->Image + STORE_OFFSET;
+  memcpy(Store, Auth ? &mAuthStoreGuid : &mStoreGuid, sizeof(EFI_GUID));
+  WriteUnaligned32((UINT32 *)(Store + 16), STORE_SIZE);
+  Store[20] = VAR_STORE_FORMATTED;
+  Store[21] = VAR_STORE_HEALTHY;
+  memset(Store + 22, 0, 6);
+  B->End = STORE_OFFSET + VAR_STORE_HEADER_SIZE;
+}
+
+STATIC VOID
+AddRecord(IN OUT IMAGE_BUILDER *B, IN CONST CHAR8 *Name, IN EFI_GUID *Guid, IN UINT8 State,
+          IN CONST VOID *Data, IN UINT32 DataSize)
+{
+  UINT8 *Header = B->Image + B->End;
+  UINTN HeaderSize = B->Auth ? 60 : 32;
+  UINT32 NameSize = (UINT32)(strlen(Name) + 1) * sizeof(CHAR16);
+  CHAR16 *Wide = (CHAR16 *)(Header + HeaderSize);
+
+  memset(Header, 0, HeaderSize);
+  WriteUnaligned16((UINT16 *)Header, VAR_STORE_START_ID);
+  Header[2] = State;
+  WriteUnaligned32((UINT32 *)(Header + 4), EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS |
+                   EFI_VARIABLE_RUNTIME_ACCESS);
+  WriteUnaligned32((UINT32 *)(Header + (B->Auth ? 36 : 8)), NameSize);
+  WriteUnaligned32((UINT32 *)(Header + (B->Auth ? 40 : 12)), DataSize);
+  memcpy(Header + (B->Auth ? 44 : 16), Guid, sizeof(EFI_GUID));
+
+  for (UINTN i = 0; i * sizeof(CHAR16) < NameSize; i++) Wide[i] = (UINT8)Name[i];
+  memcpy((UINT8 *)Wide + NameSize, Data, DataSize);
+
+  B->End = ALIGN_VALUE(B->End + HeaderSize + NameSize + DataSize, 4);
+}
+
+// Dead records: the superseded BootOrder, Lang's transition copy, Torn.
+STATIC VOID
+CheckHealth(IN VAR_STORE *Store, IN CONST CHAR8 *Kind)
+{
+  VAR_STORE_HEALTH Health;
+  UINTN Header = Store->Authenticated ? 60 : 32;
+  UINTN Dead = 3 * Header + 24 + 16 + 16;
+  UINT8 *Tail;
+
+  VarStoreHealth(Store, SIZE_4KB, 0, &Health);
+  CHECK(Health.Added.Count == 5 && Health.Deleted.Count == 1 && Health.InTransition.Count == 2 &&
+        Health.Incomplete.Count == 1, "%s: health counts %lu/%lu/%lu/%lu", Kind, (unsigned long)Health.Added.Count,
+        (unsigned long)Health.Deleted.Count, (unsigned long)Health.InTransition.Count,
+        (unsigned long)Health.Incomplete.Count);
+  CHECK(Health.Added.Bytes + Health.Deleted.Bytes + Health.InTransition.Bytes + Health.Incomplete.Bytes ==
+        Health.Used - VAR_STORE_HEADER_SIZE, "%s: tallies do not cover the used area", Kind);
+  CHECK(Health.Reclaimable == Dead, "%s: reclaimable %lu, expected %lu", Kind, (unsigned long)Health.Reclaimable,
+        (unsigned long)Dead);
+  CHECK(Health.Free == Store->Size - Health.Used && Health.LargestFree == Health.Free, "%s: free space", Kind);
+  CHECK(Health.Trigger == VarReclaimNone && Health.Headroom == Health.Free &&
+        Health.WritesBeforeReclaim == Health.Free - SIZE_4KB, "%s: no reclaim expected", Kind);
+
+  VarStoreHealth(Store, Health.Free + 1, 0, &Health);
+  CHECK(Health.Trigger == VarReclaimLowSpace, "%s: low space not predicted", Kind);
+
+  // a stray byte after the last record forces a reclaim at driver init
+  Tail = Store->Base + Health.Used + 100;
+  *Tail = 0x00;
+  VarStoreHealth(Store, SIZE_4KB, 0, &Health);
+  CHECK(Health.Trigger == VarReclaimDirtyFree && Health.LargestFree == Health.Free - 101, "%s: dirty free area",
+        Kind);
+  *Tail = 0xFF;
+}
+
+STATIC VOID
+CheckImage(IN BOOLEAN Auth, IN CONST CHAR8 *SavePath OPTIONAL)
+{
+  IMAGE_BUILDER B;
+  VAR_STORE Store;
+  VAR_STORE_ENTRY Entry;
+  VAR_BACKEND *Backend;
+  VAR_CATALOG Catalog;
+  UINTN Offset = 0;
+  UINTN Cursor = 0;
+  UINTN Records = 0;
+  UINT8 *Data;
+  UINTN DataSize;
+  UINT32 Attr;
+  UINT8 Small[2];
+  CONST CHAR8 *Kind = Auth ? "auth" : "normal";
+  UINT16 OldOrder[] = { 1, 0 };
+  UINT16 NewOrder[] = { 0, 1, 2 };
+
+  BeginImage(&B, Auth);
+  AddRecord(&B, "Boot0000", &mGlobal, VAR_STORE_ADDED, "\x01\x00\x00\x00\x2a\x00", 6);
+  AddRecord(&B, "BootOrder", &mGlobal, VAR_STORE_ADDED & VAR_STORE_DELETED & VAR_STORE_IN_TRANSITION, OldOrder, sizeof(OldOrder));
+  AddRecord(&B, "BootOrder", &mGlobal, VAR_STORE_ADDED, NewOrder, sizeof(NewOrder));
+  AddRecord(&B, "Lang", &mGlobal, VAR_STORE_ADDED & VAR_STORE_IN_TRANSITION, "eng", 4);
+  AddRecord(&B, "Lang", &mGlobal, VAR_STORE_ADDED, "fra", 4);
+  AddRecord(&B, "Timeout", &mGlobal, VAR_STORE_ADDED & VAR_STORE_IN_TRANSITION, "\x05\x00", 2);
+  AddRecord(&B, "Torn", &mVendor, VAR_STORE_HEADER_ONLY, "xxxx", 4);
+  AddRecord(&B, "Boot0001", &mGlobal, VAR_STORE_ADDED, "abc", 3);     // odd size: next header realigned
+  AddRecord(&B, "Setup", &mVendor, VAR_STORE_ADDED, "\x00\x01\x02\x03\x04", 5);
+
+  CHECK(!EFI_ERROR(VarStoreFind(B.Image, IMAGE_SIZE, &Offset, &Store)), "%s: store not found", Kind);
+  CHECK(Store.Offset == STORE_OFFSET && Store.Size == STORE_SIZE && Store.Authenticated == Auth,
+        "%s: store at 0x%lx size 0x%lx auth %u", Kind, (unsigned long)Store.Offset, (unsigned long)Store.Size,
+        Store.Authenticated);
+  while (VarStoreNextEntry(&Store, &Cursor, &Entry)) Records++;
+  CHECK(Records == 9, "%s: walked %lu records, expected 9", Kind, (unsigned long)Records);
+  CHECK(Store.Offset + Cursor == B.End, "%s: walk ended at 0x%lx, expected 0x%lx", Kind,
+        (unsigned long)(Store.Offset + Cursor), (unsigned long)B.End);
+
+  CHECK(!EFI_ERROR(VarStoreBackendOpen(&Store, &Backend)), "%s: backend open", Kind);
+  VarBackendSelect(Backend);
+
+  // live: Boot0000, BootOrder (new), Lang (added copy), Timeout (lone transition copy), Boot0001, Setup
+  CHECK(!EFI_ERROR(CollectAllVariables(&Catalog)), "%s: collect", Kind);
+  CHECK(Catalog.Count == 6, "%s: %lu live variables, expected 6", Kind, (unsigned long)Catalog.Count);
+  for (UINTN i = 0; i < Catalog.Count; i++) {
+    CHECK(StrCmp(VarCatalogName(&Catalog, i), L"Torn") != 0, "%s: torn record listed", Kind);
+  }
+  FreeAllVariables(&Catalog);
+
+  CHECK(!EFI_ERROR(VarReadBulk(L"BootOrder", &mGlobal, &Attr, &Data, &DataSize)) &&
+        DataSize == sizeof(NewOrder) && memcmp(Data, NewOrder, DataSize) == 0, "%s: BootOrder", Kind);
+  CHECK(Data >= B.Image && Data < B.Image + IMAGE_SIZE, "%s: bulk read copied the payload", Kind);
+  CHECK(!EFI_ERROR(VarReadBulk(L"Lang", &mGlobal, &Attr, &Data, &DataSize)) && memcmp(Data, "fra", 4) == 0,
+        "%s: Lang should be the VAR_ADDED copy", Kind);
+  CHECK(!EFI_ERROR(VarReadBulk(L"Timeout", &mGlobal, &Attr, &Data, &DataSize)) && DataSize == 2,
+        "%s: Timeout", Kind);
+  CHECK(VarReadBulk(L"Torn", &mVendor, &Attr, &Data, &DataSize) == EFI_NOT_FOUND, "%s: Torn", Kind);
+
+  DataSize = sizeof(Small);
+  CHECK(gVarBackend->GetVariable(L"Setup", &mVendor, &Attr, &DataSize, Small) == EFI_BUFFER_TOO_SMALL &&
+        DataSize == 5, "%s: GetVariable size probe", Kind);
+  CHECK(VarSetVariable(L"Setup", &mVendor, EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                       1, Small) == EFI_WRITE_PROTECTED, "%s: store backend must be read-only", Kind);
+
+  if (SavePath != NULL) {
+    FILE *f = fopen(SavePath, "wb");
+    CHECK(f != NULL && fwrite(B.Image, 1, IMAGE_SIZE, f) == IMAGE_SIZE && fclose(f) == 0, "write %s", SavePath);
+  }
+
+  CheckHealth(&Store, Kind);
+
+  // deleted under the index, as on live flash: no longer served
+  for (Cursor = 0; VarStoreNextEntry(&Store, &Cursor, &Entry); ) {
+    if (StrCmp(Entry.Name, L"Boot0001") == 0) Store.Base[Entry.Offset + 2] &= VAR_STORE_DELETED;
+  }
+  DataSize = sizeof(Small);
+  CHECK(gVarBackend->GetVariable(L"Boot0001", &mGlobal, &Attr, &DataSize, Small) == EFI_NOT_FOUND,
+        "%s: record deleted after indexing still served", Kind);
+
+  VarStoreBackendClose();
+  CHECK(gVarBackend != Backend, "%s: close must deselect the store backend", Kind);
+  free(B.Image);
+}
+
+// Catalog load over a store with Count variables, as varimage does per image.
+STATIC VOID
+Benchmark(IN UINTN Count)
+{
+  IMAGE_BUILDER B;
+  VAR_STORE Store;
+  VAR_BACKEND *Backend;
+  VAR_CATALOG Catalog;
+  UINTN Offset = 0;
+  UINTN Rounds = 200;
+  struct timespec t0, t1;
+  CHAR8 Name[32];
+  UINT8 Payload[64];
+
+  BeginImage(&B, TRUE);
+  memset(Payload, 0x5A, sizeof(Payload));
+  for (UINTN i = 0; i < Count && B.End + 256 < STORE_OFFSET + STORE_SIZE; i++) {
+    snprintf(Name, sizeof(Name), "Var%04u", (unsigned)i);
+    AddRecord(&B, Name, (i & 1) ? &mVendor : &mGlobal, VAR_STORE_ADDED, Payload, (UINT32)(i % sizeof(Payload)));
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (UINTN r = 0; r < Rounds; r++) {
+    Offset = 0;
+    VarStoreFind(B.Image, IMAGE_SIZE, &Offset, &Store);
+    VarStoreBackendOpen(&Store, &Backend);
+    VarBackendSelect(Backend);
+    CollectAllVariables(&Catalog);
+    if (r == 0) Count = Catalog.Count;
+    FreeAllVariables(&Catalog);
+    VarStoreBackendClose();
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  printf("catalog of %u variables: %.1f us per image\n", (unsigned)Count,
+         ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e3 / Rounds);
+  free(B.Image);
+}
+
+int
+main(int argc, char **argv)
+{
+  CheckImage(FALSE, NULL);
+  CheckImage(TRUE, (argc > 1) ? argv[1] : NULL);
+  Benchmark(400);
+
+  VarCacheShutdown();
+  printf("%s\n", mFailed ? "FAILED" : "ok");
+  return mFailed;
+}
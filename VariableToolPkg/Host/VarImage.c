@@ -0,0 +1,376 @@
+#include "HostEfivars.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// =============================
+// varimage: VariableTool's list/search/dump/export over firmware images
+// Each image (full flash dump or NV FV file) is mapped read-only, the
+// variable store is located and served to the unchanged tool core through
+// the store backend (VarStore.c), so payloads are never copied out of the
+// mapping. A directory argument is read as efivarfs (HostEfivars.c), which
+// gives the same views of the running host: varimage /sys/firmware/efi/efivars
+//
+//   varimage [options] <image|efivarfs dir>...
+//     (default)           list live variables
+//     -search <pattern>   list names matching <pattern> (* and ?)
+//     -dump               hex dump of every variable
+//     -export json|csv [-hash] [-data hex|base64]
+//     -stores             every store header found in the image
+//     -health [-maxvar <n>] [-hwerr <n>]
+//                         dead space, free space and whether the next boot
+//                         reclaims; <n> are the platform's PcdMaxVariableSize
+//                         (default 0x400, as in MdeModulePkg) and
+//                         PcdHwErrStorageSize (default 0)
+//     -o <file>           output file (one image only); with several
+//                         images -export writes <image>.json / .csv
+//     -guids <file>       extra vendor GUID names
+//     -cpus <n>           worker threads for hashing/encoding
+// =============================
+typedef enum {
+  CommandList,
+  CommandSearch,
+  CommandDump,
+  CommandExport,
+  CommandStores,
+  CommandHealth
+} IMAGE_COMMAND;
+
+typedef struct {
+  IMAGE_COMMAND      Command;
+  CHAR16             *Pattern;
+  VAR_EXPORT_FORMAT  Format;
+  UINT32             Flags;
+  CONST CHAR8        *OutPath;
+  UINTN              MaxVariableSize;
+  UINTN              HwErrStorageSize;
+} IMAGE_OPTIONS;
+
+// Host argv -> CHAR16 (ASCII is all the options and patterns need).
+STATIC CHAR16 *
+Widen(IN CONST CHAR8 *Text)
+{
+  UINTN Length = strlen(Text);
+  CHAR16 *Wide = AllocatePool((Length + 1) * sizeof(CHAR16));
+
+  if (Wide == NULL) return NULL;
+  for (UINTN i = 0; i <= Length; i++) Wide[i] = (UINT8)Text[i];
+  return Wide;
+}
+
+STATIC EFI_STATUS
+OpenWriter(OUT VAR_WRITER *Writer, IN CONST CHAR8 *Path OPTIONAL)
+{
+  EFI_STATUS Status;
+  CHAR16 *WidePath;
+
+  if (Path == NULL) return VarWriterOpenConsole(Writer);
+
+  WidePath = Widen(Path);
+  if (WidePath == NULL) return EFI_OUT_OF_RESOURCES;
+  Status = VarWriterOpenFile(Writer, WidePath);
+  FreePool(WidePath);
+  return Status;
+}
+
+STATIC VOID
+ListCatalog(IN OUT VAR_WRITER *Writer, IN VAR_CATALOG *Catalog, IN CHAR16 *Pattern OPTIONAL)
+{
+  CHAR8 AttrText[32];
+  CHAR8 Guid[VAR_GUID_STRING_LENGTH + 1];
+
+  for (UINTN i = 0; i < Catalog->Count; i++) {
+    CONST CHAR8 *GuidName;
+
+    if (Pattern != NULL && !VarCatalogNameMatch(Catalog, i, Pattern)) continue;
+
+    GuidName = VarGuidName(VAR_CATALOG_GUID(Catalog, i));
+    if (GuidName == NULL) {
+      Guid[VarFormatGuid(VAR_CATALOG_GUID(Catalog, i), Guid)] = '\0';
+      GuidName = Guid;
+    }
+    VarAttributesToAscii(Catalog->Attributes[i], AttrText, sizeof(AttrText));
+    VarWriterPrint(Writer, "%-14a %8u  %-36a  %s\n", AttrText, Catalog->DataSize[i], GuidName,
+                   VarCatalogName(Catalog, i));
+  }
+}
+
+STATIC VOID
+ListStores(IN CONST CHAR8 *Path, IN UINT8 *Image, IN UINTN Size)
+{
+  VAR_STORE Store;
+  UINTN Offset = 0;
+
+  while (!EFI_ERROR(VarStoreFind(Image, Size, &Offset, &Store))) {
+    VAR_STORE_ENTRY Entry;
+    UINTN Cursor = 0;
+    UINTN Entries = 0;
+    UINTN End = VAR_STORE_HEADER_SIZE;
+
+    while (VarStoreNextEntry(&Store, &Cursor, &Entry)) {
+      Entries++;
+      End = Entry.Next;
+    }
+    printf("%s: store at 0x%08lx, %lu bytes, %s, state 0x%02x, %lu entries, %lu bytes used\n",
+           Path, (unsigned long)Store.Offset, (unsigned long)Store.Size,
+           Store.Authenticated ? "authenticated" : "normal", Store.State,
+           (unsigned long)Entries, (unsigned long)End);
+  }
+}
+
+STATIC VOID
+PrintTally(IN CONST CHAR8 *What, IN CONST VAR_STORE_TALLY *Tally)
+{
+  printf("  %-14s %6lu records  %8lu bytes\n", What, (unsigned long)Tally->Count, (unsigned long)Tally->Bytes);
+}
+
+STATIC VOID
+PrintHealth(IN CONST CHAR8 *Path, IN VAR_STORE *Store, IN IMAGE_OPTIONS *Options)
+{
+  VAR_STORE_HEALTH Health;
+
+  VarStoreHealth(Store, Options->MaxVariableSize, Options->HwErrStorageSize, &Health);
+
+  printf("%s: %s store at 0x%08lx, %lu bytes\n", Path, Store->Authenticated ? "authenticated" : "normal",
+         (unsigned long)Store->Offset, (unsigned long)Store->Size);
+  PrintTally("added", &Health.Added);
+  PrintTally("deleted", &Health.Deleted);
+  PrintTally("in transition", &Health.InTransition);
+  PrintTally("incomplete", &Health.Incomplete);
+  printf("  used %lu bytes (%lu%%), free %lu, largest erased run %lu\n", (unsigned long)Health.Used,
+         (unsigned long)(Health.Used * 100 / Store->Size), (unsigned long)Health.Free,
+         (unsigned long)Health.LargestFree);
+  printf("  reclaim drops %lu bytes, leaving %lu free\n", (unsigned long)Health.Reclaimable,
+         (unsigned long)(Health.Free + Health.Reclaimable));
+
+  switch (Health.Trigger) {
+  case VarReclaimDirtyFree:
+    printf("  next boot: reclaim at variable driver init (free area not erased)\n");
+    break;
+  case VarReclaimLowSpace:
+    printf("  next boot: reclaim before the OS (%lu bytes left, max variable size %lu)\n",
+           (unsigned long)Health.Headroom, (unsigned long)Options->MaxVariableSize);
+    break;
+  default:
+    printf("  next boot: no reclaim; %lu more bytes of variable writes before one\n",
+           (unsigned long)Health.WritesBeforeReclaim);
+    break;
+  }
+}
+
+// The first healthy store wins; FTW spare copies come later in the image
+// or are not marked healthy.
+STATIC EFI_STATUS
+FindMainStore(IN UINT8 *Image, IN UINTN Size, OUT VAR_STORE *Store)
+{
+  VAR_STORE Candidate;
+  UINTN Offset = 0;
+  BOOLEAN Found = FALSE;
+
+  while (!EFI_ERROR(VarStoreFind(Image, Size, &Offset, &Candidate))) {
+    if (!Found || (Store->State != VAR_STORE_HEALTHY && Candidate.State == VAR_STORE_HEALTHY)) {
+      CopyMem(Store, &Candidate, sizeof(VAR_STORE));
+      Found = TRUE;
+    }
+    if (Store->State == VAR_STORE_HEALTHY) break;
+  }
+  return Found ? EFI_SUCCESS : EFI_NOT_FOUND;
+}
+
+STATIC EFI_STATUS
+RunOnStore(IN IMAGE_OPTIONS *Options, IN CONST CHAR8 *OutPath OPTIONAL)
+{
+  EFI_STATUS Status;
+  VAR_CATALOG Catalog;
+  VAR_WRITER Writer;
+  UINTN Count = 0;
+
+  VarCatalogInit(&Catalog);
+  if (Options->Command != CommandDump) {
+    Status = CollectAllVariables(&Catalog);
+    if (EFI_ERROR(Status)) return Status;
+  }
+
+  Status = OpenWriter(&Writer, OutPath);
+  if (EFI_ERROR(Status)) {
+    FreeAllVariables(&Catalog);
+    return Status;
+  }
+
+  switch (Options->Command) {
+  case CommandDump:
+    VarDumpAll(&Writer, &Count);
+    break;
+  case CommandExport:
+    VarExportCatalog(&Writer, &Catalog, Options->Format, Options->Flags);
+    break;
+  default:
+    ListCatalog(&Writer, &Catalog, (Options->Command == CommandSearch) ? Options->Pattern : NULL);
+    break;
+  }
+
+  Status = VarWriterClose(&Writer);
+  FreeAllVariables(&Catalog);
+  return Status;
+}
+
+// Selected backend, with per-source output naming when there are several.
+STATIC EFI_STATUS
+RunOnSource(IN IMAGE_OPTIONS *Options, IN CONST CHAR8 *Path, IN BOOLEAN Several)
+{
+  CHAR8 OutPath[4096];
+  CONST CHAR8 *Out = Options->OutPath;
+
+  if (Several && Options->Command == CommandExport) {
+    snprintf(OutPath, sizeof(OutPath), "%s.%s", Path, (Options->Format == VarExportCsv) ? "csv" : "json");
+    Out = OutPath;
+  } else if (Several) {
+    fflush(stdout);
+    printf("== %s\n", Path);
+  }
+  return RunOnStore(Options, Out);
+}
+
+STATIC EFI_STATUS
+RunOnEfivars(IN IMAGE_OPTIONS *Options, IN CONST CHAR8 *Path, IN BOOLEAN Several)
+{
+  EFI_STATUS Status;
+  VAR_BACKEND *Backend;
+
+  // no store headers to show: the kernel hides the flash layout
+  if (Options->Command == CommandStores || Options->Command == CommandHealth) return EFI_UNSUPPORTED;
+
+  Status = EfivarsBackendOpen(Path, &Backend);
+  if (EFI_ERROR(Status)) return Status;
+  VarBackendSelect(Backend);
+  Status = RunOnSource(Options, Path, Several);
+  EfivarsBackendClose();
+  return Status;
+}
+
+STATIC EFI_STATUS
+RunOnImage(IN IMAGE_OPTIONS *Options, IN CONST CHAR8 *Path, IN BOOLEAN Several)
+{
+  EFI_STATUS Status;
+  struct stat Info;
+  UINT8 *Image;
+  VAR_STORE Store;
+  VAR_BACKEND *Backend;
+  int Fd;
+
+  if (stat(Path, &Info) == 0 && S_ISDIR(Info.st_mode)) return RunOnEfivars(Options, Path, Several);
+
+  Fd = open(Path, O_RDONLY);
+  if (Fd < 0 || fstat(Fd, &Info) != 0 || Info.st_size == 0) {
+    if (Fd >= 0) close(Fd);
+    return EFI_ACCESS_DENIED;
+  }
+  Image = mmap(NULL, (size_t)Info.st_size, PROT_READ, MAP_PRIVATE, Fd, 0);
+  close(Fd);
+  if (Image == MAP_FAILED) return EFI_DEVICE_ERROR;
+
+  if (Options->Command == CommandStores) {
+    ListStores(Path, Image, (UINTN)Info.st_size);
+    munmap(Image, (size_t)Info.st_size);
+    return EFI_SUCCESS;
+  }
+
+  Status = FindMainStore(Image, (UINTN)Info.st_size, &Store);
+  if (!EFI_ERROR(Status) && Options->Command == CommandHealth) {
+    PrintHealth(Path, &Store, Options);
+    munmap(Image, (size_t)Info.st_size);
+    return EFI_SUCCESS;
+  }
+  if (!EFI_ERROR(Status)) Status = VarStoreBackendOpen(&Store, &Backend);
+  if (!EFI_ERROR(Status)) {
+    VarBackendSelect(Backend);
+    Status = RunOnSource(Options, Path, Several);
+    VarStoreBackendClose();
+  }
+
+  munmap(Image, (size_t)Info.st_size);
+  return Status;
+}
+
+STATIC int
+Usage(VOID)
+{
+  fprintf(stderr,
+          "usage: varimage [-search <pattern> | -dump | -export json|csv [-hash] [-data hex|base64] | -stores |\n"
+          "                 -health [-maxvar <n>] [-hwerr <n>]]\n"
+          "                [-o <file>] [-guids <file>] [-cpus <n>] <image|efivarfs dir>...\n");
+  return 2;
+}
+
+int
+main(int argc, char **argv)
+{
+  IMAGE_OPTIONS Options;
+  int First = 0;
+  int Failed = 0;
+
+  ZeroMem(&Options, sizeof(Options));
+  Options.Command = CommandList;
+  Options.MaxVariableSize = 0x400;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-search") == 0 && i + 1 < argc) {
+      Options.Command = CommandSearch;
+      Options.Pattern = Widen(argv[++i]);
+    } else if (strcmp(argv[i], "-dump") == 0) {
+      Options.Command = CommandDump;
+    } else if (strcmp(argv[i], "-export") == 0 && i + 1 < argc) {
+      Options.Command = CommandExport;
+      Options.Format = (strcmp(argv[++i], "csv") == 0) ? VarExportCsv : VarExportJson;
+    } else if (strcmp(argv[i], "-hash") == 0) {
+      Options.Flags |= VAR_EXPORT_HASH;
+    } else if (strcmp(argv[i], "-data") == 0 && i + 1 < argc) {
+      Options.Flags |= (strcmp(argv[++i], "base64") == 0) ? VAR_EXPORT_BASE64 : VAR_EXPORT_HEX;
+    } else if (strcmp(argv[i], "-stores") == 0) {
+      Options.Command = CommandStores;
+    } else if (strcmp(argv[i], "-health") == 0) {
+      Options.Command = CommandHealth;
+    } else if (strcmp(argv[i], "-maxvar") == 0 && i + 1 < argc) {
+      Options.MaxVariableSize = (UINTN)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-hwerr") == 0 && i + 1 < argc) {
+      Options.HwErrStorageSize = (UINTN)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      Options.OutPath = argv[++i];
+    } else if (strcmp(argv[i], "-guids") == 0 && i + 1 < argc) {
+      CHAR16 *GuidPath = Widen(argv[++i]);
+      EFI_STATUS Status = (GuidPath != NULL) ? VarGuidNamesLoad(GuidPath, NULL) : EFI_OUT_OF_RESOURCES;
+      if (EFI_ERROR(Status)) {
+        fprintf(stderr, "varimage: %s: cannot load GUID names\n", argv[i]);
+        return 1;
+      }
+      FreePool(GuidPath);
+    } else if (strcmp(argv[i], "-cpus") == 0 && i + 1 < argc) {
+      VarMpSetLimit((UINTN)strtoul(argv[++i], NULL, 0));
+    } else if (argv[i][0] == '-') {
+      return Usage();
+    } else {
+      First = i;
+      break;
+    }
+  }
+  if (First == 0 || (Options.OutPath != NULL && argc - First > 1)) return Usage();
+
+  for (int i = First; i < argc; i++) {
+    EFI_STATUS Status = RunOnImage(&Options, argv[i], argc - First > 1);
+    if (EFI_ERROR(Status)) {
+      CHAR8 Reason[64];
+      AsciiSPrint(Reason, sizeof(Reason), "%r", Status);
+      fflush(stdout);
+      fprintf(stderr, "varimage: %s: %s\n", argv[i], (Status == EFI_NOT_FOUND) ? "no variable store" : Reason);
+      Failed++;
+    }
+  }
+
+  VarGuidNamesReset();
+  VarCacheShutdown();
+  if (Options.Pattern != NULL) FreePool(Options.Pattern);
+  return (Failed != 0) ? 1 : 0;
+}
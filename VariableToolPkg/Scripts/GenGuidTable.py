@@ -0,0 +1,110 @@
+## @file
+# Generate VarGuidTable.h: the built-in vendor GUID names of VariableTool
+# and a collision-free hash over them.
+#
+# A GUID is folded to 32 bits (XOR of its four little-endian dwords), then
+# slot = (fold * Seed) >> (32 - Bits). The script searches for a Seed that
+# puts every GUID in its own slot, so the lookup in VarGuidName.c is one
+# multiply, one table read and one GUID compare.
+#
+# Usage: GenGuidTable.py KnownGuids.txt VarGuidTable.h
+##
+
+import struct
+import sys
+import uuid
+
+MAX_SEEDS = 1 << 20
+MAX_NAME = 36     # shown in place of a GUID string
+
+
+def ReadGuids(Path):
+    Entries = []
+    with open(Path, encoding='utf-8') as File:
+        for LineNo, Line in enumerate(File, 1):
+            Line = Line.split('#', 1)[0].strip()
+            if not Line:
+                continue
+            Fields = Line.split()
+            if len(Fields) != 2:
+                sys.exit('%s:%d: expected "<guid> <name>"' % (Path, LineNo))
+            try:
+                Guid = uuid.UUID(Fields[0])
+            except ValueError:
+                sys.exit('%s:%d: bad GUID %s' % (Path, LineNo, Fields[0]))
+            if not Fields[1].isascii() or len(Fields[1]) > MAX_NAME:
+                sys.exit('%s:%d: names must be ASCII, at most %d characters' % (Path, LineNo, MAX_NAME))
+            Entries.append((Guid, Fields[1]))
+
+    Seen = set()
+    for Guid, Name in Entries:
+        if Guid in Seen:
+            sys.exit('%s: %s listed twice' % (Path, Guid))
+        Seen.add(Guid)
+    return Entries
+
+
+def Fold(Guid):
+    # EFI_GUID memory layout is uuid's little-endian byte order
+    Words = struct.unpack('<4I', Guid.bytes_le)
+    return Words[0] ^ Words[1] ^ Words[2] ^ Words[3]
+
+
+def FindSeed(Folds):
+    Bits = max(1, (2 * len(Folds) - 1).bit_length())
+    while Bits <= 16:
+        Seed = 0x9E3779B1
+        for _ in range(MAX_SEEDS):
+            Slots = {((Value * Seed) & 0xFFFFFFFF) >> (32 - Bits) for Value in Folds}
+            if len(Slots) == len(Folds):
+                return Bits, Seed
+            Seed = (Seed * 1664525 + 1013904223) & 0xFFFFFFFF | 1
+        Bits += 1
+    sys.exit('no collision-free seed found')
+
+
+def CGuid(Guid):
+    Data1, Data2, Data3 = struct.unpack('<IHH', Guid.bytes_le[:8])
+    Data4 = ', '.join('0x%02x' % Byte for Byte in Guid.bytes_le[8:])
+    return '{ 0x%08x, 0x%04x, 0x%04x, { %s } }' % (Data1, Data2, Data3, Data4)
+
+
+def Main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: GenGuidTable.py <in.txt> <out.h>')
+
+    Entries = ReadGuids(sys.argv[1])
+    if not Entries or len(Entries) > 255:
+        sys.exit('between 1 and 255 GUIDs are supported')
+
+    Folds = [Fold(Guid) for Guid, _ in Entries]
+    Bits, Seed = FindSeed(Folds)
+
+    Slots = [0] * (1 << Bits)
+    for Index, Value in enumerate(Folds):
+        Slots[((Value * Seed) & 0xFFFFFFFF) >> (32 - Bits)] = Index + 1
+
+    Width = max(len(Name) for _, Name in Entries) + 3
+    Out = []
+    Out.append('// Generated by VariableToolPkg/Scripts/GenGuidTable.py from KnownGuids.txt.')
+    Out.append('// Do not edit; change the list and rerun the script.')
+    Out.append('#define KNOWN_GUID_HASH_BITS  %d' % Bits)
+    Out.append('#define KNOWN_GUID_HASH_SEED  0x%08XU' % Seed)
+    Out.append('')
+    Out.append('STATIC CONST KNOWN_GUID mKnownGuids[] = {')
+    for Guid, Name in Entries:
+        Out.append('  { %-*s %s },' % (Width, '"%s",' % Name, CGuid(Guid)))
+    Out.append('};')
+    Out.append('')
+    Out.append('// hash slot -> 1 + index into mKnownGuids, 0 = empty')
+    Out.append('STATIC CONST UINT8 mKnownGuidSlots[%d] = {' % len(Slots))
+    for Row in range(0, len(Slots), 16):
+        Out.append('  ' + ', '.join('%3d' % Value for Value in Slots[Row:Row + 16]) + ',')
+    Out.append('};')
+
+    with open(sys.argv[2], 'w', newline='\r\n') as File:
+        File.write('\n'.join(Out) + '\n')
+
+
+if __name__ == '__main__':
+    Main()